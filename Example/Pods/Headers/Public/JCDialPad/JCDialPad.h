@@ -1 +0,0 @@
-../../../JCDialPad/JCDialPad/JCDialPad.h
\ No newline at end of file
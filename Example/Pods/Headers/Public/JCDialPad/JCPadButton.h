@@ -1 +0,0 @@
-../../../JCDialPad/JCDialPad/JCPadButton.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../JCDialPad/JCDialPad/UIView+FrameAccessor.h
\ No newline at end of file
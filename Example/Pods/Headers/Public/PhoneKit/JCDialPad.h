@@ -0,0 +1 @@
+../../../../../Pod/Classes/DialPad/JCDialPad.h
\ No newline at end of file
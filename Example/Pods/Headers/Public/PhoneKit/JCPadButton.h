@@ -0,0 +1 @@
+../../../../../Pod/Classes/DialPad/JCPadButton.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBAsYouTypeFormatter.h
\ No newline at end of file
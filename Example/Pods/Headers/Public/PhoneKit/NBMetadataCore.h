@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBMetadataCore.h
\ No newline at end of file
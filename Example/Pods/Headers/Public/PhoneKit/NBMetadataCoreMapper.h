@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBMetadataCoreMapper.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBMetadataCoreTest.h
\ No newline at end of file
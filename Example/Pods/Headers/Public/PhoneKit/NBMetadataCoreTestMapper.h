@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBMetadataCoreTestMapper.h
\ No newline at end of file
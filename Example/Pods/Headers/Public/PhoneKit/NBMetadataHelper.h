@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBMetadataHelper.h
\ No newline at end of file
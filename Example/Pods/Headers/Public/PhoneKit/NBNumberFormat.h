@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBNumberFormat.h
\ No newline at end of file
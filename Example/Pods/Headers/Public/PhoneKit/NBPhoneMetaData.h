@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBPhoneMetaData.h
\ No newline at end of file
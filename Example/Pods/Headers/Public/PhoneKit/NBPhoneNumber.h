@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBPhoneNumber.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBPhoneNumberDefines.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBPhoneNumberDesc.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NBPhoneNumberUtil.h
\ No newline at end of file
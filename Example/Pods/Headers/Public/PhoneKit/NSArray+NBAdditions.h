@@ -0,0 +1 @@
+../../../../../Pod/Classes/PhoneNumber/NSArray+NBAdditions.h
\ No newline at end of file
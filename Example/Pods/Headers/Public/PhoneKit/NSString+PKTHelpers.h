@@ -1 +1 @@
-../../../PhoneKit/Pod/Classes/Core/NSString+PKTHelpers.h
\ No newline at end of file
+../../../../../Pod/Classes/Core/NSString+PKTHelpers.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTAreaCodeGeocoder.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTBackend.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTCallHistory.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTCallMetrics.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/UI/PKTCallPadSwitcher.h
\ No newline at end of file
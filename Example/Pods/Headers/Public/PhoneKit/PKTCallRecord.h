@@ -1 +1 @@
-../../../PhoneKit/Pod/Classes/Core/PKTCallRecord.h
\ No newline at end of file
+../../../../../Pod/Classes/Core/PKTCallRecord.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTCallRecordCodec.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTCallSession.h
\ No newline at end of file
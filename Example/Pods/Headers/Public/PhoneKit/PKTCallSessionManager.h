@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTCallSessionManager.h
\ No newline at end of file
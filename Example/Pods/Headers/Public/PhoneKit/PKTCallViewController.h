@@ -1 +1 @@
-../../../PhoneKit/Pod/Classes/UI/PKTCallViewController.h
\ No newline at end of file
+../../../../../Pod/Classes/UI/PKTCallViewController.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTDialQueue.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTDialSuggester.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTDigitSender.h
\ No newline at end of file
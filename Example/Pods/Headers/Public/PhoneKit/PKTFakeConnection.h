@@ -0,0 +1 @@
+../../../../../Pod/Classes/Testing/PKTFakeConnection.h
\ No newline at end of file
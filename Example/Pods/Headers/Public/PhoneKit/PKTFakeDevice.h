@@ -0,0 +1 @@
+../../../../../Pod/Classes/Testing/PKTFakeDevice.h
\ No newline at end of file
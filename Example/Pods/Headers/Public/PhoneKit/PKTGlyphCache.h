@@ -0,0 +1 @@
+../../../../../Pod/Classes/UI/PKTGlyphCache.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTLatencyHistogram.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTNumberIndex.h
\ No newline at end of file
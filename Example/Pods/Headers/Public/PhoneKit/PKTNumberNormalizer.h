@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTNumberNormalizer.h
\ No newline at end of file
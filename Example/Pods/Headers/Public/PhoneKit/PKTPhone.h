@@ -1 +1 @@
-../../../PhoneKit/Pod/Classes/Core/PKTPhone.h
\ No newline at end of file
+../../../../../Pod/Classes/Core/PKTPhone.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTPresenceRoster.h
\ No newline at end of file
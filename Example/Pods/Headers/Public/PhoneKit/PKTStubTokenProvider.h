@@ -0,0 +1 @@
+../../../../../Pod/Classes/Testing/PKTStubTokenProvider.h
\ No newline at end of file
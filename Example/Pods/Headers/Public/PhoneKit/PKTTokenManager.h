@@ -0,0 +1 @@
+../../../../../Pod/Classes/Core/PKTTokenManager.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../../../Pod/Classes/DialPad/UIView+FrameAccessor.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBAsYouTypeFormatter.h
\ No newline at end of file
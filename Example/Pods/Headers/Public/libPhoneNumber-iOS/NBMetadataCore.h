@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBMetadataCore.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBMetadataCoreMapper.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBMetadataCoreTest.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBMetadataCoreTestMapper.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBMetadataHelper.h
\ No newline at end of file
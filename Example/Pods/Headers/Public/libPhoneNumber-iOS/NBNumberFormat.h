@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBNumberFormat.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBPhoneMetaData.h
\ No newline at end of file
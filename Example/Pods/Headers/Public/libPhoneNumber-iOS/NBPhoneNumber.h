@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBPhoneNumber.h
\ No newline at end of file
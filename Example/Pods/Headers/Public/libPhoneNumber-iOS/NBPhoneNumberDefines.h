@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBPhoneNumberDefines.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBPhoneNumberDesc.h
\ No newline at end of file
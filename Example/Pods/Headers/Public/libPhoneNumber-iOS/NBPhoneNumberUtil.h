@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NBPhoneNumberUtil.h
\ No newline at end of file
@@ -1 +0,0 @@
-../../../libPhoneNumber-iOS/libPhoneNumber/NSArray+NBAdditions.h
\ No newline at end of file
@@ -1,5 +0,0 @@
-#import "PKTCallRecord.h"
-
-@implementation PKTCallRecord
-
-@end
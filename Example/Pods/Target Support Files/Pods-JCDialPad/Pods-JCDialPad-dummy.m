@@ -1,5 +0,0 @@
-#import <Foundation/Foundation.h>
-@interface PodsDummy_Pods_JCDialPad : NSObject
-@end
-@implementation PodsDummy_Pods_JCDialPad
-@end
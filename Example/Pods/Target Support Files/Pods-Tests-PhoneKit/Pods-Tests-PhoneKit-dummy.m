@@ -0,0 +1,5 @@
+#import <Foundation/Foundation.h>
+@interface PodsDummy_Pods_Tests_PhoneKit : NSObject
+@end
+@implementation PodsDummy_Pods_Tests_PhoneKit
+@end
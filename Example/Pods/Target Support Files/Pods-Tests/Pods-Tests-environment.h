@@ -0,0 +1,80 @@
+
+// To check if a library is compiled with CocoaPods you
+// can use the `COCOAPODS` macro definition which is
+// defined in the xcconfigs so it is available in
+// headers also when they are imported in the client
+// project.
+
+
+// FontasticIcons
+#define COCOAPODS_POD_AVAILABLE_FontasticIcons
+#define COCOAPODS_VERSION_MAJOR_FontasticIcons 0
+#define COCOAPODS_VERSION_MINOR_FontasticIcons 5
+#define COCOAPODS_VERSION_PATCH_FontasticIcons 0
+
+// PhoneKit
+#define COCOAPODS_POD_AVAILABLE_PhoneKit
+#define COCOAPODS_VERSION_MAJOR_PhoneKit 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit 0
+
+// PhoneKit/Core
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_Core
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_Core 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_Core 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_Core 0
+
+// PhoneKit/DialPad
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_DialPad
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_DialPad 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_DialPad 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_DialPad 0
+
+// PhoneKit/PhoneNumber
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_PhoneNumber
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_PhoneNumber 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_PhoneNumber 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_PhoneNumber 0
+
+// PhoneKit/Testing
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_Testing
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_Testing 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_Testing 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_Testing 0
+
+// PhoneKit/UI
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_UI
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_UI 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_UI 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_UI 0
+
+// ReactiveCocoa
+#define COCOAPODS_POD_AVAILABLE_ReactiveCocoa
+#define COCOAPODS_VERSION_MAJOR_ReactiveCocoa 2
+#define COCOAPODS_VERSION_MINOR_ReactiveCocoa 4
+#define COCOAPODS_VERSION_PATCH_ReactiveCocoa 7
+
+// ReactiveCocoa/Core
+#define COCOAPODS_POD_AVAILABLE_ReactiveCocoa_Core
+#define COCOAPODS_VERSION_MAJOR_ReactiveCocoa_Core 2
+#define COCOAPODS_VERSION_MINOR_ReactiveCocoa_Core 4
+#define COCOAPODS_VERSION_PATCH_ReactiveCocoa_Core 7
+
+// ReactiveCocoa/UI
+#define COCOAPODS_POD_AVAILABLE_ReactiveCocoa_UI
+#define COCOAPODS_VERSION_MAJOR_ReactiveCocoa_UI 2
+#define COCOAPODS_VERSION_MINOR_ReactiveCocoa_UI 4
+#define COCOAPODS_VERSION_PATCH_ReactiveCocoa_UI 7
+
+// ReactiveCocoa/no-arc
+#define COCOAPODS_POD_AVAILABLE_ReactiveCocoa_no_arc
+#define COCOAPODS_VERSION_MAJOR_ReactiveCocoa_no_arc 2
+#define COCOAPODS_VERSION_MINOR_ReactiveCocoa_no_arc 4
+#define COCOAPODS_VERSION_PATCH_ReactiveCocoa_no_arc 7
+
+// TwilioSDK
+#define COCOAPODS_POD_AVAILABLE_TwilioSDK
+#define COCOAPODS_VERSION_MAJOR_TwilioSDK 1
+#define COCOAPODS_VERSION_MINOR_TwilioSDK 2
+#define COCOAPODS_VERSION_PATCH_TwilioSDK 2
+
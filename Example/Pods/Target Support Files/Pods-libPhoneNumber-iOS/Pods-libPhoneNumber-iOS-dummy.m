@@ -1,5 +0,0 @@
-#import <Foundation/Foundation.h>
-@interface PodsDummy_Pods_libPhoneNumber_iOS : NSObject
-@end
-@implementation PodsDummy_Pods_libPhoneNumber_iOS
-@end
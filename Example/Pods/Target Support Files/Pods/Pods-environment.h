@@ -54,12 +54,6 @@
 #define COCOAPODS_VERSION_MINOR_FontasticIcons 5
 #define COCOAPODS_VERSION_PATCH_FontasticIcons 0
 
-// JCDialPad
-#define COCOAPODS_POD_AVAILABLE_JCDialPad
-#define COCOAPODS_VERSION_MAJOR_JCDialPad 0
-#define COCOAPODS_VERSION_MINOR_JCDialPad 1
-#define COCOAPODS_VERSION_PATCH_JCDialPad 1
-
 // PhoneKit
 #define COCOAPODS_POD_AVAILABLE_PhoneKit
 #define COCOAPODS_VERSION_MAJOR_PhoneKit 0
@@ -72,6 +66,18 @@
 #define COCOAPODS_VERSION_MINOR_PhoneKit_Core 2
 #define COCOAPODS_VERSION_PATCH_PhoneKit_Core 0
 
+// PhoneKit/DialPad
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_DialPad
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_DialPad 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_DialPad 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_DialPad 0
+
+// PhoneKit/PhoneNumber
+#define COCOAPODS_POD_AVAILABLE_PhoneKit_PhoneNumber
+#define COCOAPODS_VERSION_MAJOR_PhoneKit_PhoneNumber 0
+#define COCOAPODS_VERSION_MINOR_PhoneKit_PhoneNumber 2
+#define COCOAPODS_VERSION_PATCH_PhoneKit_PhoneNumber 0
+
 // PhoneKit/UI
 #define COCOAPODS_POD_AVAILABLE_PhoneKit_UI
 #define COCOAPODS_VERSION_MAJOR_PhoneKit_UI 0
@@ -108,9 +114,3 @@
 #define COCOAPODS_VERSION_MINOR_TwilioSDK 2
 #define COCOAPODS_VERSION_PATCH_TwilioSDK 2
 
-// libPhoneNumber-iOS
-#define COCOAPODS_POD_AVAILABLE_libPhoneNumber_iOS
-#define COCOAPODS_VERSION_MAJOR_libPhoneNumber_iOS 0
-#define COCOAPODS_VERSION_MINOR_libPhoneNumber_iOS 8
-#define COCOAPODS_VERSION_PATCH_libPhoneNumber_iOS 3
-
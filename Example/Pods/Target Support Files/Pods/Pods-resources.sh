@@ -47,6 +47,7 @@ install_resource()
       ;;
   esac
 }
+          install_resource "${BUILT_PRODUCTS_DIR}/PhoneKit.bundle"
           install_resource "FontasticIcons/FontasticIcons/Sources/Resources/Fonts/Entypo-Social.otf"
                     install_resource "FontasticIcons/FontasticIcons/Sources/Resources/Fonts/Entypo.otf"
                     install_resource "FontasticIcons/FontasticIcons/Sources/Resources/Fonts/fontawesome.ttf"
@@ -71,7 +72,6 @@ install_resource()
                     install_resource "TwilioSDK/Resources/dtmf_star.wav"
                     install_resource "TwilioSDK/Resources/incoming.wav"
                     install_resource "TwilioSDK/Resources/outgoing.wav"
-                    install_resource "libPhoneNumber-iOS/libPhoneNumber/NBPhoneNumberMetadata.plist"
           
 rsync -avr --copy-links --no-relative --exclude '*/.svn/*' --files-from="$RESOURCES_TO_COPY" / "${CONFIGURATION_BUILD_DIR}/${UNLOCALIZED_RESOURCES_FOLDER_PATH}"
 if [[ "${ACTION}" == "install" ]]; then
@@ -0,0 +1,147 @@
+//
+//  NBAsYouTypeFormatterPoolSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NBAsYouTypeFormatter.h"
+#import "NBPhoneNumberUtil.h"
+
+@interface NBAsYouTypeFormatter (NBAsYouTypeFormatterPoolSpec)
+
+- (void)setPhoneUtil_:(NBPhoneNumberUtil *)phoneUtil;
+
+@end
+
+// every intermediate result of typing number one character at a time
+static NSArray *NBTypeNumber(NBAsYouTypeFormatter *formatter, NSString *number)
+{
+    NSMutableArray *outputs = [NSMutableArray arrayWithCapacity:number.length];
+    for (NSUInteger i = 0; i < number.length; i++) {
+        [outputs addObject:[formatter inputDigit:[number substringWithRange:NSMakeRange(i, 1)]] ?: @""];
+    }
+    return outputs;
+}
+
+// a call log: mostly local numbers, some international, some short codes
+static NSArray *NBCallLogCorpus(NSUInteger count)
+{
+    NSArray *regions = @[@"US", @"GB", @"DE", @"FR", @"BR", @"JP"];
+    NSArray *prefixes = @[@"", @"", @"", @"+1", @"+44", @"+49", @"0"];
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:count];
+    srandom(5);
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableString *number = [NSMutableString stringWithString:prefixes[random() % prefixes.count]];
+        NSUInteger length = (i % 10 == 0) ? 5 : 10;
+        [number appendFormat:@"%ld", 2 + random() % 8];
+        while (number.length < length + ([number hasPrefix:@"+"] ? 2 : 0)) {
+            [number appendFormat:@"%ld", random() % 10];
+        }
+        [entries addObject:@[regions[random() % regions.count], number]];
+    }
+    return entries;
+}
+
+SPEC_BEGIN(NBAsYouTypeFormatterPoolSpec)
+
+describe(@"NBAsYouTypeFormatter pooling", ^{
+
+    it(@"formats with a pooled formatter exactly as with a new one", ^{
+        NSUInteger mismatches = 0;
+        for (NSArray *entry in NBCallLogCorpus(2000)) {
+            NBAsYouTypeFormatter *pooled = [NBAsYouTypeFormatter formatterWithRegionCode:entry[0]];
+            NBAsYouTypeFormatter *fresh  = [[NBAsYouTypeFormatter alloc] initWithRegionCode:entry[0]];
+            NSArray *expected = NBTypeNumber(fresh, entry[1]);
+            if (![NBTypeNumber(pooled, entry[1]) isEqualToArray:expected]) {
+                if (mismatches++ < 20)
+                    NSLog(@"%@ in %@: expected %@", entry[1], entry[0], expected);
+            }
+            [NBAsYouTypeFormatter recycleFormatter:pooled];
+        }
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    it(@"hands back a recycled formatter, cleared", ^{
+        NBAsYouTypeFormatter *formatter = [NBAsYouTypeFormatter formatterWithRegionCode:@"NZ"];
+        [formatter inputString:@"021234567"];
+        [NBAsYouTypeFormatter recycleFormatter:formatter];
+
+        NBAsYouTypeFormatter *reused = [NBAsYouTypeFormatter formatterWithRegionCode:@"NZ"];
+        [[reused should] beIdenticalTo:formatter];
+        [[[reused inputDigit:@"0"] should] equal:@"0"];
+        [NBAsYouTypeFormatter recycleFormatter:reused];
+    });
+
+    it(@"keeps a formatter recycled twice only once, and only a few per region", ^{
+        NSMutableArray *formatters = [NSMutableArray array];
+        for (NSUInteger i = 0; i < 8; i++) {
+            [formatters addObject:[NBAsYouTypeFormatter formatterWithRegionCode:@"IE"]];
+        }
+        for (NBAsYouTypeFormatter *formatter in formatters) {
+            [NBAsYouTypeFormatter recycleFormatter:formatter];
+        }
+        [NBAsYouTypeFormatter recycleFormatter:formatters[0]];
+
+        NSMutableSet *handedOut = [NSMutableSet set];
+        for (NSUInteger i = 0; i < 8; i++) {
+            NBAsYouTypeFormatter *formatter = [NBAsYouTypeFormatter formatterWithRegionCode:@"IE"];
+            if ([formatters indexOfObjectIdenticalTo:formatter] != NSNotFound)
+                [handedOut addObject:[NSValue valueWithNonretainedObject:formatter]];
+        }
+        [[theValue(handedOut.count) should] equal:theValue(4)];
+    });
+
+    it(@"ignores nil", ^{
+        [[theBlock(^{
+            [NBAsYouTypeFormatter recycleFormatter:nil];
+        }) shouldNot] raise];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        __block NSArray *corpus = nil;
+        beforeAll(^{
+            corpus = NBCallLogCorpus(5000);
+        });
+        afterAll(^{
+            corpus = nil;
+        });
+
+        it(@"times formatting a call log with pooled formatters against one formatter and phone util per number", ^{
+            // what each formatter cost before: its own NBPhoneNumberUtil,
+            // whose regex caches start out empty
+            NSTimeInterval unshared = PKTBenchmark(3, ^{
+                for (NSArray *entry in corpus) {
+                    @autoreleasepool {
+                        NBAsYouTypeFormatter *formatter = [[NBAsYouTypeFormatter alloc] initWithRegionCode:entry[0]];
+                        [formatter setPhoneUtil_:[[NBPhoneNumberUtil alloc] init]];
+                        [formatter inputString:entry[1]];
+                    }
+                }
+            });
+            NSTimeInterval fresh = PKTBenchmark(3, ^{
+                for (NSArray *entry in corpus) {
+                    @autoreleasepool {
+                        NBAsYouTypeFormatter *formatter = [[NBAsYouTypeFormatter alloc] initWithRegionCode:entry[0]];
+                        [formatter inputString:entry[1]];
+                    }
+                }
+            });
+            NSTimeInterval pooled = PKTBenchmark(3, ^{
+                for (NSArray *entry in corpus) {
+                    @autoreleasepool {
+                        NBAsYouTypeFormatter *formatter = [NBAsYouTypeFormatter formatterWithRegionCode:entry[0]];
+                        [formatter inputString:entry[1]];
+                        [NBAsYouTypeFormatter recycleFormatter:formatter];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"inputString:, formatter and phone util per number", corpus.count, unshared);
+            PKTLogBenchmark(@"inputString:, new formatter per number", corpus.count, fresh);
+            PKTLogBenchmark(@"inputString:, pooled formatters", corpus.count, pooled);
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,269 @@
+//
+//  NBCharacterFoldingSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NBPhoneNumberUtil.h"
+#import "NBMetadataHelper.h"
+
+// the foldings NBPhoneNumberUtil.m passes for the diallable, alpha phone and
+// grouping-symbol normalizations
+static const uint8_t NBSpecFoldingDiallable          = 0x11;
+static const uint8_t NBSpecFoldingAlphaPhone         = 0x8F;
+static const uint8_t NBSpecFoldingPlusNumberGrouping = 0x2D;
+
+@interface NBPhoneNumberUtil (NBCharacterFoldingSpec)
+
+- (NSString*)normalizeHelper:(NSString*)sourceString folding:(uint8_t)folding removeNonMatches:(BOOL)removeNonMatches;
+
+@end
+
+#pragma mark - the mappings the fold table replaced
+
+static void NBAddRange(NSMutableDictionary *map, unichar first, unichar last, NSString *(^value)(unichar))
+{
+    for (unichar c = first; c <= last; c++) {
+        map[[NSString stringWithCharacters:&c length:1]] = value(c);
+    }
+}
+
+static NSDictionary *NBLegacyAlphaMappings(void)
+{
+    NSString *keypad = @"22233344455566677778889999";
+    NSMutableDictionary *map = [NSMutableDictionary dictionary];
+    NBAddRange(map, 'A', 'Z', ^NSString *(unichar c) { return [keypad substringWithRange:NSMakeRange(c - 'A', 1)]; });
+    return map;
+}
+
+static NSDictionary *NBLegacyAllNormalizationMappings(NBPhoneNumberUtil *util)
+{
+    NSMutableDictionary *map = [util.DIGIT_MAPPINGS mutableCopy];
+    [map addEntriesFromDictionary:NBLegacyAlphaMappings()];
+    return map;
+}
+
+static NSDictionary *NBLegacyDiallableMappings(void)
+{
+    NSMutableDictionary *map = [NSMutableDictionary dictionary];
+    NBAddRange(map, '0', '9', ^NSString *(unichar c) { return [NSString stringWithCharacters:&c length:1]; });
+    map[@"+"] = @"+";
+    map[@"*"] = @"*";
+    return map;
+}
+
+static NSDictionary *NBLegacyPlusNumberGroupingSymbols(void)
+{
+    NSMutableDictionary *map = [NSMutableDictionary dictionary];
+    NBAddRange(map, '0', '9', ^NSString *(unichar c) { return [NSString stringWithCharacters:&c length:1]; });
+    NBAddRange(map, 'A', 'Z', ^NSString *(unichar c) { return [NSString stringWithCharacters:&c length:1]; });
+    NBAddRange(map, 'a', 'z', ^NSString *(unichar c) { unichar upper = c - 'a' + 'A'; return [NSString stringWithCharacters:&upper length:1]; });
+    for (NSString *dash in @[@"-", @"\uFF0D", @"\u2010", @"\u2011", @"\u2012", @"\u2013", @"\u2014", @"\u2015", @"\u2212"])
+        map[dash] = @"-";
+    for (NSString *slash in @[@"/", @"\uFF0F"])
+        map[slash] = @"/";
+    for (NSString *space in @[@" ", @"\u3000", @"\u2060"])
+        map[space] = @" ";
+    for (NSString *dot in @[@".", @"\uFF0E"])
+        map[dot] = @".";
+    return map;
+}
+
+// stringByReplacingOccurrencesString:withMap:removeNonMatches:
+static NSString *NBLegacyReplace(NSString *source, NSDictionary *map, BOOL removeNonMatches)
+{
+    NSMutableString *target = [NSMutableString string];
+    for (NSUInteger i = 0; i < source.length; i++) {
+        unichar oneChar = [source characterAtIndex:i];
+        NSString *key = [NSString stringWithCharacters:&oneChar length:1];
+        NSString *mapped = map[key];
+        if (mapped)
+            [target appendString:mapped];
+        else if (!removeNonMatches)
+            [target appendString:key];
+    }
+    return target;
+}
+
+// normalizeHelper:normalizationReplacements:removeNonMatches:, which
+// uppercased each character before the lookup
+static NSString *NBLegacyNormalizeHelper(NSString *source, NSDictionary *map, BOOL removeNonMatches)
+{
+    NSMutableString *target = [NSMutableString string];
+    for (NSUInteger i = 0; i < source.length; i++) {
+        unichar oneChar = [source characterAtIndex:i];
+        NSString *key = [NSString stringWithCharacters:&oneChar length:1];
+        NSString *mapped = map[[key uppercaseString]];
+        if (mapped)
+            [target appendString:mapped];
+        else if (!removeNonMatches)
+            [target appendString:key];
+    }
+    return target;
+}
+
+static NSString *NBLegacyNormalizeDigitsOnly(NBPhoneNumberUtil *util, NSString *number)
+{
+    return NBLegacyReplace([NBMetadataHelper normalizeNonBreakingSpace:number], util.DIGIT_MAPPINGS, YES);
+}
+
+static NSString *NBLegacyConvertAlphaCharacters(NSDictionary *allNormalization, NSString *number)
+{
+    return NBLegacyReplace([NBMetadataHelper normalizeNonBreakingSpace:number], allNormalization, NO);
+}
+
+// numbers as users type and paste them: ASCII, fullwidth and Arabic digits,
+// vanity letters, and the separators each script uses
+static NSArray *NBMixedScriptCorpus(NSUInteger count)
+{
+    NSArray *scripts = @[@"0123456789", @"\uFF10\uFF11\uFF12\uFF13\uFF14\uFF15\uFF16\uFF17\uFF18\uFF19",
+                         @"\u0660\u0661\u0662\u0663\u0664\u0665\u0666\u0667\u0668\u0669",
+                         @"\u06F0\u06F1\u06F2\u06F3\u06F4\u06F5\u06F6\u06F7\u06F8\u06F9"];
+    NSArray *separators = @[@" ", @"-", @"\u00A0", @"\u3000", @"\uFF0D", @".", @"/", @"\u2013"];
+    NSArray *words = @[@"FLOWERS", @"call", @"TAXI", @"Pizza"];
+
+    NSMutableArray *numbers = [NSMutableArray arrayWithCapacity:count];
+    srandom(11);
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *digits = scripts[random() % scripts.count];
+        NSString *separator = separators[random() % separators.count];
+        NSMutableString *number = [NSMutableString stringWithString:(i % 3 == 0) ? @"+" : @""];
+        for (NSUInteger group = 0; group < 3; group++) {
+            if (group > 0)
+                [number appendString:separator];
+            for (NSUInteger d = 0; d < (group == 2 ? 4 : 3); d++) {
+                [number appendString:[digits substringWithRange:NSMakeRange(random() % 10, 1)]];
+            }
+        }
+        if (i % 7 == 0)
+            [number appendFormat:@"%@%@", separator, words[random() % words.count]];
+        [numbers addObject:number];
+    }
+    return numbers;
+}
+
+SPEC_BEGIN(NBCharacterFoldingSpec)
+
+describe(@"NBPhoneNumberUtil character folding", ^{
+
+    __block NBPhoneNumberUtil *util = nil;
+    __block NSDictionary *allNormalization = nil;
+    beforeAll(^{
+        util = [[NBPhoneNumberUtil alloc] init];
+        allNormalization = NBLegacyAllNormalizationMappings(util);
+    });
+
+    it(@"folds every UTF-16 code unit as the mapping dictionaries did", ^{
+        NSDictionary *diallable = NBLegacyDiallableMappings();
+        NSDictionary *grouping  = NBLegacyPlusNumberGroupingSymbols();
+
+        NSUInteger mismatches = 0;
+        for (uint32_t unit = 0; unit <= 0xFFFF; unit++) {
+            @autoreleasepool {
+                unichar c = (unichar)unit;
+                NSString *s = [NSString stringWithCharacters:&c length:1];
+                NSArray *checks = @[
+                    @[[util normalizeDigitsOnly:s], NBLegacyNormalizeDigitsOnly(util, s)],
+                    @[[util convertAlphaCharactersInNumber:s], NBLegacyConvertAlphaCharacters(allNormalization, s)],
+                    @[[util normalizeHelper:s folding:NBSpecFoldingAlphaPhone removeNonMatches:YES], NBLegacyNormalizeHelper(s, allNormalization, YES)],
+                    @[[util normalizeHelper:s folding:NBSpecFoldingDiallable removeNonMatches:YES], NBLegacyNormalizeHelper(s, diallable, YES)],
+                    @[[util normalizeHelper:s folding:NBSpecFoldingPlusNumberGrouping removeNonMatches:NO], NBLegacyNormalizeHelper(s, grouping, NO)],
+                ];
+                for (NSUInteger i = 0; i < checks.count; i++) {
+                    if (![checks[i][0] isEqualToString:checks[i][1]]) {
+                        if (mismatches++ < 20)
+                            NSLog(@"U+%04X, normalization %lu: %@, expected %@", unit, (unsigned long)i, checks[i][0], checks[i][1]);
+                    }
+                }
+            }
+        }
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    it(@"matches lowercase letters only where the old lookup uppercased", ^{
+        [[[util convertAlphaCharactersInNumber:@"1-800-flowers"] should] equal:@"1-800-flowers"];
+        [[[util convertAlphaCharactersInNumber:@"1-800-FLOWERS"] should] equal:@"1-800-3569377"];
+        [[[util normalizePhoneNumber:@"1-800-flowers"] should] equal:@"18003569377"];
+        [[[util normalizePhoneNumber:@"1-800-\u0131\u017Fland"] should] equal:@"18004752263"];
+    });
+
+    it(@"normalizes numbers longer than the inline buffer", ^{
+        NSMutableString *number = [NSMutableString string];
+        for (NSUInteger i = 0; i < 40; i++) {
+            [number appendString:@"\uFF14-\u0661"];
+        }
+        [[[util normalizeDigitsOnly:number] should] equal:NBLegacyNormalizeDigitsOnly(util, number)];
+        [[[util convertAlphaCharactersInNumber:number] should] equal:NBLegacyConvertAlphaCharacters(allNormalization, number)];
+    });
+
+    it(@"normalizes a mixed-script corpus as before", ^{
+        for (NSString *number in NBMixedScriptCorpus(2000)) {
+            [[[util normalizeDigitsOnly:number] should] equal:NBLegacyNormalizeDigitsOnly(util, number)];
+            [[[util convertAlphaCharactersInNumber:number] should] equal:NBLegacyConvertAlphaCharacters(allNormalization, number)];
+        }
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        __block NSArray *corpus = nil;
+        beforeAll(^{
+            corpus = NBMixedScriptCorpus(100000);
+        });
+        afterAll(^{
+            corpus = nil;
+        });
+
+        it(@"times normalizing digits in mixed scripts against the dictionary lookups", ^{
+            NSTimeInterval legacy = PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        NBLegacyNormalizeDigitsOnly(util, number);
+                    }
+                }
+            });
+            NSTimeInterval folded = PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        [util normalizeDigitsOnly:number];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"legacy normalizeDigitsOnly, mixed scripts", corpus.count, legacy);
+            PKTLogBenchmark(@"normalizeDigitsOnly, mixed scripts", corpus.count, folded);
+        });
+
+        it(@"times converting alpha characters in mixed scripts against the dictionary lookups", ^{
+            NSTimeInterval legacy = PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        NBLegacyConvertAlphaCharacters(allNormalization, number);
+                    }
+                }
+            });
+            NSTimeInterval folded = PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        [util convertAlphaCharactersInNumber:number];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"legacy convertAlphaCharactersInNumber, mixed scripts", corpus.count, legacy);
+            PKTLogBenchmark(@"convertAlphaCharactersInNumber, mixed scripts", corpus.count, folded);
+        });
+
+        it(@"measures normalizePhoneNumber on the mixed-script corpus", ^{
+            NSTimeInterval seconds = PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        [util normalizePhoneNumber:number];
+                    }
+                }
+            });
+            PKTLogBenchmark(@"normalizePhoneNumber, mixed scripts", corpus.count, seconds);
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,250 @@
+//
+//  NBFormatRewriterSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NBPhoneNumberUtil.h"
+#import "NBMetadataHelper.h"
+#import "NBPhoneMetaData.h"
+#import "NBPhoneNumberDesc.h"
+#import "NBNumberFormat.h"
+#import "NBPhoneNumber.h"
+
+@interface NBPhoneNumberUtil (NBFormatRewriterSpec)
+
+- (NSString*)formatNsnUsingPattern:(NSString*)nationalNumber formattingPattern:(NBNumberFormat*)formattingPattern numberFormat:(NBEPhoneNumberFormat)numberFormat carrierCode:(NSString*)opt_carrierCode;
+- (NSString*)replaceFirstStringByRegex:(NSString*)sourceString regex:(NSString*)pattern withTemplate:(NSString*)templateString;
+
+@end
+
+// formatNsnUsingPattern: as it was before NBFormatRewriter: regex
+// replacements only
+static NSString *NBRegexFormatNsn(NBPhoneNumberUtil *util, NSString *nationalNumber, NBNumberFormat *format,
+                                  NBEPhoneNumberFormat numberFormat, NSString *carrierCode)
+{
+    NSString *rule = format.format;
+    NSString *formatted = nil;
+    if (numberFormat == NBEPhoneNumberFormatNATIONAL && [NBMetadataHelper hasValue:carrierCode] &&
+        format.domesticCarrierCodeFormattingRule.length > 0) {
+        NSString *carrierCodeRule = [util replaceStringByRegex:format.domesticCarrierCodeFormattingRule regex:@"\\$CC" withTemplate:carrierCode];
+        rule      = [util replaceFirstStringByRegex:rule regex:@"(\\$\\d)" withTemplate:carrierCodeRule];
+        formatted = [util replaceStringByRegex:nationalNumber regex:format.pattern withTemplate:rule];
+    } else if (numberFormat == NBEPhoneNumberFormatNATIONAL && [NBMetadataHelper hasValue:format.nationalPrefixFormattingRule]) {
+        rule      = [util replaceFirstStringByRegex:rule regex:@"(\\$\\d)" withTemplate:format.nationalPrefixFormattingRule];
+        formatted = [util replaceStringByRegex:nationalNumber regex:format.pattern withTemplate:rule];
+    } else {
+        formatted = [util replaceStringByRegex:nationalNumber regex:format.pattern withTemplate:rule];
+    }
+
+    if (numberFormat == NBEPhoneNumberFormatRFC3966) {
+        // VALID_PUNCTUATION
+        NSString *separator = @"[-x‐-―−ー－-／ ­​⁠　()（）［］.\\[\\]/~⁓∼～]+";
+        formatted = [util replaceStringByRegex:formatted regex:[@"^" stringByAppendingString:separator] withTemplate:@""];
+        formatted = [util replaceStringByRegex:formatted regex:separator withTemplate:@"-"];
+    }
+    return formatted;
+}
+
+static BOOL NBMatchesEntirely(NSString *string, NSString *pattern)
+{
+    NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:[NSString stringWithFormat:@"^(?:%@)$", pattern]
+                                                                           options:0 error:NULL];
+    return [regex numberOfMatchesInString:string options:0 range:NSMakeRange(0, string.length)] == 1;
+}
+
+// every region's example numbers, and variants of them with other digits
+// and lengths, paired with each of the region's formats they fully match
+static NSArray *NBFormatCorpus(NSArray *regionCodes, NSUInteger variants)
+{
+    NSMutableArray *pairs = [NSMutableArray array];
+    srandom(7);
+    for (NSString *regionCode in regionCodes) {
+        NBPhoneMetaData *metadata = [NBMetadataHelper getMetadataForRegion:regionCode];
+        if (!metadata)
+            continue;
+
+        NSMutableSet *numbers = [NSMutableSet set];
+        for (NBPhoneNumberDesc *desc in @[metadata.fixedLine ?: [NSNull null], metadata.mobile ?: [NSNull null],
+                                          metadata.tollFree ?: [NSNull null], metadata.premiumRate ?: [NSNull null],
+                                          metadata.sharedCost ?: [NSNull null], metadata.voip ?: [NSNull null],
+                                          metadata.personalNumber ?: [NSNull null], metadata.uan ?: [NSNull null]]) {
+            NSString *example = [desc isKindOfClass:[NBPhoneNumberDesc class]] ? desc.exampleNumber : nil;
+            if (example.length < 3)
+                continue;
+            [numbers addObject:example];
+            for (NSUInteger i = 0; i < variants; i++) {
+                NSMutableString *variant = [[example substringToIndex:3] mutableCopy];
+                NSInteger length = (NSInteger)example.length + (NSInteger)(random() % 5) - 2;
+                while ((NSInteger)variant.length < length) {
+                    [variant appendFormat:@"%ld", random() % 10];
+                }
+                [numbers addObject:variant];
+            }
+        }
+
+        NSArray *formats = [(metadata.numberFormats ?: @[]) arrayByAddingObjectsFromArray:(metadata.intlNumberFormats ?: @[])];
+        for (NSString *number in numbers) {
+            for (NBNumberFormat *format in formats) {
+                if ([NBMetadataHelper hasValue:format.pattern] && NBMatchesEntirely(number, format.pattern))
+                    [pairs addObject:@[number, format]];
+            }
+        }
+    }
+    return pairs;
+}
+
+SPEC_BEGIN(NBFormatRewriterSpec)
+
+describe(@"NBFormatRewriter", ^{
+
+    __block NBPhoneNumberUtil *util = nil;
+    beforeAll(^{
+        util = [[NBPhoneNumberUtil alloc] init];
+    });
+
+    it(@"formats exactly as the regex templates do, in every region", ^{
+        NSArray *pairs = NBFormatCorpus([NSLocale ISOCountryCodes], 8);
+        [[theValue(pairs.count) should] beGreaterThan:theValue(1000)];
+
+        NSUInteger mismatches = 0;
+        for (NSArray *pair in pairs) {
+            NSString *number = pair[0];
+            NBNumberFormat *format = pair[1];
+            for (NSNumber *numberFormat in @[@(NBEPhoneNumberFormatNATIONAL), @(NBEPhoneNumberFormatINTERNATIONAL),
+                                             @(NBEPhoneNumberFormatRFC3966)]) {
+                for (NSString *carrierCode in @[@"", @"15"]) {
+                    NBEPhoneNumberFormat style = [numberFormat integerValue];
+                    NSString *expected = NBRegexFormatNsn(util, number, format, style, carrierCode);
+                    NSString *actual   = [util formatNsnUsingPattern:number formattingPattern:format numberFormat:style carrierCode:carrierCode];
+                    if (![actual isEqualToString:expected]) {
+                        if (mismatches++ < 20)
+                            NSLog(@"%@ with %@ -> %@, expected %@", number, format.pattern, actual, expected);
+                    }
+                }
+            }
+        }
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    it(@"keeps the regex path for formats it can't compile", ^{
+        NBNumberFormat *format = [[NBNumberFormat alloc] initWithPattern:@"(\\d+)(.*)" withFormat:@"$1 $2" withLeadingDigitsPatterns:nil
+                                            withNationalPrefixFormattingRule:nil whenFormatting:NO withDomesticCarrierCodeFormattingRule:nil];
+        NSString *actual = [util formatNsnUsingPattern:@"800FLOWERS" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:nil];
+        [[actual should] equal:NBRegexFormatNsn(util, @"800FLOWERS", format, NBEPhoneNumberFormatNATIONAL, nil)];
+    });
+
+    it(@"rebuilds when a format's template changes", ^{
+        NBNumberFormat *format = [[NBNumberFormat alloc] initWithPattern:@"(\\d{3})(\\d{4})" withFormat:@"$1-$2" withLeadingDigitsPatterns:nil
+                                            withNationalPrefixFormattingRule:nil whenFormatting:NO withDomesticCarrierCodeFormattingRule:nil];
+        [[[util formatNsnUsingPattern:@"5550123" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:nil] should] equal:@"555-0123"];
+        format.format = @"$1 $2";
+        [[[util formatNsnUsingPattern:@"5550123" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:nil] should] equal:@"555 0123"];
+    });
+
+    it(@"copies a carrier code in as it is, template characters and all", ^{
+        NBNumberFormat *format = [[NBNumberFormat alloc] initWithPattern:@"(\\d{2})(\\d{4})" withFormat:@"$1 $2" withLeadingDigitsPatterns:nil
+                                            withNationalPrefixFormattingRule:nil whenFormatting:NO withDomesticCarrierCodeFormattingRule:@"0 $CC ($1)"];
+        NSString *expected = @"0 1$2\\x (11) 2345";
+        [[[util formatNsnUsingPattern:@"112345" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:@"1$2\\x"] should] equal:expected];
+        [[[util formatNsnUsingPattern:@"112345" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:@"15"] should] equal:@"0 15 (11) 2345"];
+
+        // and so does the regex path
+        format.pattern = @"(\\d{2})(\\d+)";
+        [[[util formatNsnUsingPattern:@"112345" formattingPattern:format numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:@"1$2\\x"] should] equal:expected];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        NSArray *regions = @[@"US", @"GB", @"DE", @"FR", @"IT", @"ES", @"BR", @"MX", @"IN", @"CN", @"JP", @"KR", @"AU", @"RU", @"ZA",
+                             @"NG", @"EG", @"AR", @"SE", @"NL"];
+
+        it(@"times formatting a multi-region corpus against the regex templates", ^{
+            NSArray *pairs = NBFormatCorpus(regions, 50);
+            [util prewarmRegularExpressionsForRegions:regions];
+
+            NSUInteger repeats = MAX(1, 100000 / MAX(pairs.count, 1));
+            NSTimeInterval regex = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        @autoreleasepool {
+                            NBRegexFormatNsn(util, pair[0], pair[1], NBEPhoneNumberFormatNATIONAL, nil);
+                        }
+                    }
+                }
+            });
+            NSTimeInterval rewritten = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        @autoreleasepool {
+                            [util formatNsnUsingPattern:pair[0] formattingPattern:pair[1] numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:nil];
+                        }
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"regex formatNsn, 20 regions", repeats * pairs.count, regex);
+            PKTLogBenchmark(@"rewriter formatNsn, 20 regions", repeats * pairs.count, rewritten);
+        });
+
+        it(@"times formatting with carrier codes against the regex templates", ^{
+            NSMutableArray *pairs = [NSMutableArray array];
+            for (NSArray *pair in NBFormatCorpus(regions, 50)) {
+                if ([pair[1] domesticCarrierCodeFormattingRule].length > 0)
+                    [pairs addObject:pair];
+            }
+            NSArray *codes = @[@"15", @"21", @"31", @"41"];
+
+            NSUInteger repeats = MAX(1, 100000 / MAX(pairs.count, 1));
+            NSTimeInterval regex = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        @autoreleasepool {
+                            NBRegexFormatNsn(util, pair[0], pair[1], NBEPhoneNumberFormatNATIONAL, codes[r % codes.count]);
+                        }
+                    }
+                }
+            });
+            NSTimeInterval rewritten = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        @autoreleasepool {
+                            [util formatNsnUsingPattern:pair[0] formattingPattern:pair[1] numberFormat:NBEPhoneNumberFormatNATIONAL carrierCode:codes[r % codes.count]];
+                        }
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"regex formatNsn with carrier codes", repeats * pairs.count, regex);
+            PKTLogBenchmark(@"rewriter formatNsn with carrier codes", repeats * pairs.count, rewritten);
+            [[theValue(pairs.count) should] beGreaterThan:theValue(0)];
+        });
+
+        it(@"measures end-to-end formatting of parsed numbers", ^{
+            NSMutableArray *numbers = [NSMutableArray array];
+            for (NSString *regionCode in regions) {
+                for (NBEPhoneNumberType type = NBEPhoneNumberTypeFIXED_LINE; type <= NBEPhoneNumberTypeMOBILE; type++) {
+                    NBPhoneNumber *number = [util getExampleNumberForType:regionCode type:type error:NULL];
+                    if (number)
+                        [numbers addObject:number];
+                }
+            }
+
+            NSUInteger repeats = MAX(1, 20000 / MAX(numbers.count, 1));
+            NSTimeInterval seconds = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NBPhoneNumber *number in numbers) {
+                        @autoreleasepool {
+                            [util format:number numberFormat:NBEPhoneNumberFormatNATIONAL error:NULL];
+                            [util format:number numberFormat:NBEPhoneNumberFormatINTERNATIONAL error:NULL];
+                        }
+                    }
+                }
+            });
+            PKTLogBenchmark(@"format: national + international, 20 regions", 2 * repeats * numbers.count, seconds);
+            [[theValue(numbers.count) should] beGreaterThan:theValue(0)];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,107 @@
+//
+//  NBMetadataHelperSpec.m
+//  Tests
+//
+
+#import "NBMetadataHelper.h"
+#import "NBPhoneMetaData.h"
+
+static NSString *NBTemporaryArchivePath(void)
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"archive"]];
+}
+
+SPEC_BEGIN(NBMetadataHelperSpec)
+
+describe(@"NBMetadataHelper", ^{
+
+    __block NSUInteger limit = 0;
+    beforeEach(^{
+        limit = [NBMetadataHelper metadataCacheLimit];
+        [NBMetadataHelper setMetadataCacheLimit:8];
+        [NBMetadataHelper clearMetadataCache];
+    });
+    afterEach(^{
+        [NBMetadataHelper setMetadataCacheLimit:limit];
+        [NBMetadataHelper clearMetadataCache];
+    });
+
+    it(@"counts cache hits and misses", ^{
+        NBPhoneMetaData *us = [NBMetadataHelper getMetadataForRegion:@"US"];
+        [[us.countryCode should] equal:@1];
+        [[[NBMetadataHelper getMetadataForRegion:@"US"] should] beIdenticalTo:us];
+        [[[NBMetadataHelper getMetadataForRegion:@"us"] should] beIdenticalTo:us];
+        [[[NBMetadataHelper getMetadataForRegion:@"GB"] should] beNonNil];
+        [[NBMetadataHelper getMetadataForRegion:@"ZZ"] shouldBeNil];
+        [[NBMetadataHelper getMetadataForRegion:@" "] shouldBeNil];
+
+        [[theValue([NBMetadataHelper metadataCacheHitCount]) should] equal:theValue(2)];
+        [[theValue([NBMetadataHelper metadataCacheMissCount]) should] equal:theValue(3)];
+
+        [NBMetadataHelper clearMetadataCache];
+        [[theValue([NBMetadataHelper metadataCacheHitCount]) should] equal:theValue(0)];
+        [[theValue([NBMetadataHelper metadataCacheMissCount]) should] equal:theValue(0)];
+        [[[NBMetadataHelper getMetadataForRegion:@"US"] shouldNot] beIdenticalTo:us];
+    });
+
+    it(@"evicts the least recently used region", ^{
+        [NBMetadataHelper setMetadataCacheLimit:2];
+        NBPhoneMetaData *us = [NBMetadataHelper getMetadataForRegion:@"US"];
+        NBPhoneMetaData *gb = [NBMetadataHelper getMetadataForRegion:@"GB"];
+        [NBMetadataHelper getMetadataForRegion:@"US"];
+        NBPhoneMetaData *fr = [NBMetadataHelper getMetadataForRegion:@"FR"];
+
+        [[[NBMetadataHelper getMetadataForRegion:@"US"] should] beIdenticalTo:us];
+        [[[NBMetadataHelper getMetadataForRegion:@"GB"] shouldNot] beIdenticalTo:gb];
+        [[[NBMetadataHelper getMetadataForRegion:@"FR"] shouldNot] beIdenticalTo:fr];
+        [[theValue([NBMetadataHelper metadataCacheHitCount]) should] equal:theValue(2)];
+        [[theValue([NBMetadataHelper metadataCacheMissCount]) should] equal:theValue(5)];
+    });
+
+    it(@"trims the cache when its limit shrinks", ^{
+        NBPhoneMetaData *us = [NBMetadataHelper getMetadataForRegion:@"US"];
+        NBPhoneMetaData *gb = [NBMetadataHelper getMetadataForRegion:@"GB"];
+        [NBMetadataHelper setMetadataCacheLimit:1];
+
+        [[[NBMetadataHelper getMetadataForRegion:@"GB"] should] beIdenticalTo:gb];
+        [[[NBMetadataHelper getMetadataForRegion:@"US"] shouldNot] beIdenticalTo:us];
+        [[theValue([NBMetadataHelper metadataCacheMissCount]) should] equal:theValue(3)];
+    });
+
+    it(@"reads regions back from a precompiled archive", ^{
+        NSString *path = NBTemporaryArchivePath();
+        NSError *error = nil;
+        [[theValue([NBMetadataHelper writeMetadataArchiveToPath:path error:&error]) should] beYes];
+        [[theValue([NBMetadataHelper loadMetadataArchiveAtPath:path error:&error]) should] beYes];
+        [error shouldBeNil];
+
+        NBPhoneMetaData *us = [NBMetadataHelper getMetadataForRegion:@"US"];
+        [[us.countryCode should] equal:@1];
+        [[us.nationalPrefix should] equal:@"1"];
+        [[theValue(us.numberFormats.count) should] beGreaterThan:theValue(0)];
+        [[[[NBMetadataHelper getMetadataForNonGeographicalRegion:@800] countryCode] should] equal:@800];
+        [[theValue([NBMetadataHelper metadataCacheMissCount]) should] equal:theValue(2)];
+
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    });
+
+    it(@"refuses a corrupt or truncated archive", ^{
+        NSString *path = NBTemporaryArchivePath();
+        [NBMetadataHelper writeMetadataArchiveToPath:path error:NULL];
+        NSData *data = [NSData dataWithContentsOfFile:path];
+        [[data subdataWithRange:NSMakeRange(0, data.length / 2)] writeToFile:path atomically:YES];
+
+        NSError *error = nil;
+        [[theValue([NBMetadataHelper loadMetadataArchiveAtPath:path error:&error]) should] beNo];
+        [[theValue(error.code) should] equal:theValue(NSFileReadCorruptFileError)];
+
+        [[@"not an archive" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES];
+        error = nil;
+        [[theValue([NBMetadataHelper loadMetadataArchiveAtPath:path error:&error]) should] beNo];
+        [[theValue(error.code) should] equal:theValue(NSFileReadCorruptFileError)];
+
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    });
+});
+
+SPEC_END
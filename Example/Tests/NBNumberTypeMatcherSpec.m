@@ -0,0 +1,204 @@
+//
+//  NBNumberTypeMatcherSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NBPhoneNumberUtil.h"
+#import "NBMetadataHelper.h"
+#import "NBPhoneMetaData.h"
+#import "NBPhoneNumberDesc.h"
+#import "NBPhoneNumber.h"
+
+@interface NBPhoneNumberUtil (NBNumberTypeMatcherSpec)
+
+- (NBEPhoneNumberType)getNumberTypeHelper:(NSString*)nationalNumber metadata:(NBPhoneMetaData*)metadata;
+- (BOOL)isNumberMatchingDesc:(NSString*)nationalNumber numberDesc:(NBPhoneNumberDesc*)numberDesc;
+
+@end
+
+// getNumberTypeHelper:metadata: as it was before the digit automaton: one
+// regex match per desc, in order of precedence
+static NBEPhoneNumberType NBRegexNumberType(NBPhoneNumberUtil *util, NSString *nationalNumber, NBPhoneMetaData *metadata)
+{
+    if (![NBMetadataHelper hasValue:metadata.generalDesc.nationalNumberPattern] ||
+        ![util isNumberMatchingDesc:nationalNumber numberDesc:metadata.generalDesc])
+        return NBEPhoneNumberTypeUNKNOWN;
+
+    NSArray *ordered = @[@[metadata.premiumRate ?: [NSNull null], @(NBEPhoneNumberTypePREMIUM_RATE)],
+                         @[metadata.tollFree ?: [NSNull null], @(NBEPhoneNumberTypeTOLL_FREE)],
+                         @[metadata.sharedCost ?: [NSNull null], @(NBEPhoneNumberTypeSHARED_COST)],
+                         @[metadata.voip ?: [NSNull null], @(NBEPhoneNumberTypeVOIP)],
+                         @[metadata.personalNumber ?: [NSNull null], @(NBEPhoneNumberTypePERSONAL_NUMBER)],
+                         @[metadata.pager ?: [NSNull null], @(NBEPhoneNumberTypePAGER)],
+                         @[metadata.uan ?: [NSNull null], @(NBEPhoneNumberTypeUAN)],
+                         @[metadata.voicemail ?: [NSNull null], @(NBEPhoneNumberTypeVOICEMAIL)]];
+    for (NSArray *entry in ordered) {
+        if ([entry[0] isKindOfClass:[NBPhoneNumberDesc class]] && [util isNumberMatchingDesc:nationalNumber numberDesc:entry[0]])
+            return [entry[1] integerValue];
+    }
+
+    if ([util isNumberMatchingDesc:nationalNumber numberDesc:metadata.fixedLine]) {
+        if (metadata.sameMobileAndFixedLinePattern || [util isNumberMatchingDesc:nationalNumber numberDesc:metadata.mobile])
+            return NBEPhoneNumberTypeFIXED_LINE_OR_MOBILE;
+        return NBEPhoneNumberTypeFIXED_LINE;
+    }
+    if (!metadata.sameMobileAndFixedLinePattern && [util isNumberMatchingDesc:nationalNumber numberDesc:metadata.mobile])
+        return NBEPhoneNumberTypeMOBILE;
+    return NBEPhoneNumberTypeUNKNOWN;
+}
+
+// each region's example numbers, plus numbers that share their first digits
+// but differ in the rest and in length, so most descs see hits and misses
+static NSArray *NBNationalNumberCorpus(NSArray *regionCodes, NSUInteger variants)
+{
+    NSMutableArray *pairs = [NSMutableArray array];
+    srandom(3);
+    for (NSString *regionCode in regionCodes) {
+        NBPhoneMetaData *metadata = [NBMetadataHelper getMetadataForRegion:regionCode];
+        if (!metadata)
+            continue;
+
+        for (NBPhoneNumberDesc *desc in @[metadata.fixedLine ?: [NSNull null], metadata.mobile ?: [NSNull null],
+                                          metadata.tollFree ?: [NSNull null], metadata.premiumRate ?: [NSNull null],
+                                          metadata.sharedCost ?: [NSNull null], metadata.voip ?: [NSNull null],
+                                          metadata.personalNumber ?: [NSNull null], metadata.pager ?: [NSNull null],
+                                          metadata.uan ?: [NSNull null], metadata.voicemail ?: [NSNull null]]) {
+            NSString *example = [desc isKindOfClass:[NBPhoneNumberDesc class]] ? desc.exampleNumber : nil;
+            if (example.length < 2)
+                continue;
+            [pairs addObject:@[example, metadata]];
+            for (NSUInteger i = 0; i < variants; i++) {
+                NSMutableString *variant = [[example substringToIndex:1 + random() % 2] mutableCopy];
+                NSInteger length = (NSInteger)example.length + (NSInteger)(random() % 5) - 2;
+                while ((NSInteger)variant.length < length) {
+                    [variant appendFormat:@"%ld", random() % 10];
+                }
+                [pairs addObject:@[variant, metadata]];
+            }
+        }
+    }
+    return pairs;
+}
+
+SPEC_BEGIN(NBNumberTypeMatcherSpec)
+
+describe(@"NBNumberTypeMatcher", ^{
+
+    __block NBPhoneNumberUtil *util = nil;
+    beforeAll(^{
+        util = [[NBPhoneNumberUtil alloc] init];
+    });
+
+    it(@"classifies numbers exactly as the desc regexes do, in every region", ^{
+        NSArray *pairs = NBNationalNumberCorpus([NSLocale ISOCountryCodes], 20);
+        [[theValue(pairs.count) should] beGreaterThan:theValue(10000)];
+
+        NSUInteger mismatches = 0;
+        for (NSArray *pair in pairs) {
+            @autoreleasepool {
+                NBEPhoneNumberType expected = NBRegexNumberType(util, pair[0], pair[1]);
+                NBEPhoneNumberType actual   = [util getNumberTypeHelper:pair[0] metadata:pair[1]];
+                if (actual != expected) {
+                    if (mismatches++ < 20)
+                        NSLog(@"%@ in %@ -> %ld, expected %ld", pair[0], [pair[1] codeID], (long)actual, (long)expected);
+                }
+            }
+        }
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    it(@"falls back to the regexes for numbers that aren't all ASCII digits", ^{
+        NBPhoneMetaData *metadata = [NBMetadataHelper getMetadataForRegion:@"US"];
+        for (NSString *number in @[@"\uFF14\uFF11\uFF15\uFF15\uFF15\uFF15\uFF10\uFF11\uFF12\uFF13", @"41555501x3", @""]) {
+            [[theValue([util getNumberTypeHelper:number metadata:metadata]) should] equal:theValue(NBRegexNumberType(util, number, metadata))];
+        }
+    });
+
+    it(@"classifies the example numbers of each type as that type", ^{
+        NBPhoneNumber *mobile = [util getExampleNumberForType:@"GB" type:NBEPhoneNumberTypeMOBILE error:NULL];
+        NBPhoneNumber *tollFree = [util getExampleNumberForType:@"GB" type:NBEPhoneNumberTypeTOLL_FREE error:NULL];
+        [[theValue([util getNumberType:mobile]) should] equal:theValue(NBEPhoneNumberTypeMOBILE)];
+        [[theValue([util getNumberType:tollFree]) should] equal:theValue(NBEPhoneNumberTypeTOLL_FREE)];
+    });
+
+    it(@"classifies from several threads at once", ^{
+        NSArray *pairs = NBNationalNumberCorpus(@[@"DE", @"FR", @"BR"], 50);
+        __block NSUInteger mismatches = 0;
+        NSLock *lock = [NSLock new];
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+            NSUInteger local = 0;
+            for (NSArray *pair in pairs) {
+                @autoreleasepool {
+                    if ([util getNumberTypeHelper:pair[0] metadata:pair[1]] != NBRegexNumberType(util, pair[0], pair[1]))
+                        local++;
+                }
+            }
+            [lock lock];
+            mismatches += local;
+            [lock unlock];
+        });
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        NSArray *regions = @[@"US", @"GB", @"DE", @"FR", @"IT", @"ES", @"BR", @"MX", @"IN", @"CN", @"JP", @"KR", @"AU", @"RU", @"ZA",
+                             @"NG", @"EG", @"AR", @"SE", @"NL"];
+
+        it(@"times classifying a multi-region corpus against the desc regexes", ^{
+            NSArray *pairs = NBNationalNumberCorpus(regions, 50);
+            [util prewarmRegularExpressionsForRegions:regions];
+
+            NSUInteger repeats = MAX(1, 100000 / MAX(pairs.count, 1));
+            NSTimeInterval regex = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        @autoreleasepool {
+                            NBRegexNumberType(util, pair[0], pair[1]);
+                        }
+                    }
+                }
+            });
+            NSTimeInterval automaton = PKTBenchmark(3, ^{
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NSArray *pair in pairs) {
+                        [util getNumberTypeHelper:pair[0] metadata:pair[1]];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"regex number type, 20 regions", repeats * pairs.count, regex);
+            PKTLogBenchmark(@"automaton number type, 20 regions", repeats * pairs.count, automaton);
+        });
+
+        it(@"measures getNumberType: and isValidNumber: on parsed numbers", ^{
+            NSMutableArray *numbers = [NSMutableArray array];
+            for (NSString *regionCode in regions) {
+                for (NBEPhoneNumberType type = NBEPhoneNumberTypeFIXED_LINE; type <= NBEPhoneNumberTypeVOICEMAIL; type++) {
+                    NBPhoneNumber *number = [util getExampleNumberForType:regionCode type:type error:NULL];
+                    if (number)
+                        [numbers addObject:number];
+                }
+            }
+
+            NSUInteger repeats = MAX(1, 50000 / MAX(numbers.count, 1));
+            __block NSUInteger valid = 0;
+            NSTimeInterval seconds = PKTBenchmark(3, ^{
+                valid = 0;
+                for (NSUInteger r = 0; r < repeats; r++) {
+                    for (NBPhoneNumber *number in numbers) {
+                        @autoreleasepool {
+                            [util getNumberType:number];
+                            valid += [util isValidNumber:number];
+                        }
+                    }
+                }
+            });
+            PKTLogBenchmark(@"getNumberType: + isValidNumber:, 20 regions", 2 * repeats * numbers.count, seconds);
+            [[theValue(valid) should] beGreaterThan:theValue(0)];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,197 @@
+//
+//  NBRegularExpressionCacheSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NBPhoneNumberUtil.h"
+#import "NBMetadataHelper.h"
+#import "NBPhoneMetaData.h"
+#import "NBPhoneNumberDesc.h"
+
+@interface NBPhoneNumberUtil (NBRegularExpressionCacheSpec)
+
+- (NSRegularExpression *)regularExpressionWithPattern:(NSString *)pattern options:(NSRegularExpressionOptions)options error:(NSError **)error;
+- (NSRegularExpression *)entireRegularExpressionWithPattern:(NSString *)regexPattern options:(NSRegularExpressionOptions)options error:(NSError **)error;
+
+@end
+
+// the cache NBRegularExpressionCache replaced: one lock around every lookup
+@interface NBLockedRegexCache : NSObject
+
+- (NSRegularExpression *)regularExpressionWithPattern:(NSString *)pattern;
+
+@end
+
+@implementation NBLockedRegexCache
+{
+    NSMutableDictionary *_cache;
+    NSLock              *_lock;
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _cache = [NSMutableDictionary dictionary];
+        _lock  = [NSLock new];
+    }
+    return self;
+}
+
+- (NSRegularExpression *)regularExpressionWithPattern:(NSString *)pattern
+{
+    [_lock lock];
+    NSRegularExpression *regex = _cache[pattern];
+    if (!regex) {
+        regex = [NSRegularExpression regularExpressionWithPattern:pattern options:0 error:NULL];
+        if (regex)
+            _cache[pattern] = regex;
+    }
+    [_lock unlock];
+    return regex;
+}
+
+@end
+
+static NSArray *NBDescPatterns(NSArray *regionCodes)
+{
+    NSMutableOrderedSet *patterns = [NSMutableOrderedSet orderedSet];
+    for (NSString *regionCode in regionCodes) {
+        NBPhoneMetaData *metadata = [NBMetadataHelper getMetadataForRegion:regionCode];
+        for (NBPhoneNumberDesc *desc in @[metadata.generalDesc ?: [NSNull null], metadata.fixedLine ?: [NSNull null],
+                                          metadata.mobile ?: [NSNull null], metadata.tollFree ?: [NSNull null],
+                                          metadata.premiumRate ?: [NSNull null]]) {
+            if (![desc isKindOfClass:[NBPhoneNumberDesc class]])
+                continue;
+            if ([NBMetadataHelper hasValue:desc.nationalNumberPattern] && ![desc.nationalNumberPattern isEqualToString:@"NA"])
+                [patterns addObject:desc.nationalNumberPattern];
+        }
+    }
+    return [patterns array];
+}
+
+// seconds for threads workers to make lookups lookups each, all at once
+static NSTimeInterval NBTimeLookups(NSUInteger threads, NSUInteger lookups, NSArray *patterns, id (^lookup)(NSString *))
+{
+    return PKTBenchmark(3, ^{
+        dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+            @autoreleasepool {
+                for (NSUInteger i = 0; i < lookups; i++) {
+                    lookup(patterns[(i + worker * 7) % patterns.count]);
+                }
+            }
+        });
+    });
+}
+
+SPEC_BEGIN(NBRegularExpressionCacheSpec)
+
+describe(@"NBRegularExpressionCache", ^{
+
+    __block NBPhoneNumberUtil *util = nil;
+    beforeEach(^{
+        util = [[NBPhoneNumberUtil alloc] init];
+    });
+
+    it(@"returns the compiled expression it cached", ^{
+        NSRegularExpression *first = [util regularExpressionWithPattern:@"[2-9]\\d{2}" options:0 error:NULL];
+        [[first should] beNonNil];
+        [[[util regularExpressionWithPattern:@"[2-9]\\d{2}" options:0 error:NULL] should] beIdenticalTo:first];
+    });
+
+    it(@"anchors entire-string expressions separately from plain ones", ^{
+        NSRegularExpression *plain  = [util regularExpressionWithPattern:@"\\d{3}" options:0 error:NULL];
+        NSRegularExpression *entire = [util entireRegularExpressionWithPattern:@"\\d{3}" options:0 error:NULL];
+        [[entire.pattern should] equal:@"^(?:\\d{3})$"];
+        [[entire shouldNot] beIdenticalTo:plain];
+        [[[util entireRegularExpressionWithPattern:@"\\d{3}" options:0 error:NULL] should] beIdenticalTo:entire];
+    });
+
+    it(@"reports a pattern that doesn't compile and keeps working", ^{
+        NSError *error = nil;
+        [[[util regularExpressionWithPattern:@"(\\d" options:0 error:&error] should] beNil];
+        [[error should] beNonNil];
+        [[[util regularExpressionWithPattern:@"(\\d" options:0 error:NULL] should] beNil];
+        [[[util regularExpressionWithPattern:@"\\d+" options:0 error:NULL] should] beNonNil];
+    });
+
+    it(@"hands every thread the same expression for a pattern", ^{
+        NSArray *patterns = NBDescPatterns(@[@"DE", @"FR", @"IT", @"ES"]);
+        NSMutableArray *seen = [NSMutableArray array];
+        NSLock *lock = [NSLock new];
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+            NSMutableArray *mine = [NSMutableArray arrayWithCapacity:patterns.count];
+            for (NSString *pattern in patterns) {
+                [mine addObject:[util entireRegularExpressionWithPattern:pattern options:0 error:NULL] ?: [NSNull null]];
+            }
+            [lock lock];
+            [seen addObject:mine];
+            [lock unlock];
+        });
+
+        NSUInteger differing = 0;
+        for (NSArray *mine in seen) {
+            for (NSUInteger i = 0; i < patterns.count; i++) {
+                if (mine[i] != seen[0][i])
+                    differing++;
+            }
+        }
+        [[theValue(differing) should] equal:theValue(0)];
+        [[theValue([seen[0] containsObject:[NSNull null]]) should] beNo];
+    });
+
+    it(@"prewarms only the regions it is given, and skips unknown ones", ^{
+        [util prewarmRegularExpressionsForRegions:nil];
+        [util prewarmRegularExpressionsForRegions:@[]];
+        [util prewarmRegularExpressionsForRegions:@[@"US", @"ZZ"]];
+        [[[util regularExpressionWithPattern:@"\\d" options:0 error:NULL] should] beNonNil];
+    });
+
+    it(@"keeps expressions cached before and during a prewarm", ^{
+        NSArray *patterns = NBDescPatterns(@[@"GB"]);
+        NSRegularExpression *before = [util entireRegularExpressionWithPattern:patterns[0] options:0 error:NULL];
+        [util prewarmRegularExpressionsForRegions:@[@"GB", @"DE"]];
+        [[[util entireRegularExpressionWithPattern:patterns[0] options:0 error:NULL] should] beIdenticalTo:before];
+
+        NSMutableArray *after = [NSMutableArray array];
+        for (NSString *pattern in patterns) {
+            [after addObject:[util entireRegularExpressionWithPattern:pattern options:0 error:NULL]];
+        }
+        for (NSUInteger i = 0; i < patterns.count; i++) {
+            [[[util entireRegularExpressionWithPattern:patterns[i] options:0 error:NULL] should] beIdenticalTo:after[i]];
+        }
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        it(@"times hits across threads against a locked dictionary", ^{
+            NSArray *regions = @[@"US", @"GB", @"DE", @"FR", @"IT", @"ES", @"BR", @"MX", @"IN", @"CN", @"JP", @"KR", @"AU", @"RU",
+                                 @"ZA", @"NG", @"EG", @"AR", @"SE", @"NL"];
+            NSArray *patterns = NBDescPatterns(regions);
+            [util prewarmRegularExpressionsForRegions:regions];
+
+            NBLockedRegexCache *locked = [NBLockedRegexCache new];
+            for (NSString *pattern in patterns) {
+                [locked regularExpressionWithPattern:pattern];
+            }
+
+            NSUInteger lookups = 200000;
+            NSUInteger threads = MAX(4, [NSProcessInfo processInfo].activeProcessorCount);
+            id (^lockedLookup)(NSString *) = ^id(NSString *pattern) { return [locked regularExpressionWithPattern:pattern]; };
+            id (^cachedLookup)(NSString *) = ^id(NSString *pattern) { return [util regularExpressionWithPattern:pattern options:0 error:NULL]; };
+
+            NSTimeInterval lockedOne  = NBTimeLookups(1, lookups, patterns, lockedLookup);
+            NSTimeInterval lockedAll  = NBTimeLookups(threads, lookups, patterns, lockedLookup);
+            NSTimeInterval cachedOne  = NBTimeLookups(1, lookups, patterns, cachedLookup);
+            NSTimeInterval cachedAll  = NBTimeLookups(threads, lookups, patterns, cachedLookup);
+
+            PKTLogBenchmark(@"locked regex cache, 1 thread", lookups, lockedOne);
+            PKTLogBenchmark([NSString stringWithFormat:@"locked regex cache, %lu threads", (unsigned long)threads], threads * lookups, lockedAll);
+            PKTLogBenchmark(@"NBRegularExpressionCache, 1 thread", lookups, cachedOne);
+            PKTLogBenchmark([NSString stringWithFormat:@"NBRegularExpressionCache, %lu threads", (unsigned long)threads], threads * lookups, cachedAll);
+        });
+    });
+});
+
+SPEC_END
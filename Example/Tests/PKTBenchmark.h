@@ -0,0 +1,56 @@
+//
+//  PKTBenchmark.h
+//  Tests
+//
+//  Timing and memory helpers for the benchmark specs. Benchmarks log what
+//  they measured, so a run's numbers can be compared across devices, and
+//  assert nothing about timing. They're slow, so they run only with
+//  PKT_BENCHMARKS set in the environment, as the Benchmarks scheme does:
+//
+//      xcodebuild test -workspace PhoneKitDemo.xcworkspace -scheme Benchmarks ...
+//
+//  Time every side of a comparison with the same number of runs.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+
+static inline BOOL PKTBenchmarksEnabled(void)
+{
+    return [[[NSProcessInfo processInfo] environment][@"PKT_BENCHMARKS"] boolValue];
+}
+
+// seconds for one run of block; the best of runs, so one-off stalls don't count
+static inline NSTimeInterval PKTBenchmark(NSUInteger runs, void (^block)(void))
+{
+    static mach_timebase_info_data_t timebase;
+    if (!timebase.denom)
+        mach_timebase_info(&timebase);
+
+    uint64_t best = UINT64_MAX;
+    for (NSUInteger i = 0; i < MAX(runs, 1); i++) {
+        @autoreleasepool {
+            uint64_t start = mach_absolute_time();
+            block();
+            best = MIN(best, mach_absolute_time() - start);
+        }
+    }
+    return (double)best * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+// resident memory of the test process, in bytes
+static inline uint64_t PKTResidentMemory(void)
+{
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+    return info.resident_size;
+}
+
+static inline void PKTLogBenchmark(NSString *name, NSUInteger operations, NSTimeInterval seconds)
+{
+    NSLog(@"[benchmark] %@: %lu in %.3fs, %.0f/s", name, (unsigned long)operations, seconds,
+          seconds > 0 ? operations / seconds : 0);
+}
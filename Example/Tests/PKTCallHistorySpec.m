@@ -0,0 +1,184 @@
+//
+//  PKTCallHistorySpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTCallHistory.h"
+
+static PKTCallRecord *PKTHistoryRecord(NSString *number, NSTimeInterval startTime)
+{
+    PKTCallRecord *record = [PKTCallRecord new];
+    record.number    = number;
+    record.startTime = [NSDate dateWithTimeIntervalSince1970:startTime];
+    record.duration  = 30;
+    record.city      = @"San Francisco";
+    record.state     = @"CA";
+    return record;
+}
+
+static void PKTHistoryAppendBytes(NSString *path, NSData *data)
+{
+    NSFileHandle *handle = [NSFileHandle fileHandleForWritingAtPath:path];
+    [handle seekToEndOfFile];
+    [handle writeData:data];
+    [handle closeFile];
+}
+
+static unsigned long long PKTHistoryFileSize(NSString *path)
+{
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL] fileSize];
+}
+
+SPEC_BEGIN(PKTCallHistorySpec)
+
+describe(@"PKTCallHistory", ^{
+
+    __block NSString *path = nil;
+    __block PKTCallHistory *history = nil;
+    beforeEach(^{
+        path    = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+        history = [[PKTCallHistory alloc] initWithPath:path error:NULL];
+    });
+    afterEach(^{
+        history = nil;
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    });
+
+    it(@"appends records and reads them back newest first", ^{
+        [[theValue(history.count) should] equal:theValue(0)];
+        for (NSUInteger i = 0; i < 5; i++) {
+            [[theValue([history appendRecord:PKTHistoryRecord(@"+1 (415) 555-0101", 1000 + i) error:NULL]) should] beYes];
+        }
+        [[theValue([history appendRecord:PKTHistoryRecord(@"+1 (212) 555-0102", 2000) error:NULL]) should] beYes];
+
+        [[theValue(history.count) should] equal:theValue(6)];
+        PKTCallRecord *oldest = [history recordAtIndex:0];
+        [[oldest.number should] equal:@"+1 (415) 555-0101"];
+        [[oldest.city should] equal:@"San Francisco"];
+        [[oldest.state should] equal:@"CA"];
+        [[theValue(oldest.duration) should] equal:theValue(30)];
+        [[theValue([oldest.startTime timeIntervalSince1970]) should] equal:theValue(1000)];
+        [[history recordAtIndex:6] shouldBeNil];
+
+        NSArray *recent = [history recentRecordsFromOffset:1 limit:2];
+        [[[recent valueForKeyPath:@"startTime.timeIntervalSince1970"] should] equal:@[@1004, @1003]];
+
+        [[theValue([history countOfRecordsForNumber:@"14155550101"]) should] equal:theValue(5)];
+        [[[[history recentRecordsForNumber:@"+14155550101" limit:2] valueForKeyPath:@"startTime.timeIntervalSince1970"] should] equal:@[@1004, @1003]];
+        [[theValue([history countOfRecordsForNumber:@"12125550199"]) should] equal:theValue(0)];
+    });
+
+    it(@"keeps reading appends made after a lookup", ^{
+        [history appendRecord:PKTHistoryRecord(@"14155550101", 1000) error:NULL];
+        [[theValue([history countOfRecordsForNumber:@"14155550101"]) should] equal:theValue(1)];
+
+        // enough strings and entries to outgrow the first mapping of each file
+        for (NSUInteger i = 0; i < 5000; i++) {
+            [history appendRecord:PKTHistoryRecord([NSString stringWithFormat:@"1212555%04lu", (unsigned long)i], 2000 + i) error:NULL];
+        }
+        [history appendRecord:PKTHistoryRecord(@"14155550101", 9000) error:NULL];
+
+        [[theValue(history.count) should] equal:theValue(5002)];
+        [[[[history recordAtIndex:4000] number] should] equal:@"12125553999"];
+        [[theValue([history countOfRecordsForNumber:@"14155550101"]) should] equal:theValue(2)];
+        [[[[history recentRecordsFromOffset:0 limit:1][0] number] should] equal:@"14155550101"];
+    });
+
+    it(@"reopens with everything appended", ^{
+        for (NSUInteger i = 0; i < 100; i++) {
+            [history appendRecord:PKTHistoryRecord([NSString stringWithFormat:@"1415555%04lu", (unsigned long)(i % 10)], i) error:NULL];
+        }
+        history = nil;
+
+        history = [[PKTCallHistory alloc] initWithPath:path error:NULL];
+        [[theValue(history.count) should] equal:theValue(100)];
+        [[[[history recordAtIndex:99] number] should] equal:@"14155550009"];
+        [[theValue([history countOfRecordsForNumber:@"14155550003"]) should] equal:theValue(10)];
+
+        // strings already in the table are reused, not appended again
+        unsigned long long strings = PKTHistoryFileSize([path stringByAppendingPathComponent:@"strings.bin"]);
+        [history appendRecord:PKTHistoryRecord(@"14155550003", 100) error:NULL];
+        [[theValue(PKTHistoryFileSize([path stringByAppendingPathComponent:@"strings.bin"])) should] equal:theValue(strings)];
+        [[theValue([history countOfRecordsForNumber:@"14155550003"]) should] equal:theValue(11)];
+    });
+
+    it(@"drops records and strings torn by a crash mid-append", ^{
+        [history appendRecord:PKTHistoryRecord(@"14155550101", 1000) error:NULL];
+        [history appendRecord:PKTHistoryRecord(@"14155550102", 1001) error:NULL];
+        history = nil;
+
+        NSString *records = [path stringByAppendingPathComponent:@"records.bin"];
+        NSString *strings = [path stringByAppendingPathComponent:@"strings.bin"];
+        unsigned long long recordsSize = PKTHistoryFileSize(records);
+        unsigned long long stringsSize = PKTHistoryFileSize(strings);
+        uint32_t length = 40;
+        NSMutableData *tornString = [NSMutableData dataWithBytes:&length length:sizeof(length)];
+        [tornString appendData:[@"1415" dataUsingEncoding:NSUTF8StringEncoding]];
+        PKTHistoryAppendBytes(records, [NSMutableData dataWithLength:17]);
+        PKTHistoryAppendBytes(strings, tornString);
+
+        history = [[PKTCallHistory alloc] initWithPath:path error:NULL];
+        [history shouldNotBeNil];
+        [[theValue(history.count) should] equal:theValue(2)];
+        [[theValue(PKTHistoryFileSize(records)) should] equal:theValue(recordsSize)];
+        [[theValue(PKTHistoryFileSize(strings)) should] equal:theValue(stringsSize)];
+        [[[[history recordAtIndex:1] number] should] equal:@"14155550102"];
+
+        [[theValue([history appendRecord:PKTHistoryRecord(@"14155550103", 1002) error:NULL]) should] beYes];
+        [[[[history recordAtIndex:2] number] should] equal:@"14155550103"];
+    });
+
+    it(@"refuses a file that isn't a history", ^{
+        history = nil;
+        NSString *records = [path stringByAppendingPathComponent:@"records.bin"];
+        [[@"not a call history" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:records atomically:YES];
+
+        NSError *error = nil;
+        [[[[PKTCallHistory alloc] initWithPath:path error:&error] should] beNil];
+        [[error.domain should] equal:PKTCallHistoryErrorDomain];
+        [[theValue(error.code) should] equal:theValue(PKTCallHistoryErrorCorrupt)];
+    });
+
+    it(@"removes all records", ^{
+        [history appendRecord:PKTHistoryRecord(@"14155550101", 1000) error:NULL];
+        [[theValue([history countOfRecordsForNumber:@"14155550101"]) should] equal:theValue(1)];
+        [[theValue([history removeAllRecords:NULL]) should] beYes];
+
+        [[theValue(history.count) should] equal:theValue(0)];
+        [[theValue([history countOfRecordsForNumber:@"14155550101"]) should] equal:theValue(0)];
+        [history appendRecord:PKTHistoryRecord(@"14155550102", 1001) error:NULL];
+        [[[[history recordAtIndex:0] number] should] equal:@"14155550102"];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        it(@"times appending 100k calls and reopening the history", ^{
+            NSUInteger calls = 100000;
+            srandom(42);
+            NSTimeInterval append = PKTBenchmark(1, ^{
+                for (NSUInteger i = 0; i < calls; i++) {
+                    @autoreleasepool {
+                        NSString *number = [NSString stringWithFormat:@"1%03ld555%04ld", 200 + random() % 800, random() % 10000];
+                        [history appendRecord:PKTHistoryRecord(number, i) error:NULL];
+                    }
+                }
+            });
+            history = nil;
+
+            __block PKTCallHistory *reopened = nil;
+            NSTimeInterval open = PKTBenchmark(3, ^{
+                reopened = [[PKTCallHistory alloc] initWithPath:path error:NULL];
+            });
+            NSTimeInterval page = PKTBenchmark(3, ^{
+                [reopened recentRecordsFromOffset:0 limit:50];
+            });
+
+            PKTLogBenchmark(@"call history append", calls, append);
+            NSLog(@"[benchmark] call history, 100k calls: open %.3f ms, first page of 50 %.3f ms", open * 1000, page * 1000);
+            [[theValue(reopened.count) should] equal:theValue(calls)];
+        });
+    });
+});
+
+SPEC_END
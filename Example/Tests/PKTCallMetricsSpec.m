@@ -0,0 +1,246 @@
+//
+//  PKTCallMetricsSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTPhone.h"
+#import "PKTCallMetrics.h"
+#import "PKTLatencyHistogram.h"
+#import "PKTFakeDevice.h"
+
+// spins the main run loop, where the fake device and the phone deliver
+static BOOL PKTMetricsRunUntil(BOOL (^condition)(void))
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!condition()) {
+        if ([timeout timeIntervalSinceNow] < 0)
+            return NO;
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+    return YES;
+}
+
+// an outgoing call the far end picks up and this end hangs up
+static BOOL PKTMetricsPlaceCall(PKTPhone *phone, PKTFakeDevice *device, NSUInteger i)
+{
+    [phone call:[NSString stringWithFormat:@"+1212555%04lu", (unsigned long)(i % 10000)]];
+    if (!PKTMetricsRunUntil(^{ return (BOOL)(phone.activeConnection.state == TCConnectionStateConnected); }))
+        return NO;
+    [phone hangup];
+    if (!PKTMetricsRunUntil(^{ return (BOOL)(phone.callCount == 0); }))
+        return NO;
+    [device removeFinishedConnections];
+    return YES;
+}
+
+SPEC_BEGIN(PKTCallMetricsSpec)
+
+describe(@"PKTCallTimeline", ^{
+
+    it(@"keeps the first time of each event, in order", ^{
+        PKTCallTimeline *timeline = [PKTCallTimeline new];
+        [timeline recordEvent:PKTCallEventConnectIssued atTime:10];
+        [timeline recordEvent:PKTCallEventConnected atTime:10.25];
+        [timeline recordEvent:PKTCallEventConnected atTime:11];
+        [timeline recordEvent:nil atTime:12];
+
+        [[timeline.eventNames should] equal:@[PKTCallEventConnectIssued, PKTCallEventConnected]];
+        [[theValue([timeline timeOfEvent:PKTCallEventConnected]) should] equal:theValue(10.25)];
+        [[theValue([timeline intervalFromEvent:PKTCallEventConnectIssued toEvent:PKTCallEventConnected]) should] equal:theValue(0.25)];
+    });
+
+    it(@"has no interval or time for events that didn't happen", ^{
+        PKTCallTimeline *timeline = [PKTCallTimeline new];
+        [timeline recordEvent:PKTCallEventRinging atTime:1];
+        [[theValue([timeline timeOfEvent:PKTCallEventResponded]) should] equal:theValue(0)];
+        [[theValue([timeline intervalFromEvent:PKTCallEventRinging toEvent:PKTCallEventResponded]) should] beLessThan:theValue(0)];
+    });
+});
+
+describe(@"PKTLatencyHistogram", ^{
+
+    it(@"reports percentiles to within a bucket's width", ^{
+        PKTLatencyHistogram *histogram = [PKTLatencyHistogram new];
+        for (NSUInteger ms = 1; ms <= 10000; ms++) {
+            [histogram recordValue:ms / 1000.0];
+        }
+
+        for (NSNumber *percentile in @[@1, @50, @90, @95, @99, @99.9]) {
+            double expected = [percentile doubleValue] / 100 * 10;
+            double actual   = [histogram valueAtPercentile:[percentile doubleValue]];
+            [[theValue(fabs(actual - expected) / expected) should] beLessThan:theValue(0.0625)];
+        }
+        [[theValue(histogram.count) should] equal:theValue(10000)];
+        [[theValue(histogram.minimum) should] equal:theValue(0.001)];
+        [[theValue(histogram.maximum) should] equal:theValue(10.0)];
+        [[theValue(histogram.mean) should] equal:5.0005 withDelta:1e-9];
+        [[theValue([histogram valueAtPercentile:100]) should] equal:theValue(10.0)];
+    });
+
+    it(@"keeps sub-16µs values exact and ignores negative and NaN ones", ^{
+        PKTLatencyHistogram *histogram = [PKTLatencyHistogram new];
+        [histogram recordValue:-1];
+        [histogram recordValue:NAN];
+        [[theValue([histogram valueAtPercentile:50]) should] equal:theValue(0)];
+
+        [histogram recordValue:5e-6];
+        [[theValue(histogram.count) should] equal:theValue(1)];
+        [[theValue([histogram valueAtPercentile:50]) should] equal:theValue(5e-6)];
+
+        [histogram reset];
+        [[theValue(histogram.count) should] equal:theValue(0)];
+    });
+
+    it(@"records from several threads at once", ^{
+        PKTLatencyHistogram *histogram = [PKTLatencyHistogram new];
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+            for (NSUInteger i = 0; i < 10000; i++) {
+                [histogram recordValue:(i % 100) / 1000.0];
+            }
+        });
+        [[theValue(histogram.count) should] equal:theValue(80000)];
+    });
+});
+
+describe(@"PKTCallMetrics", ^{
+
+    it(@"records nothing while disabled", ^{
+        PKTCallMetrics *metrics = [PKTCallMetrics new];
+        [metrics recordLatency:0.2 forSpan:PKTCallSpanDelegateHop];
+        PKTCallTimeline *timeline = [PKTCallTimeline new];
+        [timeline recordEvent:PKTCallEventConnectIssued atTime:1];
+        [timeline recordEvent:PKTCallEventConnected atTime:2];
+        [metrics finishTimeline:timeline];
+
+        [[theValue([metrics histogramForSpan:PKTCallSpanDelegateHop].count) should] equal:theValue(0)];
+        [[theValue([metrics histogramForSpan:PKTCallSpanOutgoingSetup].count) should] equal:theValue(0)];
+        [[metrics.recentTimelines should] beEmpty];
+    });
+
+    it(@"folds a finished call's spans into the histograms", ^{
+        PKTCallMetrics *metrics = [PKTCallMetrics new];
+        metrics.enabled = YES;
+
+        PKTCallTimeline *timeline = [PKTCallTimeline new];
+        [timeline recordEvent:PKTCallEventRinging atTime:1];
+        [timeline recordEvent:PKTCallEventResponded atTime:3];
+        [timeline recordEvent:PKTCallEventConnected atTime:3.5];
+        [metrics finishTimeline:timeline];
+
+        [[theValue([metrics latencyForSpan:PKTCallSpanAnswer percentile:50]) should] equal:theValue(2.0)];
+        [[theValue([metrics latencyForSpan:PKTCallSpanIncomingSetup percentile:50]) should] equal:theValue(0.5)];
+        [[theValue([metrics histogramForSpan:PKTCallSpanOutgoingSetup].count) should] equal:theValue(0)];
+        [[metrics.recentTimelines should] equal:@[timeline]];
+    });
+
+    it(@"keeps only the most recent timelines", ^{
+        PKTCallMetrics *metrics = [PKTCallMetrics new];
+        metrics.enabled = YES;
+        metrics.recentTimelineLimit = 3;
+
+        NSMutableArray *timelines = [NSMutableArray array];
+        for (NSUInteger i = 0; i < 5; i++) {
+            PKTCallTimeline *timeline = [PKTCallTimeline new];
+            [timelines addObject:timeline];
+            [metrics finishTimeline:timeline];
+        }
+        [[metrics.recentTimelines should] equal:[timelines subarrayWithRange:NSMakeRange(2, 3)]];
+
+        [metrics reset];
+        [[metrics.recentTimelines should] beEmpty];
+    });
+
+    context(@"on a phone", ^{
+
+        __block PKTPhone      *phone  = nil;
+        __block PKTFakeDevice *device = nil;
+
+        beforeEach(^{
+            device = [PKTFakeDevice new];
+            phone  = [PKTPhone new];
+            phone.metrics.enabled = YES;
+            phone.phoneDevice     = device;
+            phone.capabilityToken = @"fake";
+        });
+
+        afterEach(^{
+            phone  = nil;
+            device = nil;
+        });
+
+        it(@"times an outgoing call from connect to hangup", ^{
+            [[theValue(PKTMetricsPlaceCall(phone, device, 0)) should] beYes];
+
+            PKTCallTimeline *timeline = [phone.metrics.recentTimelines lastObject];
+            [[timeline shouldNot] beNil];
+            [[[timeline.eventNames firstObject] should] equal:PKTCallEventConnectIssued];
+            [[[timeline.eventNames lastObject] should] equal:PKTCallEventDisconnected];
+            [[theValue([timeline intervalFromEvent:PKTCallEventConnectIssued toEvent:PKTCallEventConnected]) should] beGreaterThanOrEqualTo:theValue(0)];
+            [[theValue([phone.metrics histogramForSpan:PKTCallSpanOutgoingSetup].count) should] equal:theValue(1)];
+        });
+
+        it(@"keeps no timelines once disabled", ^{
+            phone.metrics.enabled = NO;
+            [[theValue(PKTMetricsPlaceCall(phone, device, 0)) should] beYes];
+            [[phone.metrics.recentTimelines should] beEmpty];
+            [[theValue([phone.metrics histogramForSpan:PKTCallSpanOutgoingSetup].count) should] equal:theValue(0)];
+        });
+
+        if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+            it(@"times calls with metrics disabled and enabled", ^{
+                NSUInteger calls = 1000;
+                __block BOOL completed = YES;
+
+                // warm up the phone, device and allocator before timing either mode
+                for (NSUInteger i = 0; i < 50 && completed; i++) {
+                    completed = PKTMetricsPlaceCall(phone, device, i);
+                }
+
+                phone.metrics.enabled = NO;
+                NSTimeInterval disabled = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < calls && completed; i++) {
+                        @autoreleasepool {
+                            completed = PKTMetricsPlaceCall(phone, device, i);
+                        }
+                    }
+                });
+                phone.metrics.enabled = YES;
+                NSTimeInterval enabled = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < calls && completed; i++) {
+                        @autoreleasepool {
+                            completed = PKTMetricsPlaceCall(phone, device, i);
+                        }
+                    }
+                });
+
+                [[theValue(completed) should] beYes];
+                PKTLogBenchmark(@"calls, metrics disabled", calls, disabled);
+                PKTLogBenchmark(@"calls, metrics enabled", calls, enabled);
+            });
+
+            it(@"times a disabled instrumentation point against a recorded one", ^{
+                NSUInteger points = 1000000;
+                PKTCallMetrics *metrics = [PKTCallMetrics new];
+
+                NSTimeInterval disabled = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < points; i++) {
+                        [metrics recordLatency:0.001 forSpan:PKTCallSpanDelegateHop];
+                    }
+                });
+                metrics.enabled = YES;
+                NSTimeInterval enabled = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < points; i++) {
+                        [metrics recordLatency:0.001 forSpan:PKTCallSpanDelegateHop];
+                    }
+                });
+
+                PKTLogBenchmark(@"recordLatency:, disabled", points, disabled);
+                PKTLogBenchmark(@"recordLatency:, enabled", points, enabled);
+            });
+        });
+    });
+});
+
+SPEC_END
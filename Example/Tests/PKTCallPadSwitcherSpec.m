@@ -0,0 +1,148 @@
+//
+//  PKTCallPadSwitcherSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTCallPadSwitcher.h"
+#import "PKTCallViewController.h"
+
+@interface PKTCallViewController (PKTCallPadSwitcherSpec)
+
+- (PKTCallPadSwitcher *)padSwitcher;
+- (void)switchToPad:(PKTCallPad)kind animated:(BOOL)animated;
+
+@end
+
+// a loaded call screen showing each of pads in turn
+static PKTCallViewController *PKTLoadCallScreen(NSArray *pads)
+{
+    PKTCallViewController *controller = [[PKTCallViewController alloc] initWithNibName:nil bundle:nil];
+    [controller view];
+    for (NSNumber *pad in pads) {
+        [controller switchToPad:[pad unsignedIntegerValue] animated:NO];
+    }
+    return controller;
+}
+
+SPEC_BEGIN(PKTCallPadSwitcherSpec)
+
+describe(@"PKTCallPadSwitcher", ^{
+
+    __block PKTCallPadSwitcher *switcher = nil;
+    __block NSMutableArray     *requested = nil;
+
+    beforeEach(^{
+        requested = [NSMutableArray array];
+        switcher  = [PKTCallPadSwitcher new];
+        switcher.padBuilder = ^id(PKTCallPad pad) {
+            [requested addObject:@(pad)];
+            return [NSString stringWithFormat:@"pad %lu", (unsigned long)pad];
+        };
+    });
+
+    it(@"builds nothing until a pad is asked for", ^{
+        [[theValue(switcher.visiblePad) should] equal:theValue(PKTCallPadNone)];
+        [[theValue(switcher.buildCount) should] equal:theValue(0)];
+        [[[switcher padIfBuilt:PKTCallPadKeypad] should] beNil];
+        [[switcher.builtPads should] beEmpty];
+    });
+
+    it(@"builds each pad once, the first time it's shown", ^{
+        id main = [switcher showPad:PKTCallPadMain];
+        [switcher showPad:PKTCallPadKeypad];
+        [[[switcher showPad:PKTCallPadMain] should] beIdenticalTo:main];
+
+        [[requested should] equal:@[@(PKTCallPadMain), @(PKTCallPadKeypad)]];
+        [[theValue(switcher.buildCount) should] equal:theValue(2)];
+        [[theValue(switcher.visiblePad) should] equal:theValue(PKTCallPadMain)];
+        [[switcher.builtPads should] equal:@[main, [switcher padIfBuilt:PKTCallPadKeypad]]];
+    });
+
+    it(@"tells which pad an object is", ^{
+        id incoming = [switcher padForKind:PKTCallPadIncoming];
+        [[theValue([switcher kindOfPad:incoming]) should] equal:theValue(PKTCallPadIncoming)];
+        [[theValue([switcher kindOfPad:@"something else"]) should] equal:theValue(PKTCallPadNone)];
+        [[theValue([switcher kindOfPad:nil]) should] equal:theValue(PKTCallPadNone)];
+        // building it doesn't show it
+        [[theValue(switcher.visiblePad) should] equal:theValue(PKTCallPadNone)];
+    });
+
+    it(@"never builds or shows PKTCallPadNone", ^{
+        [[[switcher showPad:PKTCallPadNone] should] beNil];
+        [[requested should] beEmpty];
+        [[theValue(switcher.visiblePad) should] equal:theValue(PKTCallPadNone)];
+    });
+
+    it(@"keeps the visible pad when a build fails, and tries again next time", ^{
+        [switcher showPad:PKTCallPadMain];
+        switcher.padBuilder = ^id(PKTCallPad pad) {
+            [requested addObject:@(pad)];
+            return nil;
+        };
+        [[[switcher showPad:PKTCallPadKeypad] should] beNil];
+        [[[switcher showPad:PKTCallPadKeypad] should] beNil];
+
+        [[theValue(switcher.visiblePad) should] equal:theValue(PKTCallPadMain)];
+        [[requested should] equal:@[@(PKTCallPadMain), @(PKTCallPadKeypad), @(PKTCallPadKeypad)]];
+        [[theValue(switcher.builtPads.count) should] equal:theValue(1)];
+    });
+
+    context(@"on a call screen", ^{
+
+        it(@"builds only the pads a call shows", ^{
+            PKTCallViewController *controller = PKTLoadCallScreen(@[]);
+            [[theValue(controller.padSwitcher.buildCount) should] equal:theValue(0)];
+
+            [controller switchToPad:PKTCallPadMain animated:NO];
+            [controller switchToPad:PKTCallPadKeypad animated:NO];
+            [controller switchToPad:PKTCallPadMain animated:NO];
+            [[theValue(controller.padSwitcher.buildCount) should] equal:theValue(2)];
+            [[[controller.padSwitcher padIfBuilt:PKTCallPadIncoming] should] beNil];
+        });
+
+        if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+            it(@"times loading an outgoing call's screen against one with every pad", ^{
+                NSUInteger screens = 50;
+                NSArray *outgoing = @[@(PKTCallPadMain)];
+                NSArray *everyPad = @[@(PKTCallPadMain), @(PKTCallPadKeypad), @(PKTCallPadIncoming)];
+
+                // the first screen pays for fonts, icons and nibs
+                PKTLoadCallScreen(everyPad);
+
+                NSTimeInterval lazy = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < screens; i++) {
+                        @autoreleasepool {
+                            PKTLoadCallScreen(outgoing);
+                        }
+                    }
+                });
+                NSTimeInterval eager = PKTBenchmark(3, ^{
+                    for (NSUInteger i = 0; i < screens; i++) {
+                        @autoreleasepool {
+                            PKTLoadCallScreen(everyPad);
+                        }
+                    }
+                });
+
+                uint64_t before = PKTResidentMemory();
+                PKTCallViewController *lazyScreen = PKTLoadCallScreen(outgoing);
+                uint64_t lazyBytes = PKTResidentMemory() - MIN(before, PKTResidentMemory());
+                before = PKTResidentMemory();
+                PKTCallViewController *eagerScreen = PKTLoadCallScreen(everyPad);
+                uint64_t eagerBytes = PKTResidentMemory() - MIN(before, PKTResidentMemory());
+
+                PKTLogBenchmark(@"call screen load, main pad only", screens, lazy);
+                PKTLogBenchmark(@"call screen load, every pad", screens, eager);
+                NSLog(@"[benchmark] call screen resident growth: main pad only %llu KB, every pad %llu KB",
+                      lazyBytes / 1024, eagerBytes / 1024);
+
+                [[theValue(lazyScreen.padSwitcher.buildCount) should] equal:theValue(1)];
+                [[theValue(eagerScreen.padSwitcher.buildCount) should] equal:theValue(3)];
+            });
+        });
+    });
+});
+
+SPEC_END
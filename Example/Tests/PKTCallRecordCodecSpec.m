@@ -0,0 +1,334 @@
+//
+//  PKTCallRecordCodecSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTCallRecordCodec.h"
+
+static PKTCallRecord *PKTMakeRecord(BOOL incoming, BOOL missed, NSTimeInterval duration, NSTimeInterval startTime,
+                                    NSString *number, NSString *city, NSString *state)
+{
+    PKTCallRecord *record = [PKTCallRecord new];
+    record.incoming  = incoming;
+    record.missed    = missed;
+    record.duration  = duration;
+    record.startTime = startTime ? [NSDate dateWithTimeIntervalSince1970:startTime] : nil;
+    record.number    = number;
+    record.city      = city;
+    record.state     = state;
+    return record;
+}
+
+// a call history: a few thousand numbers, fewer places, times a minute or
+// so apart and mostly in order, durations to the millisecond
+static NSArray *PKTCallHistoryCorpus(NSUInteger count)
+{
+    NSArray *cities = @[@"New York", @"Chicago", @"San Francisco", @"Austin", @"Seattle", @"Boston", @"Denver", @"Miami"];
+    NSArray *states = @[@"NY", @"IL", @"CA", @"TX", @"WA", @"MA", @"CO", @"FL"];
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:count];
+    NSTimeInterval startTime = 1400000000;
+    srandom(25);
+    for (NSUInteger i = 0; i < count; i++) {
+        NSUInteger place = random() % cities.count;
+        startTime += (random() % 120000 - 10000) / 1000.0;
+        [records addObject:PKTMakeRecord(random() % 2, random() % 5 == 0, (random() % 600000) / 1000.0, startTime,
+                                         [NSString stringWithFormat:@"+1212555%04ld", random() % 3000],
+                                         i % 7 ? cities[place] : nil, i % 7 ? states[place] : nil)];
+    }
+    return records;
+}
+
+static BOOL PKTSameTime(NSDate *date, NSDate *other)
+{
+    if (!date || !other)
+        return date == other;
+    return fabs([date timeIntervalSince1970] - [other timeIntervalSince1970]) < 1e-6;
+}
+
+static BOOL PKTSameRecord(PKTCallRecord *record, PKTCallRecord *other)
+{
+    return record.incoming == other.incoming && record.missed == other.missed &&
+           fabs(record.duration - other.duration) < 1e-6 && PKTSameTime(record.startTime, other.startTime) &&
+           (record.number == other.number || [record.number isEqualToString:other.number]) &&
+           (record.city == other.city || [record.city isEqualToString:other.city]) &&
+           (record.state == other.state || [record.state isEqualToString:other.state]);
+}
+
+static NSUInteger PKTCountMismatches(NSArray *records, NSArray *decoded)
+{
+    NSUInteger mismatches = records.count > decoded.count ? records.count - decoded.count : decoded.count - records.count;
+    for (NSUInteger i = 0; i < MIN(records.count, decoded.count); i++) {
+        if (!PKTSameRecord(records[i], decoded[i]))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+static NSString *PKTJSONLines(NSArray *records)
+{
+    NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+    PKTCallRecordJSONLinesWriter *writer = [[PKTCallRecordJSONLinesWriter alloc] initWithOutputStream:stream];
+    if (![writer writeRecords:records error:NULL] || ![writer finish:NULL])
+        return nil;
+    NSData *data = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+    [stream close];
+    return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+static NSArray *PKTParseJSONLines(NSString *lines)
+{
+    NSMutableArray *objects = [NSMutableArray array];
+    for (NSString *line in [lines componentsSeparatedByString:@"\n"]) {
+        if (!line.length)
+            continue;
+        id object = [NSJSONSerialization JSONObjectWithData:[line dataUsingEncoding:NSUTF8StringEncoding] options:0 error:NULL];
+        [objects addObject:object ?: [NSNull null]];
+    }
+    return objects;
+}
+
+SPEC_BEGIN(PKTCallRecordCodecSpec)
+
+describe(@"PKTCallRecordEncoder", ^{
+
+    it(@"round-trips every field, to the millisecond", ^{
+        NSArray *records = @[
+            PKTMakeRecord(YES, NO, 62.125, 1400000000.5, @"+12125550100", @"New York", @"NY"),
+            PKTMakeRecord(NO, YES, 0, 1399999000.001, @"+12125550100", @"New York", @"NY"),
+            PKTMakeRecord(NO, NO, 3600.999, 0, @"+442071838750", nil, nil),
+            PKTMakeRecord(YES, YES, 1.5, 1400000100.25, nil, @"Z\u00fcrich", @"+442071838750"),
+        ];
+        NSData *data = [PKTCallRecordEncoder dataWithRecords:records];
+        NSError *error = nil;
+        NSArray *decoded = [PKTCallRecordDecoder recordsWithData:data error:&error];
+
+        [[error should] beNil];
+        [[theValue(PKTCountMismatches(records, decoded)) should] equal:theValue(0)];
+    });
+
+    it(@"writes a string in full only the first time", ^{
+        PKTCallRecord *record = PKTMakeRecord(NO, NO, 0, 0, @"+12125550100", @"New York", @"NY");
+        NSData *once  = [PKTCallRecordEncoder dataWithRecords:@[record]];
+        NSData *twice = [PKTCallRecordEncoder dataWithRecords:@[record, record]];
+        // flags, duration and a reference for each string
+        [[theValue(twice.length - once.length) should] equal:theValue(5)];
+    });
+
+    it(@"writes a negative or NaN duration as zero", ^{
+        NSArray *decoded = [PKTCallRecordDecoder recordsWithData:[PKTCallRecordEncoder dataWithRecords:@[
+            PKTMakeRecord(NO, NO, -3, 0, nil, nil, nil),
+            PKTMakeRecord(NO, NO, NAN, 0, nil, nil, nil),
+        ]] error:NULL];
+        [[theValue([decoded[0] duration]) should] equal:theValue(0)];
+        [[theValue([decoded[1] duration]) should] equal:theValue(0)];
+    });
+
+    it(@"decodes nothing from a header alone", ^{
+        NSError *error = nil;
+        [[[PKTCallRecordDecoder recordsWithData:[PKTCallRecordEncoder dataWithRecords:@[]] error:&error] should] beEmpty];
+        [[error should] beNil];
+    });
+
+    it(@"decodes from a stream across chunks", ^{
+        NSArray *records = PKTCallHistoryCorpus(40000);
+        NSData *data = [PKTCallRecordEncoder dataWithRecords:records];
+        [[theValue(data.length) should] beGreaterThan:theValue(3 * 64 * 1024)];
+
+        PKTCallRecordDecoder *decoder = [[PKTCallRecordDecoder alloc] initWithInputStream:[NSInputStream inputStreamWithData:data]];
+        NSMutableArray *decoded = [NSMutableArray array];
+        NSError *error = nil;
+        PKTCallRecord *record;
+        while ((record = [decoder decodeRecord:&error])) {
+            [decoded addObject:record];
+        }
+        [[error should] beNil];
+        [[theValue(PKTCountMismatches(records, decoded)) should] equal:theValue(0)];
+    });
+
+    it(@"encodes to a stream in pieces as it would all at once", ^{
+        NSArray *records = PKTCallHistoryCorpus(5000);
+        NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+        PKTCallRecordEncoder *encoder = [[PKTCallRecordEncoder alloc] initWithOutputStream:stream];
+        for (PKTCallRecord *record in records) {
+            [[theValue([encoder encodeRecord:record error:NULL]) should] beYes];
+        }
+        [[theValue([encoder finish:NULL]) should] beYes];
+        [[[stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey] should] equal:[PKTCallRecordEncoder dataWithRecords:records]];
+    });
+
+    context(@"with data it can't read", ^{
+
+        __block NSData *data = nil;
+        beforeEach(^{
+            data = [PKTCallRecordEncoder dataWithRecords:PKTCallHistoryCorpus(10)];
+        });
+
+        NSError *(^decodeError)(NSData *) = ^NSError *(NSData *bytes) {
+            NSError *error = nil;
+            NSArray *records = [PKTCallRecordDecoder recordsWithData:bytes error:&error];
+            return records ? nil : error;
+        };
+
+        it(@"reports data without a header as corrupt", ^{
+            NSError *error = decodeError([NSData data]);
+            [[error.domain should] equal:PKTCallRecordCodecErrorDomain];
+            [[theValue(error.code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+
+            NSMutableData *wrongMagic = [data mutableCopy];
+            ((uint8_t *)wrongMagic.mutableBytes)[0] = 'X';
+            [[theValue(decodeError(wrongMagic).code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+        });
+
+        it(@"reports a later version as incompatible", ^{
+            NSMutableData *later = [data mutableCopy];
+            ((uint8_t *)later.mutableBytes)[4] += 1;
+            [[theValue(decodeError(later).code) should] equal:theValue(PKTCallRecordCodecErrorIncompatibleVersion)];
+        });
+
+        it(@"reports a record cut short as corrupt", ^{
+            NSData *cut = [data subdataWithRange:NSMakeRange(0, data.length - 1)];
+            [[theValue(decodeError(cut).code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+        });
+
+        it(@"reports unknown flags and string references as corrupt", ^{
+            NSMutableData *flags = [[data subdataWithRange:NSMakeRange(0, 5)] mutableCopy];
+            [flags appendBytes:(uint8_t[]){0x80, 0, 0, 0, 0} length:5];
+            [[theValue(decodeError(flags).code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+
+            NSMutableData *reference = [[data subdataWithRange:NSMakeRange(0, 5)] mutableCopy];
+            [reference appendBytes:(uint8_t[]){0, 0, 9, 0, 0} length:5];
+            [[theValue(decodeError(reference).code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+        });
+
+        it(@"hands out the records before the damage one at a time", ^{
+            NSArray *records = PKTCallHistoryCorpus(10);
+            PKTCallRecordDecoder *decoder = [[PKTCallRecordDecoder alloc] initWithData:[data subdataWithRange:NSMakeRange(0, data.length - 1)]];
+            NSError *error = nil;
+            for (NSUInteger i = 0; i < records.count - 1; i++) {
+                [[theValue(PKTSameRecord([decoder decodeRecord:&error], records[i])) should] beYes];
+            }
+            [[[decoder decodeRecord:&error] should] beNil];
+            [[theValue(error.code) should] equal:theValue(PKTCallRecordCodecErrorCorrupt)];
+        });
+    });
+});
+
+describe(@"PKTCallRecordJSONLinesWriter", ^{
+
+    it(@"writes one object per record that NSJSONSerialization reads back", ^{
+        NSArray *records = PKTCallHistoryCorpus(200);
+        NSArray *objects = PKTParseJSONLines(PKTJSONLines(records));
+
+        [[theValue(objects.count) should] equal:theValue(records.count)];
+        NSUInteger mismatches = 0;
+        for (NSUInteger i = 0; i < MIN(objects.count, records.count); i++) {
+            PKTCallRecord *record = records[i];
+            NSDictionary *object  = objects[i];
+            if (![object isKindOfClass:[NSDictionary class]] ||
+                [object[@"incoming"] boolValue] != record.incoming || [object[@"missed"] boolValue] != record.missed ||
+                fabs([object[@"duration"] doubleValue] - record.duration) > 5e-4 ||
+                fabs([object[@"startTime"] doubleValue] - [record.startTime timeIntervalSince1970]) > 5e-4 ||
+                ![object[@"number"] isEqual:record.number] ||
+                ![object[@"city"] isEqual:record.city ?: [NSNull null]] ||
+                ![object[@"state"] isEqual:record.state ?: [NSNull null]])
+                mismatches++;
+        }
+        [[theValue(mismatches) should] equal:theValue(0)];
+    });
+
+    it(@"escapes quotes, backslashes, control characters and NULs", ^{
+        unichar nul[] = {'a', 0, 'b'};
+        NSString *withNul  = [NSString stringWithCharacters:nul length:3];
+        NSString *awkward  = @"\"quoted\" back\\slash\nnew line\ttab\r\x01\x1f \u00e9 \U0001F4DE";
+        NSString *longer   = [@"" stringByPaddingToLength:300 withString:@"\u00e9\"" startingAtIndex:0];
+        NSString *lines    = PKTJSONLines(@[PKTMakeRecord(NO, NO, 1, 1, withNul, awkward, longer)]);
+        NSDictionary *object = [PKTParseJSONLines(lines) firstObject];
+
+        [[theValue([lines rangeOfString:@"a\\u0000b"].location) shouldNot] equal:theValue(NSNotFound)];
+        [[theValue([[lines componentsSeparatedByString:@"\n"] count]) should] equal:theValue(2)];
+        [[object[@"number"] should] equal:withNul];
+        [[object[@"city"] should] equal:awkward];
+        [[object[@"state"] should] equal:longer];
+    });
+
+    it(@"writes missing values and non-finite numbers as null", ^{
+        NSString *lines = PKTJSONLines(@[PKTMakeRecord(YES, NO, NAN, 0, nil, nil, nil),
+                                         PKTMakeRecord(NO, NO, INFINITY, 0, @"1", nil, nil)]);
+        NSArray *objects = PKTParseJSONLines(lines);
+
+        [[theValue(objects.count) should] equal:theValue(2)];
+        [[objects[0] should] equal:@{@"incoming": @YES, @"missed": @NO, @"duration": [NSNull null], @"startTime": [NSNull null],
+                                     @"number": [NSNull null], @"city": [NSNull null], @"state": [NSNull null]}];
+        [[objects[1][@"duration"] should] equal:[NSNull null]];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        __block NSArray *corpus = nil;
+        beforeAll(^{
+            corpus = PKTCallHistoryCorpus(100000);
+        });
+        afterAll(^{
+            corpus = nil;
+        });
+
+        // how records were exported before: a dictionary for each, then a
+        // general-purpose serializer
+        NSDictionary *(^recordDictionary)(PKTCallRecord *) = ^NSDictionary *(PKTCallRecord *record) {
+            NSMutableDictionary *dictionary = [[record dictionaryWithValuesForKeys:@[@"incoming", @"missed", @"duration", @"number",
+                                                                                     @"city", @"state"]] mutableCopy];
+            dictionary[@"startTime"] = record.startTime ? @([record.startTime timeIntervalSince1970]) : [NSNull null];
+            return dictionary;
+        };
+
+        it(@"times and sizes encoded call records against a keyed archive", ^{
+            __block NSData *binary = nil, *archive = nil;
+            NSTimeInterval encoded = PKTBenchmark(3, ^{
+                binary = [PKTCallRecordEncoder dataWithRecords:corpus];
+            });
+            NSTimeInterval archived = PKTBenchmark(3, ^{
+                NSMutableArray *dictionaries = [NSMutableArray arrayWithCapacity:corpus.count];
+                for (PKTCallRecord *record in corpus) {
+                    [dictionaries addObject:recordDictionary(record)];
+                }
+                archive = [NSKeyedArchiver archivedDataWithRootObject:dictionaries];
+            });
+            NSTimeInterval decoded = PKTBenchmark(3, ^{
+                [PKTCallRecordDecoder recordsWithData:binary error:NULL];
+            });
+
+            PKTLogBenchmark(@"call records, PKTCallRecordEncoder", corpus.count, encoded);
+            PKTLogBenchmark(@"call records, PKTCallRecordDecoder", corpus.count, decoded);
+            PKTLogBenchmark(@"call records, dictionaries and NSKeyedArchiver", corpus.count, archived);
+            NSLog(@"[benchmark] call records: binary %lu KB, keyed archive %lu KB",
+                  (unsigned long)binary.length / 1024, (unsigned long)archive.length / 1024);
+        });
+
+        it(@"times JSON lines against NSJSONSerialization per record", ^{
+            __block NSString *lines = nil;
+            __block NSUInteger serializedBytes = 0;
+            NSTimeInterval written = PKTBenchmark(3, ^{
+                lines = PKTJSONLines(corpus);
+            });
+            NSTimeInterval serialized = PKTBenchmark(3, ^{
+                NSMutableData *data = [NSMutableData data];
+                for (PKTCallRecord *record in corpus) {
+                    @autoreleasepool {
+                        [data appendData:[NSJSONSerialization dataWithJSONObject:recordDictionary(record) options:0 error:NULL]];
+                        [data appendBytes:"\n" length:1];
+                    }
+                }
+                serializedBytes = data.length;
+            });
+
+            PKTLogBenchmark(@"call records, PKTCallRecordJSONLinesWriter", corpus.count, written);
+            PKTLogBenchmark(@"call records, dictionaries and NSJSONSerialization", corpus.count, serialized);
+            NSLog(@"[benchmark] call records: JSON lines %lu KB, NSJSONSerialization %lu KB",
+                  (unsigned long)[lines lengthOfBytesUsingEncoding:NSUTF8StringEncoding] / 1024,
+                  (unsigned long)serializedBytes / 1024);
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,233 @@
+//
+//  PKTDialQueueSpec.m
+//  Tests
+//
+
+#import "PKTDialQueue.h"
+#import "PKTPhone.h"
+#import "PKTFakeDevice.h"
+
+@interface PKTDialRecorder : NSObject <PKTDialQueueDelegate>
+
+@property (nonatomic, strong) NSMutableArray *started;   // numbers, in order
+@property (nonatomic, strong) NSMutableArray *finished;  // numbers, in order
+@property (nonatomic, assign) BOOL           done;
+@property (nonatomic, copy  ) void (^startHandler)(PKTDialQueue *queue, PKTDialItem *item);
+
+@end
+
+@implementation PKTDialRecorder
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _started  = [NSMutableArray array];
+        _finished = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dialQueue:(PKTDialQueue *)queue didStartItem:(PKTDialItem *)item
+{
+    [self.started addObject:item.number];
+    if (self.startHandler)
+        self.startHandler(queue, item);
+}
+
+- (void)dialQueue:(PKTDialQueue *)queue didFinishItem:(PKTDialItem *)item
+{
+    [self.finished addObject:item.number];
+}
+
+- (void)dialQueueDidFinish:(PKTDialQueue *)queue
+{
+    self.done = YES;
+}
+
+@end
+
+// spins the main run loop, where the fake device, the phone and the queue deliver
+static BOOL PKTDialRunUntil(BOOL (^condition)(void))
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!condition()) {
+        if ([timeout timeIntervalSinceNow] < 0)
+            return NO;
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+    return YES;
+}
+
+SPEC_BEGIN(PKTDialQueueSpec)
+
+describe(@"PKTDialQueue", ^{
+
+    __block PKTFakeDevice   *device   = nil;
+    __block PKTPhone        *phone    = nil;
+    __block PKTDialQueue    *queue    = nil;
+    __block PKTDialRecorder *recorder = nil;
+
+    beforeEach(^{
+        device = [PKTFakeDevice new];
+        phone  = [PKTPhone new];
+        phone.phoneDevice     = device;
+        phone.capabilityToken = @"fake";
+
+        // every call is picked up and then hung up by the far end, unless a
+        // spec scripts otherwise
+        device.connectDelay = -1;
+        device.outgoingConnectionHandler = ^(PKTFakeConnection *connection) {
+            [connection simulateConnect];
+            [connection.device after:0.01 perform:^(PKTFakeDevice *d) {
+                [connection simulateRemoteHangup];
+            }];
+        };
+
+        recorder = [PKTDialRecorder new];
+        queue    = [[PKTDialQueue alloc] initWithPhone:phone];
+        queue.delegate             = recorder;
+        queue.callInterval         = 0;
+        queue.initialRetryInterval = 0.01;
+        queue.maximumRetryInterval = 0.02;
+    });
+
+    afterEach(^{
+        [queue pause];
+        queue    = nil;
+        recorder = nil;
+        phone    = nil;
+        device   = nil;
+    });
+
+    it(@"normalizes numbers and drops duplicates", ^{
+        NSUInteger added = [queue addNumbers:@[@"+1 (415) 555-0101", @"(415) 555-0102", @"+14155550101", @" client:alice ", @""]
+                                      params:@{@"campaign": @"spring"}];
+        [[theValue(added) should] equal:theValue(3)];
+        [[[queue.items valueForKey:@"number"] should] equal:@[@"+14155550101", @"4155550102", @"client:alice"]];
+        [[[queue.items[0] params] should] equal:@{@"campaign": @"spring"}];
+        [[theValue([queue addNumbers:@[@"14155550101"] params:nil]) should] equal:theValue(0)];
+    });
+
+    it(@"dials every number once, in the order added", ^{
+        [queue addNumbers:@[@"+14155550101", @"+14155550102", @"+14155550103"] params:nil];
+        [queue start];
+        [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+
+        NSArray *numbers = @[@"+14155550101", @"+14155550102", @"+14155550103"];
+        [[recorder.started should] equal:numbers];
+        [[recorder.finished should] equal:numbers];
+        for (PKTDialItem *item in queue.items) {
+            [[theValue(item.state) should] equal:theValue(PKTDialItemStateAnswered)];
+            [[theValue(item.attempts) should] equal:theValue(1)];
+            [[item.record.number should] equal:item.number];
+        }
+        [[theValue(queue.callCount) should] equal:theValue(3)];
+        [[theValue(queue.answerRate) should] equal:theValue(1.0)];
+        [[theValue(queue.callsInLastHour) should] equal:theValue(3)];
+        [[theValue(queue.running) should] beNo];
+        [[[device.connections valueForKeyPath:@"parameters.callee"] should] equal:numbers];
+    });
+
+    it(@"counts a call that ends before it's answered as unanswered", ^{
+        device.outgoingConnectionHandler = ^(PKTFakeConnection *connection) {
+            [connection simulateRemoteHangup];
+        };
+        [queue addNumbers:@[@"+14155550101"] params:nil];
+        [queue start];
+        [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+
+        PKTDialItem *item = queue.items[0];
+        [[theValue(item.state) should] equal:theValue(PKTDialItemStateUnanswered)];
+        [[theValue(item.attempts) should] equal:theValue(1)];
+        [[item.lastError should] beNil];
+        [[theValue(queue.answerRate) should] equal:theValue(0.0)];
+    });
+
+    context(@"when calls fail", ^{
+
+        it(@"retries a failed number until it's out of attempts, without holding up the rest", ^{
+            NSError *dropped = [NSError errorWithDomain:PKTFakeDeviceErrorDomain code:PKTFakeDeviceErrorDropped userInfo:nil];
+            device.outgoingConnectionHandler = ^(PKTFakeConnection *connection) {
+                if ([connection.parameters[@"callee"] isEqualToString:@"+14155550102"]) {
+                    [connection simulateFailureWithError:dropped];
+                    return;
+                }
+                [connection simulateConnect];
+                [connection.device after:0.01 perform:^(PKTFakeDevice *d) {
+                    [connection simulateRemoteHangup];
+                }];
+            };
+            queue.maximumAttempts = 3;
+            [queue addNumbers:@[@"+14155550101", @"+14155550102", @"+14155550103"] params:nil];
+            [queue start];
+            [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+
+            PKTDialItem *failed = queue.items[1];
+            [[theValue(failed.state) should] equal:theValue(PKTDialItemStateFailed)];
+            [[theValue(failed.attempts) should] equal:theValue(3)];
+            [[failed.lastError should] equal:dropped];
+            [[theValue([queue.items[0] state]) should] equal:theValue(PKTDialItemStateAnswered)];
+            [[theValue([queue.items[2] state]) should] equal:theValue(PKTDialItemStateAnswered)];
+
+            // the first retry waits out its backoff, so the next fresh number goes first
+            [[recorder.started should] equal:@[@"+14155550101", @"+14155550102", @"+14155550103", @"+14155550102", @"+14155550102"]];
+            [[theValue(queue.callCount) should] equal:theValue(5)];
+            [[theValue(queue.answerRate) should] equal:2.0 / 3 withDelta:1e-9];
+        });
+
+        it(@"gives up on an attempt that never connects", ^{
+            device.outgoingConnectionHandler = nil;
+            queue.attemptTimeout  = 0.05;
+            queue.maximumAttempts = 1;
+            [queue addNumbers:@[@"+14155550101"] params:nil];
+            [queue start];
+            [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+
+            PKTDialItem *item = queue.items[0];
+            [[theValue(item.state) should] equal:theValue(PKTDialItemStateFailed)];
+            [[item.lastError.domain should] equal:PKTDialQueueErrorDomain];
+            [[theValue(item.lastError.code) should] equal:theValue(PKTDialQueueErrorTimedOut)];
+            [phone hangup];
+        });
+    });
+
+    context(@"when paused", ^{
+
+        it(@"starts no more calls, leaves the one in progress, and picks up where it left off", ^{
+            __block BOOL paused = NO;
+            recorder.startHandler = ^(PKTDialQueue *q, PKTDialItem *item) {
+                if (!paused) {
+                    paused = YES;
+                    [q pause];
+                }
+            };
+            [queue addNumbers:@[@"+14155550101", @"+14155550102"] params:nil];
+            [queue start];
+            [[theValue(PKTDialRunUntil(^{ return (BOOL)(recorder.finished.count == 1); })) should] beYes];
+
+            [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+            [[recorder.started should] equal:@[@"+14155550101"]];
+            [[theValue([queue.items[0] state]) should] equal:theValue(PKTDialItemStateAnswered)];
+            [[theValue([queue.items[1] state]) should] equal:theValue(PKTDialItemStatePending)];
+            [[theValue(queue.running) should] beNo];
+            [[theValue(recorder.done) should] beNo];
+
+            [queue start];
+            [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+            [[recorder.started should] equal:@[@"+14155550101", @"+14155550102"]];
+        });
+
+        it(@"forgets every item once they're removed", ^{
+            [queue addNumbers:@[@"+14155550101", @"+14155550102"] params:nil];
+            [queue removeAllItems];
+            [[queue.items should] beEmpty];
+
+            [queue start];
+            [[theValue(PKTDialRunUntil(^{ return recorder.done; })) should] beYes];
+            [[recorder.started should] beEmpty];
+            [[theValue([queue addNumbers:@[@"+14155550101"] params:nil]) should] equal:theValue(1)];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,139 @@
+//
+//  PKTDialSuggesterSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTDialSuggester.h"
+#import "PKTCallHistory.h"
+
+static PKTCallRecord *PKTSuggestRecord(NSString *number, NSTimeInterval secondsAgo)
+{
+    PKTCallRecord *record = [PKTCallRecord new];
+    record.number    = number;
+    record.startTime = [NSDate dateWithTimeIntervalSinceNow:-secondsAgo];
+    return record;
+}
+
+static NSString *PKTSuggestTemporaryPath(void)
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+}
+
+SPEC_BEGIN(PKTDialSuggesterSpec)
+
+describe(@"PKTDialSuggester", ^{
+
+    __block PKTDialSuggester *suggester = nil;
+    beforeEach(^{
+        suggester = [PKTDialSuggester new];
+    });
+
+    it(@"suggests numbers by digit prefix", ^{
+        [suggester addRecord:PKTSuggestRecord(@"+1 (415) 555-0101", 60)];
+        [suggester addRecord:PKTSuggestRecord(@"+1 (212) 555-0102", 60)];
+
+        NSArray *suggestions = [suggester suggestionsForDigits:@"1415"];
+        [[[suggestions valueForKey:@"number"] should] equal:@[@"14155550101"]];
+        [[theValue([suggestions[0] matchedName]) should] beNo];
+        [[[suggester suggestionsForDigits:@"1"] should] haveCountOf:2];
+        [[[suggester suggestionsForDigits:@"1999"] should] beEmpty];
+        [[[suggester suggestionsForDigits:@""] should] beEmpty];
+    });
+
+    it(@"ranks numbers called more, and more recently, first", ^{
+        NSTimeInterval day = 24 * 3600;
+        [suggester addRecord:PKTSuggestRecord(@"14155550101", 90 * day)];
+        [suggester addRecord:PKTSuggestRecord(@"14155550101", 89 * day)];
+        [suggester addRecord:PKTSuggestRecord(@"14155550102", 60)];
+        [suggester addRecord:PKTSuggestRecord(@"14155550103", 120)];
+        [suggester addRecord:PKTSuggestRecord(@"14155550103", 60)];
+
+        NSArray *suggestions = [suggester suggestionsForDigits:@"1415"];
+        [[[suggestions valueForKey:@"number"] should] equal:@[@"14155550103", @"14155550102", @"14155550101"]];
+        [[theValue([suggestions[0] callCount]) should] equal:theValue(2)];
+        [[theValue([[suggestions[0] lastCallDate] timeIntervalSinceNow]) should] equal:-60 withDelta:5];
+    });
+
+    it(@"matches names by their keypad digits from the start of any word", ^{
+        [suggester addRecord:PKTSuggestRecord(@"14155550101", 60)];
+        [suggester addContactWithName:@"Bob Smith" number:@"+1 415 555 0101"];
+
+        NSArray *suggestions = [suggester suggestionsForDigits:@"76"];
+        [[suggestions should] haveCountOf:1];
+        [[[suggestions[0] name] should] equal:@"Bob Smith"];
+        [[theValue([suggestions[0] matchedName]) should] beYes];
+        [[[[suggester suggestionsForDigits:@"262"][0] number] should] equal:@"14155550101"];
+        [[[suggester suggestionsForDigits:@"66"] should] beEmpty];
+    });
+
+    it(@"suggests at most six, and skips client numbers", ^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            [suggester addRecord:PKTSuggestRecord([NSString stringWithFormat:@"1415555%04lu", (unsigned long)i], 60 + i)];
+        }
+        [suggester addRecord:PKTSuggestRecord(@"client:alice", 0)];
+
+        NSArray *suggestions = [suggester suggestionsForDigits:@"1415"];
+        [[suggestions should] haveCountOf:6];
+        [[[suggestions[0] number] should] equal:@"14155550000"];
+        [[[suggester suggestionsForDigits:@"2"] should] beEmpty];
+    });
+
+    it(@"forgets everything on removeAll", ^{
+        [suggester addRecord:PKTSuggestRecord(@"14155550101", 60)];
+        [suggester removeAll];
+        [[[suggester suggestionsForDigits:@"1"] should] beEmpty];
+    });
+
+    it(@"loads a call history in the background", ^{
+        NSString *path = PKTSuggestTemporaryPath();
+        PKTCallHistory *history = [[PKTCallHistory alloc] initWithPath:path error:NULL];
+        for (NSUInteger i = 0; i < 2500; i++) {
+            [history appendRecord:PKTSuggestRecord([NSString stringWithFormat:@"1212555%04lu", (unsigned long)(i % 100)], 2500 - i) error:NULL];
+        }
+
+        __block BOOL loaded = NO;
+        [suggester addRecordsFromHistory:history completion:^{
+            loaded = YES;
+        }];
+        __block NSArray *suggestions = nil;
+        [suggester suggestionsForDigits:@"1212" completion:^(NSArray *found) {
+            suggestions = found;
+        }];
+        [[expectFutureValue(theValue(loaded)) shouldEventually] beYes];
+        [[expectFutureValue(suggestions) shouldEventually] haveCountOf:6];
+        [[theValue([suggestions[0] callCount]) should] equal:theValue(25)];
+        [[[suggestions[0] number] should] equal:@"12125550099"];
+
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        it(@"times lookups against a 100k-call history", ^{
+            NSUInteger calls = 100000;
+            srandom(42);
+            for (NSUInteger i = 0; i < calls; i++) {
+                NSString *number = [NSString stringWithFormat:@"1%03ld555%04ld", 200 + random() % 800, random() % 10000];
+                [suggester addRecord:PKTSuggestRecord(number, calls - i)];
+            }
+            [suggester suggestionsForDigits:@"1"];  // waits for the adds
+
+            NSArray *prefixes = @[@"1", @"12", @"141", @"1415", @"14155", @"141555", @"1415555", @"76", @"7648"];
+            NSUInteger queries = 10000;
+            NSTimeInterval seconds = PKTBenchmark(3, ^{
+                for (NSUInteger i = 0; i < queries; i++) {
+                    @autoreleasepool {
+                        [suggester suggestionsForDigits:prefixes[i % prefixes.count]];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"dial suggestions, 100k-call history", queries, seconds);
+            NSLog(@"[benchmark] dial suggestions: %.3f ms per query", seconds * 1000 / queries);
+            [[[suggester suggestionsForDigits:@"1"] should] haveCountOf:6];
+        });
+    });
+});
+
+SPEC_END
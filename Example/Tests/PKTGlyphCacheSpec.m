@@ -0,0 +1,168 @@
+//
+//  PKTGlyphCacheSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTGlyphCache.h"
+
+// hands out empty images and counts what it was asked to draw
+@interface PKTStubRasterizer : NSObject <PKTGlyphRasterizer>
+
+@property (nonatomic, assign) NSUInteger drawCount;
+@property (nonatomic, assign) BOOL       failing;
+
+@end
+
+@implementation PKTStubRasterizer
+
+- (UIImage *)imageWithIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale
+{
+    self.drawCount++;
+    return self.failing ? nil : [UIImage new];
+}
+
+@end
+
+SPEC_BEGIN(PKTGlyphCacheSpec)
+
+describe(@"PKTGlyphCache", ^{
+
+    __block PKTStubRasterizer *rasterizer = nil;
+    __block PKTGlyphCache     *cache      = nil;
+    CGRect bounds = CGRectMake(10, 10, 50, 50);
+
+    beforeEach(^{
+        rasterizer = [PKTStubRasterizer new];
+        cache      = [[PKTGlyphCache alloc] initWithRasterizer:rasterizer];
+    });
+
+    it(@"draws an icon once and then reuses its image", ^{
+        UIImage *first = [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        UIImage *again = [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+
+        [[again should] beIdenticalTo:first];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(1)];
+        [[theValue(cache.missCount) should] equal:theValue(1)];
+        [[theValue(cache.hitCount) should] equal:theValue(1)];
+    });
+
+    it(@"keys images by icon, size, inset, color and scale", ^{
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon replyIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIEntypoIcon muteIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:CGRectMake(10, 10, 60, 60) color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:CGRectMake(5, 5, 50, 50) color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor redColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:3];
+
+        [[theValue(rasterizer.drawCount) should] equal:theValue(7)];
+        [[theValue(cache.count) should] equal:theValue(7)];
+    });
+
+    it(@"tells apart colors that differ only slightly or only in color space", ^{
+        UIColor *gray   = [UIColor colorWithWhite:0.5 alpha:1];
+        UIColor *rgb    = [UIColor colorWithRed:0.5 green:0.5 blue:0.5 alpha:1];
+        UIColor *nudged = [UIColor colorWithRed:0.5 green:0.5 blue:0.5 + 1e-7 alpha:1];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:gray scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:rgb scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:nudged scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor colorWithRed:0.5 green:0.5 blue:0.5 alpha:1] scale:2];
+
+        [[theValue(rasterizer.drawCount) should] equal:theValue(3)];
+        [[theValue(cache.hitCount) should] equal:theValue(1)];
+    });
+
+    it(@"gives equal keys for the same icon, bounds, color and scale", ^{
+        id<NSCopying> key   = [PKTGlyphCache keyForIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        id<NSCopying> again = [PKTGlyphCache keyForIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [[(id)again should] equal:key];
+        [[theValue([(id)again hash]) should] equal:theValue([(id)key hash])];
+        [[(id)[PKTGlyphCache keyForIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:nil scale:2] shouldNot] equal:key];
+        [[(id)[PKTGlyphCache keyForIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:-0.0] should]
+            equal:[PKTGlyphCache keyForIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:0]];
+    });
+
+    it(@"uses the main screen's scale for scale 0", ^{
+        CGFloat scale = [UIScreen mainScreen].scale;
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:0];
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:scale];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(1)];
+    });
+
+    it(@"evicts the least recently used image past its limit", ^{
+        cache.countLimit = 3;
+        NSArray *icons = @[[FIFontAwesomeIcon phoneIcon], [FIFontAwesomeIcon replyIcon], [FIFontAwesomeIcon thIcon]];
+        for (FIIcon *icon in icons) {
+            [cache imageWithIcon:icon bounds:bounds color:[UIColor whiteColor] scale:2];
+        }
+        // phone is now the most recently used, so reply goes first
+        [cache imageWithIcon:icons[0] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [cache imageWithIcon:[FIFontAwesomeIcon microphoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [[theValue(cache.count) should] equal:theValue(3)];
+
+        rasterizer.drawCount = 0;
+        [cache imageWithIcon:icons[0] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(0)];
+        [cache imageWithIcon:icons[1] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(1)];
+    });
+
+    it(@"evicts down to a lowered limit at once", ^{
+        for (FIIcon *icon in @[[FIFontAwesomeIcon phoneIcon], [FIFontAwesomeIcon replyIcon], [FIFontAwesomeIcon thIcon]]) {
+            [cache imageWithIcon:icon bounds:bounds color:[UIColor whiteColor] scale:2];
+        }
+        cache.countLimit = 1;
+        [[theValue(cache.count) should] equal:theValue(1)];
+    });
+
+    it(@"empties on a memory warning", ^{
+        [cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2];
+        [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+        [[theValue(cache.count) should] equal:theValue(0)];
+    });
+
+    it(@"caches nothing for a nil icon or a failed drawing", ^{
+        [[[cache imageWithIcon:nil bounds:bounds color:[UIColor whiteColor] scale:2] should] beNil];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(0)];
+
+        rasterizer.failing = YES;
+        [[[cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2] should] beNil];
+        [[[cache imageWithIcon:[FIFontAwesomeIcon phoneIcon] bounds:bounds color:[UIColor whiteColor] scale:2] should] beNil];
+        [[theValue(rasterizer.drawCount) should] equal:theValue(2)];
+        [[theValue(cache.count) should] equal:theValue(0)];
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        it(@"times toggling the call pad icons against drawing them each time", ^{
+            PKTIconLayerRasterizer *coreText = [PKTIconLayerRasterizer new];
+            PKTGlyphCache *shared = [[PKTGlyphCache alloc] initWithRasterizer:coreText];
+            NSArray *icons = @[[FIFontAwesomeIcon microphoneIcon], [FIFontAwesomeIcon microphoneOffIcon],
+                               [FIFontAwesomeIcon volumeUpIcon], [FIFontAwesomeIcon volumeDownIcon]];
+            CGRect iconBounds = CGRectMake(12, 12, 44, 44);
+            NSUInteger toggles = 1000;
+
+            NSTimeInterval drawn = PKTBenchmark(3, ^{
+                for (NSUInteger i = 0; i < toggles; i++) {
+                    @autoreleasepool {
+                        [coreText imageWithIcon:icons[i % icons.count] bounds:iconBounds color:[UIColor whiteColor] scale:2];
+                    }
+                }
+            });
+            NSTimeInterval cached = PKTBenchmark(3, ^{
+                for (NSUInteger i = 0; i < toggles; i++) {
+                    @autoreleasepool {
+                        [shared imageWithIcon:icons[i % icons.count] bounds:iconBounds color:[UIColor whiteColor] scale:2];
+                    }
+                }
+            });
+
+            PKTLogBenchmark(@"icon toggles, CoreText each time", toggles, drawn);
+            PKTLogBenchmark(@"icon toggles, PKTGlyphCache", toggles, cached);
+            [[theValue(shared.missCount) should] equal:theValue(icons.count)];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,48 @@
+//
+//  PKTNumberIndexSpec.m
+//  Tests
+//
+
+#import "PKTNumberIndex.h"
+
+SPEC_BEGIN(PKTNumberIndexSpec)
+
+describe(@"PKTNumberIndex", ^{
+
+    __block PKTNumberIndex *index = nil;
+    beforeEach(^{
+        index = [[PKTNumberIndex alloc] initWithNumbers:@[@"+1 (415) 555-0123", @"client:alice", @"+44 20 7946 0958",
+                                                          @"+1 (٤١٥) ５５５-0199", @"555-0123"]];
+    });
+
+    it(@"matches numbers by their digits", ^{
+        [[theValue([index indexOfNumber:@"14155550123" match:PKTNumberMatchExact]) should] equal:theValue(0)];
+        [[theValue([index indexOfNumber:@"4155550123" match:PKTNumberMatchExact]) should] equal:theValue(NSNotFound)];
+        [[theValue([index indexOfNumber:@"4155550123" match:PKTNumberMatchNational]) should] equal:theValue(0)];
+        NSMutableIndexSet *expected = [NSMutableIndexSet indexSetWithIndex:0];
+        [expected addIndex:4];
+        [[[index indexesOfNumber:@"(650) 555-0123" match:PKTNumberMatchLast7] should] equal:expected];
+    });
+
+    it(@"matches client numbers only by name", ^{
+        [[theValue([index indexOfNumber:@"client:alice" match:PKTNumberMatchLast7]) should] equal:theValue(1)];
+        [[theValue([index indexOfNumber:@"client:bob" match:PKTNumberMatchExact]) should] equal:theValue(NSNotFound)];
+    });
+
+    context(@"with digits from other scripts", ^{
+
+        it(@"treats them as a phone number, not a client name", ^{
+            [[theValue([index indexOfNumber:@"14155550199" match:PKTNumberMatchExact]) should] equal:theValue(3)];
+            [[theValue([index indexOfNumber:@"٤١٥٥٥٥٠١٢٣" match:PKTNumberMatchNational]) should] equal:theValue(0)];
+            [[theValue([index indexOfNumber:@"１ ４１５ ５５５ ０１２３" match:PKTNumberMatchExact]) should] equal:theValue(0)];
+        });
+
+        it(@"matches them in a batch too", ^{
+            NSArray *matches = [index matchNumbers:@[@"۴۱۵۵۵۵۰۱۹۹", @"client:alice", @"+1 415 555 0000"]
+                                             match:PKTNumberMatchLast10];
+            [[matches should] equal:@[@3, @1, [NSNull null]]];
+        });
+    });
+});
+
+SPEC_END
@@ -0,0 +1,165 @@
+//
+//  PKTNumberNormalizerSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "NSString+PKTHelpers.h"
+#import "PKTNumberNormalizer.h"
+
+// the NSString+PKTHelpers implementations PKTNumberNormalizer replaced
+static BOOL PKTLegacyIsClientNumber(NSString *number)
+{
+    NSCharacterSet *charsetForClient = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789+-()  "] invertedSet];
+    return [number rangeOfCharacterFromSet:charsetForClient].location != NSNotFound;
+}
+
+static NSString *PKTLegacyStripToDigitsOnly(NSString *number)
+{
+    NSCharacterSet *strippingCharSet = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
+    return [[number componentsSeparatedByCharactersInSet:strippingCharSet] componentsJoinedByString:@""];
+}
+
+static NSString *PKTLegacySanitizeNumber(NSString *number)
+{
+    if (PKTLegacyIsClientNumber(number)) {
+        NSRange clientColonRange = [number rangeOfString:@"client:"];
+        if (clientColonRange.location != NSNotFound && number.length > NSMaxRange(clientColonRange))
+            return [number substringFromIndex:NSMaxRange(clientColonRange)];
+        return number;
+    }
+    return PKTLegacyStripToDigitsOnly(number);
+}
+
+// numbers as they turn up in call logs and address books
+static NSArray *PKTNumberCorpus(NSUInteger count)
+{
+    NSArray *formats = @[@"+1 (%03u) %03u-%04u", @"%03u.%03u.%04u", @"1-%03u-%03u-%04u", @"+44 %03u %03u %04u",
+                         @"(%03u) %03u %04u", @"%03u%03u%04u"];
+    NSMutableArray *numbers = [NSMutableArray arrayWithCapacity:count];
+    srandom(42);
+    for (NSUInteger i = 0; i < count; i++) {
+        if (i % 20 == 0) {
+            [numbers addObject:[NSString stringWithFormat:@"client:agent%lu", (unsigned long)(i % 500)]];
+            continue;
+        }
+        unsigned area = 200 + random() % 800, exchange = 200 + random() % 800, line = random() % 10000;
+        [numbers addObject:[NSString stringWithFormat:formats[i % formats.count], area, exchange, line]];
+    }
+    return numbers;
+}
+
+SPEC_BEGIN(PKTNumberNormalizerSpec)
+
+describe(@"PKTNumberNormalizer", ^{
+
+    context(@"normalizing", ^{
+
+        it(@"keeps decimal digits from any script", ^{
+            NSString *number = @"+1 (٤١٥) ５５５-0123";
+            [[[number stripToDigitsOnly] should] equal:PKTLegacyStripToDigitsOnly(number)];
+            [[[number stripToDigitsOnly] should] equal:@"1٤١٥５５５0123"];
+            // digits compare as written, as they always have
+            [[theValue([number equalsPhoneNumber:@"14155550123"]) should] beNo];
+        });
+
+        it(@"reports the full digit count when the buffer is short", ^{
+            unichar chars[] = {'4', '1', '5', '-', '5', '5', '5'};
+            unichar buffer[3];
+            [[theValue(PKTNormalizeDigits(chars, 7, buffer, 3)) should] equal:theValue(6)];
+            [[[NSString stringWithCharacters:buffer length:3] should] equal:@"415"];
+        });
+
+        it(@"tells client names from phone numbers", ^{
+            [[theValue([@"client:alice" isClientNumber]) should] beYes];
+            [[theValue([@"+1 (415) 555-0123" isClientNumber]) should] beNo];
+            [[theValue([@"415 555 0123" isClientNumber]) should] beNo];
+        });
+
+        it(@"compares numbers by their digits", ^{
+            [[theValue([@"+1 (415) 555-0123" equalsPhoneNumber:@"14155550123"]) should] beYes];
+            [[theValue([@"415-555-0123" equalsPhoneNumber:@"14155550123"]) should] beNo];
+            [[theValue([@"415" equalsPhoneNumber:nil]) should] beNo];
+        });
+
+        it(@"drops only a leading 1 from phone numbers", ^{
+            [[[@"+1 415 555 0123" sanitizeNumberAndRemoveOne] should] equal:@"4155550123"];
+            [[[@"client:1alice" sanitizeNumberAndRemoveOne] should] equal:@"1alice"];
+        });
+
+        it(@"finds the same digits as the old implementation did", ^{
+            unichar digits[PKT_INLINE_CHARACTER_COUNT];
+            for (NSString *number in PKTNumberCorpus(10000)) {
+                PKTCharacterBuffer chars;
+                PKTCharacterBufferInit(&chars, number);
+                NSUInteger count = PKTNormalizeDigits(chars.characters, chars.length, digits, PKT_INLINE_CHARACTER_COUNT);
+                PKTCharacterBufferRelease(&chars);
+                [[[NSString stringWithCharacters:digits length:MIN(count, PKT_INLINE_CHARACTER_COUNT)] should]
+                 equal:PKTLegacyStripToDigitsOnly(number)];
+            }
+        });
+
+        it(@"sanitizes exactly as the old implementation did", ^{
+            for (NSString *number in PKTNumberCorpus(10000)) {
+                [[[number sanitizeNumber] should] equal:PKTLegacySanitizeNumber(number)];
+            }
+        });
+    });
+
+    if (PKTBenchmarksEnabled()) context(@"benchmark", ^{
+
+        __block NSArray *corpus = nil;
+        beforeAll(^{
+            corpus = PKTNumberCorpus(1000000);
+        });
+        afterAll(^{
+            corpus = nil;
+        });
+
+        // every loop gets the same runs and the same per-number autorelease
+        // pool, so the only difference is the normalization itself
+        NSTimeInterval (^timeCorpus)(void (^)(NSString *)) = ^NSTimeInterval(void (^normalize)(NSString *)) {
+            return PKTBenchmark(3, ^{
+                for (NSString *number in corpus) {
+                    @autoreleasepool {
+                        normalize(number);
+                    }
+                }
+            });
+        };
+
+        it(@"times stripping a 1M-number corpus into strings and into a caller buffer", ^{
+            NSTimeInterval legacy = timeCorpus(^(NSString *number) {
+                PKTLegacyStripToDigitsOnly(number);
+            });
+            NSTimeInterval helpers = timeCorpus(^(NSString *number) {
+                [number stripToDigitsOnly];
+            });
+            NSTimeInterval normalized = timeCorpus(^(NSString *number) {
+                unichar digits[PKT_INLINE_CHARACTER_COUNT];
+                PKTCharacterBuffer chars;
+                PKTCharacterBufferInit(&chars, number);
+                PKTNormalizeDigits(chars.characters, chars.length, digits, PKT_INLINE_CHARACTER_COUNT);
+                PKTCharacterBufferRelease(&chars);
+            });
+
+            PKTLogBenchmark(@"legacy stripToDigitsOnly", corpus.count, legacy);
+            PKTLogBenchmark(@"stripToDigitsOnly", corpus.count, helpers);
+            PKTLogBenchmark(@"PKTNormalizeDigits", corpus.count, normalized);
+        });
+
+        it(@"times sanitizing a 1M-number corpus", ^{
+            NSTimeInterval legacy = timeCorpus(^(NSString *number) {
+                PKTLegacySanitizeNumber(number);
+            });
+            NSTimeInterval helpers = timeCorpus(^(NSString *number) {
+                [number sanitizeNumber];
+            });
+
+            PKTLogBenchmark(@"legacy sanitizeNumber", corpus.count, legacy);
+            PKTLogBenchmark(@"sanitizeNumber", corpus.count, helpers);
+        });
+    });
+});
+
+SPEC_END
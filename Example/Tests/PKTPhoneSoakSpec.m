@@ -0,0 +1,157 @@
+//
+//  PKTPhoneSoakSpec.m
+//  Tests
+//
+
+#import "PKTBenchmark.h"
+#import "PKTPhone.h"
+#import "PKTFakeDevice.h"
+
+static const NSUInteger kPKTSoakCalls     = 10000;
+static const NSUInteger kPKTSoakBlockSize = 1000;
+
+@interface PKTSoakDelegate : NSObject <PKTPhoneDelegate>
+
+@property (nonatomic, assign) NSUInteger started;
+@property (nonatomic, assign) NSUInteger connected;
+@property (nonatomic, assign) NSUInteger ended;
+@property (nonatomic, assign) NSUInteger failed;
+
+@end
+
+@implementation PKTSoakDelegate
+
+- (void)callStartedWithParams:(NSDictionary *)params incoming:(BOOL)incoming
+{
+    self.started++;
+}
+
+- (void)callConnected
+{
+    self.connected++;
+}
+
+- (void)callEndedWithRecord:(PKTCallRecord *)record error:(NSError *)error
+{
+    self.ended++;
+    if (error)
+        self.failed++;
+}
+
+@end
+
+// spins the main run loop, where the fake device and the phone deliver
+static BOOL PKTRunUntil(BOOL (^condition)(void))
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!condition()) {
+        if ([timeout timeIntervalSinceNow] < 0)
+            return NO;
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+    return YES;
+}
+
+SPEC_BEGIN(PKTPhoneSoakSpec)
+
+describe(@"PKTPhone soak", ^{
+
+    __block PKTPhone        *phone    = nil;
+    __block PKTFakeDevice   *device   = nil;
+    __block PKTSoakDelegate *delegate = nil;
+
+    beforeEach(^{
+        delegate = [PKTSoakDelegate new];
+        device   = [PKTFakeDevice new];
+        phone    = [PKTPhone new];
+        phone.delegate        = delegate;
+        phone.phoneDevice     = device;
+        phone.capabilityToken = @"fake";
+    });
+
+    afterEach(^{
+        phone    = nil;
+        device   = nil;
+        delegate = nil;
+    });
+
+    // one call, alternating between an answered incoming call the far end
+    // hangs up and an outgoing call hung up here
+    BOOL (^placeCall)(NSUInteger) = ^BOOL(NSUInteger i) {
+        NSUInteger ended = delegate.ended;
+        if (i % 2 == 0) {
+            PKTFakeConnection *connection = [device simulateIncomingCallFrom:[NSString stringWithFormat:@"+1415555%04lu", (unsigned long)(i % 10000)]];
+            if (!PKTRunUntil(^{ return (BOOL)(delegate.started > i); }))
+                return NO;
+            [phone respondToIncomingCall:PKTCallResponseAccept];
+            if (!PKTRunUntil(^{ return (BOOL)(connection.state == TCConnectionStateConnected); }))
+                return NO;
+            [connection simulateRemoteHangup];
+        } else {
+            [phone call:[NSString stringWithFormat:@"+1212555%04lu", (unsigned long)(i % 10000)]];
+            if (!PKTRunUntil(^{ return (BOOL)(phone.activeConnection.state == TCConnectionStateConnected); }))
+                return NO;
+            [phone hangup];
+        }
+        if (!PKTRunUntil(^{ return (BOOL)(delegate.ended > ended); }))
+            return NO;
+        [device removeFinishedConnections];
+        return YES;
+    };
+
+    it(@"places and ends a run of alternating calls", ^{
+        NSUInteger calls = 20;
+        for (NSUInteger i = 0; i < calls; i++) {
+            if (!placeCall(i)) {
+                fail(@"call %lu didn't finish", (unsigned long)i);
+                return;
+            }
+        }
+        [[theValue(delegate.ended) should] equal:theValue(calls)];
+        [[theValue(delegate.connected) should] equal:theValue(calls)];
+        [[theValue(delegate.failed) should] equal:theValue(0)];
+        [[theValue(phone.callCount) should] equal:theValue(0)];
+    });
+
+    if (PKTBenchmarksEnabled()) it(@"logs memory and dispatch cost over 10k calls", ^{
+        NSMutableArray *blockTimes = [NSMutableArray array];
+        uint64_t baseline = 0;
+
+        for (NSUInteger block = 0; block < kPKTSoakCalls / kPKTSoakBlockSize; block++) {
+            __block BOOL completed = YES;
+            NSTimeInterval seconds = PKTBenchmark(1, ^{
+                for (NSUInteger i = block * kPKTSoakBlockSize; i < (block + 1) * kPKTSoakBlockSize && completed; i++) {
+                    @autoreleasepool {
+                        completed = placeCall(i);
+                    }
+                }
+            });
+            if (!completed) {
+                fail(@"call %lu didn't finish", (unsigned long)delegate.ended);
+                return;
+            }
+            [blockTimes addObject:@(seconds)];
+            PKTLogBenchmark([NSString stringWithFormat:@"soak calls %lu-%lu", (unsigned long)(block * kPKTSoakBlockSize),
+                             (unsigned long)((block + 1) * kPKTSoakBlockSize - 1)], kPKTSoakBlockSize, seconds);
+
+            // the first block warms up caches, queues and the allocator
+            if (block == 0)
+                baseline = PKTResidentMemory();
+        }
+
+        uint64_t growth = PKTResidentMemory() - MIN(baseline, PKTResidentMemory());
+        NSLog(@"[benchmark] soak resident growth after warmup: %llu KB", growth / 1024);
+
+        [[theValue(delegate.ended) should] equal:theValue(kPKTSoakCalls)];
+        [[theValue(delegate.connected) should] equal:theValue(kPKTSoakCalls)];
+        [[theValue(delegate.failed) should] equal:theValue(0)];
+        [[theValue(phone.callCount) should] equal:theValue(0)];
+
+        // a leaked binding or subscription per call shows up as resident growth,
+        // and anything that piles up per call as later blocks slowing down
+        NSTimeInterval first = [blockTimes[1] doubleValue], last = [[blockTimes lastObject] doubleValue];
+        NSLog(@"[benchmark] soak last block / first after warmup: %.2f", first > 0 ? last / first : 0);
+    });
+});
+
+SPEC_END
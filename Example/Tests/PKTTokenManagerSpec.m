@@ -0,0 +1,191 @@
+//
+//  PKTTokenManagerSpec.m
+//  Tests
+//
+
+#import "PKTTokenManager.h"
+#import "PKTStubTokenProvider.h"
+#import "PKTPhone.h"
+#import "PKTFakeDevice.h"
+
+// spins the main run loop, where the stub provider and the manager deliver
+static BOOL PKTTokenRunUntil(BOOL (^condition)(void))
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5];
+    while (!condition()) {
+        if ([timeout timeIntervalSinceNow] < 0)
+            return NO;
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+    return YES;
+}
+
+SPEC_BEGIN(PKTTokenManagerSpec)
+
+describe(@"PKTTokenManager", ^{
+
+    __block PKTStubTokenProvider *provider = nil;
+    __block PKTTokenManager      *manager  = nil;
+
+    beforeEach(^{
+        provider = [PKTStubTokenProvider new];
+        manager  = [[PKTTokenManager alloc] initWithProvider:provider];
+        manager.initialRetryInterval = 0.01;
+        manager.maximumRetryInterval = 0.05;
+    });
+
+    afterEach(^{
+        [manager stop];
+        manager  = nil;
+        provider = nil;
+    });
+
+    context(@"refreshing", ^{
+
+        it(@"fetches a token on start and takes its expiry", ^{
+            provider.tokenLifetime = 120;
+            [manager start];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [[manager.token should] equal:@"stub-token-1"];
+            [[theValue([manager.expirationDate timeIntervalSinceNow]) should] beInTheIntervalFrom:theValue(110) to:theValue(120)];
+            [[theValue([manager hasValidToken]) should] beYes];
+            [[theValue(manager.fetchLatency.count) should] equal:theValue(1)];
+        });
+
+        it(@"assumes the default lifetime when the expiry is unknown", ^{
+            provider.tokenLifetime       = 0;
+            manager.defaultTokenLifetime = 600;
+            [manager refreshTokenWithCompletion:nil];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [[theValue([manager.expirationDate timeIntervalSinceNow]) should] beInTheIntervalFrom:theValue(590) to:theValue(600)];
+        });
+
+        it(@"shares one fetch among concurrent refreshes", ^{
+            provider.latency = 0.05;
+            NSMutableArray *tokens = [NSMutableArray array];
+            for (NSUInteger i = 0; i < 3; i++) {
+                [manager refreshTokenWithCompletion:^(NSString *token, NSError *error) {
+                    [tokens addObject:token ?: [NSNull null]];
+                }];
+            }
+            [[theValue(manager.refreshing) should] beYes];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(tokens.count == 3); })) should] beYes];
+
+            [[theValue(provider.fetchCount) should] equal:theValue(1)];
+            [[tokens should] equal:@[@"stub-token-1", @"stub-token-1", @"stub-token-1"]];
+            [[theValue(manager.refreshing) should] beNo];
+        });
+
+        it(@"refreshes ahead of expiry while started", ^{
+            provider.tokenLifetime  = 0.3;
+            manager.refreshLeadTime = 0.1;
+            [manager start];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(provider.fetchCount >= 2 && [manager.token isEqualToString:@"stub-token-2"]); })) should] beYes];
+
+            [[theValue([manager hasValidToken]) should] beYes];
+        });
+
+        it(@"doesn't fetch on start while the token is still fresh", ^{
+            [manager refreshTokenWithCompletion:nil];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [manager start];
+            [[theValue(manager.refreshing) should] beNo];
+            [[theValue(provider.fetchCount) should] equal:theValue(1)];
+        });
+
+        it(@"stops refreshing once stopped", ^{
+            provider.tokenLifetime  = 0.1;
+            manager.refreshLeadTime = 0.05;
+            [manager start];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [manager stop];
+            NSUInteger fetches = provider.fetchCount;
+            // well past when the next refresh was due
+            [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+            [[theValue(provider.fetchCount) should] equal:theValue(fetches)];
+        });
+    });
+
+    context(@"failing", ^{
+
+        it(@"reports the error to waiting completions and retries with backoff", ^{
+            provider.failuresRemaining = 2;
+            __block NSError *firstError = nil;
+            [manager refreshTokenWithCompletion:^(NSString *token, NSError *error) {
+                firstError = error;
+            }];
+            [manager start];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [[firstError should] beNonNil];
+            [[manager.token should] equal:@"stub-token-3"];
+            [[theValue(provider.fetchCount) should] equal:theValue(3)];
+            [[manager.lastError should] beNil];
+            [[theValue(manager.fetchLatency.count) should] equal:theValue(1)];
+        });
+
+        it(@"keeps the last error while it has no token", ^{
+            provider.failuresRemaining = 1;
+            __block BOOL finished = NO;
+            [manager refreshTokenWithCompletion:^(NSString *token, NSError *error) {
+                finished = YES;
+            }];
+            [[theValue(PKTTokenRunUntil(^{ return finished; })) should] beYes];
+
+            [[manager.token should] beNil];
+            [[theValue(manager.lastError.code) should] equal:theValue(PKTFakeDeviceErrorFailed)];
+            [[theValue([manager hasValidToken]) should] beNo];
+        });
+    });
+
+    context(@"expiring", ^{
+
+        it(@"stops counting a token as valid once it expires", ^{
+            provider.tokenLifetime = 0.05;
+            [manager refreshTokenWithCompletion:nil];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)![manager hasValidToken]; })) should] beYes];
+            [[manager.token should] equal:@"stub-token-1"];
+        });
+
+        it(@"takes a later expiry only for the current token", ^{
+            [manager refreshTokenWithCompletion:nil];
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(manager.token != nil); })) should] beYes];
+
+            NSDate *later = [NSDate dateWithTimeIntervalSinceNow:7200];
+            [manager updateExpirationDate:later forToken:@"stub-token-0"];
+            [[manager.expirationDate shouldNot] equal:later];
+            [manager updateExpirationDate:later forToken:@"stub-token-1"];
+            [[manager.expirationDate should] equal:later];
+        });
+    });
+
+    context(@"with a phone", ^{
+
+        it(@"holds a call made without a valid token until a new one arrives", ^{
+            PKTFakeDevice *device = [PKTFakeDevice new];
+            PKTPhone *phone       = [PKTPhone new];
+            phone.phoneDevice     = device;
+            provider.latency      = 0.05;
+
+            phone.tokenManager = manager;
+            [phone call:@"+14155550123"];
+            [[device.connections should] beEmpty];
+
+            [[theValue(PKTTokenRunUntil(^{ return (BOOL)(device.connections.count == 1); })) should] beYes];
+            [[theValue(provider.fetchCount) should] equal:theValue(1)];
+            [[device.capabilityToken should] equal:@"stub-token-1"];
+            [[[device.connections[0] parameters][@"callee"] should] equal:@"+14155550123"];
+
+            [phone hangup];
+            phone.tokenManager = nil;
+        });
+    });
+});
+
+SPEC_END
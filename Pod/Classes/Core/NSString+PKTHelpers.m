@@ -1,29 +1,54 @@
 #import "ReactiveCocoa.h"
 #import "NSString+PKTHelpers.h"
+#import "PKTNumberNormalizer.h"
+
+static NSString *PKTDigitsOnly(NSString *string, BOOL dropLeadingOne)
+{
+    PKTCharacterBuffer chars;
+    PKTCharacterBufferInit(&chars, string);
+
+    unichar inlineDigits[PKT_INLINE_CHARACTER_COUNT];
+    unichar *digits  = chars.length > PKT_INLINE_CHARACTER_COUNT ? malloc(chars.length * sizeof(unichar))
+                                                                 : inlineDigits;
+    NSUInteger count = PKTNormalizeDigits(chars.characters, chars.length, digits, chars.length);
+    NSUInteger skip  = (dropLeadingOne && count && digits[0] == '1') ? 1 : 0;
+    NSString *result = [NSString stringWithCharacters:digits + skip length:count - skip];
+
+    if (digits != inlineDigits)
+        free(digits);
+    PKTCharacterBufferRelease(&chars);
+    return result;
+}
 
 @implementation NSString (PKTHelpers)
 
 - (BOOL)isClientNumber
 {
     // (This isn't precise E.164 parsing, but it's easy enough for now.)
-	NSCharacterSet* charsetForClient = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789+-()  "] invertedSet];
-	return [self rangeOfCharacterFromSet:charsetForClient].location != NSNotFound;
+    PKTCharacterBuffer chars;
+    PKTCharacterBufferInit(&chars, self);
+    BOOL isClient = PKTCharactersAreClientNumber(chars.characters, chars.length);
+    PKTCharacterBufferRelease(&chars);
+    return isClient;
 }
 
 - (BOOL)equalsPhoneNumber:(NSString *)number
 {
     if (!number)
         return NO;
-    
-    NSString* stripped = [number stripToDigitsOnly];
-    
-    return [[self stripToDigitsOnly] isEqualToString:stripped];
+
+    PKTCharacterBuffer mine, theirs;
+    PKTCharacterBufferInit(&mine, self);
+    PKTCharacterBufferInit(&theirs, number);
+    BOOL equal = PKTDigitsEqual(mine.characters, mine.length, theirs.characters, theirs.length);
+    PKTCharacterBufferRelease(&theirs);
+    PKTCharacterBufferRelease(&mine);
+    return equal;
 }
 
 - (NSString *)stripToDigitsOnly
 {
-    NSCharacterSet *strippingCharSet = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
-    return [[self componentsSeparatedByCharactersInSet:strippingCharSet] componentsJoinedByString:@""];
+    return PKTDigitsOnly(self, NO);
 }
 
 - (NSString *)sanitizeNumber
@@ -43,15 +68,9 @@
 
 - (NSString *)sanitizeNumberAndRemoveOne
 {
-    NSString *sanitized = self;
-    sanitized = [self sanitizeNumber];
-    if (!sanitized.length)
-        return sanitized;
-    if (![self isClientNumber] &&
-        [sanitized characterAtIndex:0] == '1') {
-        sanitized = [sanitized substringFromIndex:1];
-    }
-    return sanitized;
+    if ([self isClientNumber])
+        return [self sanitizeNumber];
+    return PKTDigitsOnly(self, YES);
 }
 
 @end
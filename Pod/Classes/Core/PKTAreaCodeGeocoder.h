@@ -0,0 +1,41 @@
+#import <Foundation/Foundation.h>
+
+extern NSString *const PKTAreaCodeGeocoderErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTAreaCodeGeocoderError) {
+    PKTAreaCodeGeocoderErrorCorrupt = 1,
+    PKTAreaCodeGeocoderErrorIncompatibleVersion,
+};
+
+// Offline number -> city/state lookup. The database is a digit trie over
+// number prefixes (country code included, e.g. "1415" for San Francisco),
+// compiled ahead of time into one file that's memory-mapped when opened, so
+// opening costs an mmap and a lookup is one array step per digit with no
+// allocation until the strings are returned. The longest matching prefix
+// wins.
+//
+// Safe to use from any thread.
+@interface PKTAreaCodeGeocoder : NSObject
+
+@property (nonatomic, strong, readonly) NSString   *path;
+@property (nonatomic, assign, readonly) NSUInteger prefixCount;
+
+// prepended to numbers that don't start with "+" and don't already begin
+// with it; default "1"
+@property (nonatomic, copy) NSString *defaultCountryCode;
+
+// North American area codes to state, province or country, from the
+// database in the pod's resource bundle; nil if the bundle is missing.
+// Cities aren't known at this level, so city is always nil. Shared.
++ (instancetype)NANPGeocoder;
+
+// entries maps prefix digits to @[city, state]; either may be NSNull.
+// Scripts/compile_geocoder.py writes the same file from a CSV.
++ (BOOL)compileEntries:(NSDictionary *)entries toPath:(NSString *)path error:(NSError **)error;
+
+- (instancetype)initWithPath:(NSString *)path error:(NSError **)error;
+
+// NO for client names and numbers no prefix matches
+- (BOOL)getCity:(NSString **)city state:(NSString **)state forNumber:(NSString *)number;
+
+@end
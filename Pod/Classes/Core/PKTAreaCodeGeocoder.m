@@ -0,0 +1,333 @@
+#import "PKTAreaCodeGeocoder.h"
+#import "PKTNumberNormalizer.h"
+
+NSString *const PKTAreaCodeGeocoderErrorDomain = @"PKTAreaCodeGeocoderErrorDomain";
+
+static const uint32_t kPKTGeocoderMagic   = 0x504b5447; // "PKTG"
+static const uint16_t kPKTGeocoderVersion = 1;
+
+// file layout: header, nodes, locations, then the string table
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t nodeCount;
+    uint32_t locationCount;
+    uint32_t stringsSize;
+    uint32_t prefixCount;
+} PKTGeocoderHeader;
+
+// node 0 is the root; a node's children are stored together, in digit order,
+// starting at firstChild
+typedef struct {
+    uint16_t childMask;   // bit d set if digit d has a child
+    uint16_t reserved;
+    uint32_t location;    // 1-based index into the locations; 0 = none
+    uint32_t firstChild;
+} PKTGeocoderNode;
+
+// string table entries are a uint32_t byte count followed by UTF-8 bytes;
+// a string's id is its offset + 1, and 0 is nil
+typedef struct {
+    uint32_t city;
+    uint32_t state;
+} PKTGeocoderLocation;
+
+// the trie while compiling: every node with all ten child slots
+typedef struct {
+    int32_t  children[10];
+    uint32_t location;
+} PKTGeocoderBuildNode;
+
+@interface PKTAreaCodeGeocoder ()
+
+@property (nonatomic, strong) NSData  *data;
+@property (nonatomic, strong) NSCache *locations;  // location index -> @[city, state]
+
+@end
+
+@implementation PKTAreaCodeGeocoder
+{
+    const PKTGeocoderNode     *_nodes;
+    uint32_t                  _nodeCount;
+    const PKTGeocoderLocation *_locationTable;
+    uint32_t                  _locationCount;
+    const uint8_t             *_strings;
+    uint32_t                  _stringsSize;
+}
+
+#pragma mark - Shipped Database
+
++ (instancetype)NANPGeocoder
+{
+    static PKTAreaCodeGeocoder *geocoder = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // the pod's resource bundle, or the app's own if it copied the file in
+        NSURL *bundleURL = [[NSBundle bundleForClass:self] URLForResource:@"PhoneKit" withExtension:@"bundle"];
+        NSBundle *bundle = bundleURL ? [NSBundle bundleWithURL:bundleURL] : [NSBundle mainBundle];
+        NSString *path   = [bundle pathForResource:@"PKTNANPAreaCodes" ofType:@"geo"];
+        if (path)
+            geocoder = [[PKTAreaCodeGeocoder alloc] initWithPath:path error:NULL];
+    });
+    return geocoder;
+}
+
+#pragma mark - Compiling
+
++ (BOOL)compileEntries:(NSDictionary *)entries toPath:(NSString *)path error:(NSError **)error
+{
+    NSMutableData *buildNodes = [NSMutableData dataWithLength:sizeof(PKTGeocoderBuildNode)];
+    memset(buildNodes.mutableBytes, 0xff, sizeof(int32_t) * 10);
+    ((PKTGeocoderBuildNode *)buildNodes.mutableBytes)->location = 0;
+
+    NSMutableData *strings           = [NSMutableData data];
+    NSMutableDictionary *stringIds   = [NSMutableDictionary dictionary];
+    NSMutableData *locations         = [NSMutableData data];
+    NSMutableDictionary *locationIds = [NSMutableDictionary dictionary];
+
+    uint32_t (^internString)(id) = ^uint32_t(id string) {
+        if (![string isKindOfClass:[NSString class]] || ![string length])
+            return 0;
+        NSNumber *existing = stringIds[string];
+        if (existing)
+            return [existing unsignedIntValue];
+
+        NSData *utf8    = [string dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t length = (uint32_t)utf8.length;
+        uint32_t sid    = (uint32_t)strings.length + 1;
+        [strings appendBytes:&length length:sizeof(length)];
+        [strings appendData:utf8];
+        stringIds[string] = @(sid);
+        return sid;
+    };
+
+    uint32_t prefixCount = 0;
+    for (NSString *prefix in entries) {
+        NSArray *value = entries[prefix];
+        if (![prefix isKindOfClass:[NSString class]] || ![value isKindOfClass:[NSArray class]] || value.count < 2)
+            continue;
+
+        PKTGeocoderLocation location = {internString(value[0]), internString(value[1])};
+        NSData *locationKey = [NSData dataWithBytes:&location length:sizeof(location)];
+        NSNumber *locationId = locationIds[locationKey];
+        if (!locationId) {
+            [locations appendData:locationKey];
+            locationId = @(locations.length / sizeof(PKTGeocoderLocation));
+            locationIds[locationKey] = locationId;
+        }
+
+        int32_t node = 0;
+        BOOL valid   = prefix.length > 0;
+        for (NSUInteger i = 0; i < prefix.length && valid; i++) {
+            int digit = PKTDigitValue([prefix characterAtIndex:i]);
+            if (digit < 0) {
+                valid = NO;
+                break;
+            }
+            int32_t child = ((PKTGeocoderBuildNode *)buildNodes.mutableBytes)[node].children[digit];
+            if (child < 0) {
+                child = (int32_t)(buildNodes.length / sizeof(PKTGeocoderBuildNode));
+                [buildNodes increaseLengthBy:sizeof(PKTGeocoderBuildNode)];
+                PKTGeocoderBuildNode *fresh = (PKTGeocoderBuildNode *)buildNodes.mutableBytes + child;
+                memset(fresh->children, 0xff, sizeof(fresh->children));
+                fresh->location = 0;
+                ((PKTGeocoderBuildNode *)buildNodes.mutableBytes)[node].children[digit] = child;
+            }
+            node = child;
+        }
+        if (!valid)
+            continue;
+
+        PKTGeocoderBuildNode *target = (PKTGeocoderBuildNode *)buildNodes.mutableBytes + node;
+        if (!target->location)
+            prefixCount++;
+        target->location = [locationId unsignedIntValue];
+    }
+
+    // lay the nodes out breadth-first so each node's children are adjacent
+    const PKTGeocoderBuildNode *build = buildNodes.bytes;
+    uint32_t nodeCount = (uint32_t)(buildNodes.length / sizeof(PKTGeocoderBuildNode));
+    int32_t *order     = malloc(nodeCount * sizeof(int32_t));
+    PKTGeocoderNode *nodes = calloc(nodeCount, sizeof(PKTGeocoderNode));
+    uint32_t queued    = 1;
+    order[0]           = 0;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const PKTGeocoderBuildNode *source = build + order[i];
+        nodes[i].location   = source->location;
+        nodes[i].firstChild = queued;
+        for (int d = 0; d < 10; d++) {
+            if (source->children[d] >= 0) {
+                nodes[i].childMask |= 1 << d;
+                order[queued++] = source->children[d];
+            }
+        }
+    }
+
+    PKTGeocoderHeader header = {0};
+    header.magic         = kPKTGeocoderMagic;
+    header.version       = kPKTGeocoderVersion;
+    header.nodeCount     = nodeCount;
+    header.locationCount = (uint32_t)(locations.length / sizeof(PKTGeocoderLocation));
+    header.stringsSize   = (uint32_t)strings.length;
+    header.prefixCount   = prefixCount;
+
+    NSMutableData *file = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    [file appendBytes:nodes length:nodeCount * sizeof(PKTGeocoderNode)];
+    [file appendData:locations];
+    [file appendData:strings];
+    free(nodes);
+    free(order);
+
+    return [file writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+#pragma mark - Lookup
+
+- (instancetype)initWithPath:(NSString *)path error:(NSError **)error
+{
+    if (self = [super init]) {
+        _path               = [path copy];
+        _defaultCountryCode = @"1";
+        _locations          = [NSCache new];
+        _data               = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:error];
+        if (!_data || ![self validate:error])
+            return nil;
+    }
+    return self;
+}
+
+- (BOOL)validate:(NSError **)error
+{
+    PKTGeocoderHeader header;
+    if (self.data.length < sizeof(header)) {
+        if (error) *error = [NSError errorWithDomain:PKTAreaCodeGeocoderErrorDomain code:PKTAreaCodeGeocoderErrorCorrupt userInfo:nil];
+        return NO;
+    }
+    memcpy(&header, self.data.bytes, sizeof(header));
+    if (header.magic != kPKTGeocoderMagic) {
+        if (error) *error = [NSError errorWithDomain:PKTAreaCodeGeocoderErrorDomain code:PKTAreaCodeGeocoderErrorCorrupt userInfo:nil];
+        return NO;
+    }
+    if (header.version != kPKTGeocoderVersion) {
+        if (error) *error = [NSError errorWithDomain:PKTAreaCodeGeocoderErrorDomain code:PKTAreaCodeGeocoderErrorIncompatibleVersion userInfo:nil];
+        return NO;
+    }
+
+    uint64_t expected = sizeof(header) + (uint64_t)header.nodeCount * sizeof(PKTGeocoderNode) +
+                        (uint64_t)header.locationCount * sizeof(PKTGeocoderLocation) + header.stringsSize;
+    if (!header.nodeCount || expected != self.data.length) {
+        if (error) *error = [NSError errorWithDomain:PKTAreaCodeGeocoderErrorDomain code:PKTAreaCodeGeocoderErrorCorrupt userInfo:nil];
+        return NO;
+    }
+
+    const uint8_t *bytes = self.data.bytes;
+    _nodes         = (const PKTGeocoderNode *)(bytes + sizeof(header));
+    _nodeCount     = header.nodeCount;
+    _locationTable = (const PKTGeocoderLocation *)(_nodes + _nodeCount);
+    _locationCount = header.locationCount;
+    _strings       = (const uint8_t *)(_locationTable + _locationCount);
+    _stringsSize   = header.stringsSize;
+    _prefixCount   = header.prefixCount;
+    return YES;
+}
+
+- (BOOL)getCity:(NSString **)city state:(NSString **)state forNumber:(NSString *)number
+{
+    if (!number.length)
+        return NO;
+
+    PKTCharacterBuffer chars;
+    PKTCharacterBufferInit(&chars, number);
+    uint32_t location = 0;
+    if (!PKTCharactersAreClientNumber(chars.characters, chars.length)) {
+        NSUInteger start = 0;
+        while (start < chars.length && chars.characters[start] == ' ')
+            start++;
+        BOOL international = start < chars.length && chars.characters[start] == '+';
+
+        uint32_t node = 0;
+        BOOL walking  = YES;
+        if (!international && ![self digits:chars.characters length:chars.length beginWith:self.defaultCountryCode]) {
+            for (NSUInteger i = 0; i < self.defaultCountryCode.length && walking; i++) {
+                walking = [self step:&node digit:PKTDigitValue([self.defaultCountryCode characterAtIndex:i]) location:&location];
+            }
+        }
+        for (NSUInteger i = start; i < chars.length && walking; i++) {
+            int digit = PKTDigitValue(chars.characters[i]);
+            if (digit >= 0)
+                walking = [self step:&node digit:digit location:&location];
+        }
+    }
+    PKTCharacterBufferRelease(&chars);
+
+    if (!location)
+        return NO;
+
+    NSArray *names = [self namesForLocation:location];
+    if (city)  *city  = names[0] == [NSNull null] ? nil : names[0];
+    if (state) *state = names[1] == [NSNull null] ? nil : names[1];
+    return YES;
+}
+
+#pragma mark - Helpers
+
+// moves node down one digit, noting any location passed; NO at a dead end
+- (BOOL)step:(uint32_t *)node digit:(int)digit location:(uint32_t *)location
+{
+    if (digit < 0)
+        return YES;
+
+    const PKTGeocoderNode *current = &_nodes[*node];
+    if (!(current->childMask & (1 << digit)))
+        return NO;
+
+    uint32_t child = current->firstChild + __builtin_popcount(current->childMask & ((1 << digit) - 1));
+    if (child >= _nodeCount)
+        return NO;
+
+    *node = child;
+    if (_nodes[child].location)
+        *location = _nodes[child].location;
+    return YES;
+}
+
+- (BOOL)digits:(const unichar *)chars length:(NSUInteger)length beginWith:(NSString *)prefix
+{
+    NSUInteger matched = 0;
+    for (NSUInteger i = 0; i < length && matched < prefix.length; i++) {
+        int digit = PKTDigitValue(chars[i]);
+        if (digit < 0)
+            continue;
+        if (digit != PKTDigitValue([prefix characterAtIndex:matched]))
+            return NO;
+        matched++;
+    }
+    return matched == prefix.length;
+}
+
+- (NSArray *)namesForLocation:(uint32_t)location
+{
+    NSArray *names = [self.locations objectForKey:@(location)];
+    if (!names) {
+        const PKTGeocoderLocation *entry = location <= _locationCount ? &_locationTable[location - 1] : NULL;
+        names = @[[self stringWithId:entry ? entry->city : 0] ?: [NSNull null],
+                  [self stringWithId:entry ? entry->state : 0] ?: [NSNull null]];
+        [self.locations setObject:names forKey:@(location)];
+    }
+    return names;
+}
+
+- (NSString *)stringWithId:(uint32_t)sid
+{
+    if (!sid || (uint64_t)sid - 1 + sizeof(uint32_t) > _stringsSize)
+        return nil;
+
+    uint32_t length;
+    memcpy(&length, _strings + sid - 1, sizeof(length));
+    if ((uint64_t)sid - 1 + sizeof(length) + length > _stringsSize)
+        return nil;
+    return [[NSString alloc] initWithBytes:_strings + sid - 1 + sizeof(length) length:length encoding:NSUTF8StringEncoding];
+}
+
+@end
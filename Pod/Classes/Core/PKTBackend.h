@@ -0,0 +1,43 @@
+#import <Foundation/Foundation.h>
+#import "TwilioClient.h"
+
+// The slice of TwilioSDK's TCDevice and TCConnection that PhoneKit uses.
+// PKTPhone talks to its device and connections only through these, so a
+// different backend (such as PKTFakeDevice in the Testing subspec) can stand
+// in for TwilioSDK. Backends report events by calling the TCDeviceDelegate and
+// TCConnectionDelegate methods, passing themselves as the device/connection.
+
+@protocol PKTConnection <NSObject>
+
+@property (nonatomic, readonly) TCConnectionState state;
+@property (nonatomic, readonly, getter=isIncoming) BOOL incoming;
+@property (nonatomic, readonly) NSDictionary *parameters;
+@property (nonatomic, weak) id<TCConnectionDelegate> delegate;
+@property (nonatomic, getter=isMuted) BOOL muted;
+
+- (void)accept;
+- (void)ignore;
+- (void)reject;
+- (void)disconnect;
+- (void)sendDigits:(NSString *)digits;
+
+@end
+
+@protocol PKTDevice <NSObject>
+
+@property (nonatomic, readonly) TCDeviceState state;
+@property (nonatomic, readonly) NSDictionary *capabilities;
+@property (nonatomic, weak) id<TCDeviceDelegate> delegate;
+
+- (void)updateCapabilityToken:(NSString *)capabilityToken;
+- (id<PKTConnection>)connect:(NSDictionary *)parameters delegate:(id<TCConnectionDelegate>)delegate;
+- (void)disconnectAll;
+
+@end
+
+// TwilioSDK's own classes already implement both protocols.
+@interface TCConnection (PKTBackend) <PKTConnection>
+@end
+
+@interface TCDevice (PKTBackend) <PKTDevice>
+@end
@@ -0,0 +1,7 @@
+#import "PKTBackend.h"
+
+@implementation TCConnection (PKTBackend)
+@end
+
+@implementation TCDevice (PKTBackend)
+@end
@@ -0,0 +1,38 @@
+#import <Foundation/Foundation.h>
+#import "PKTCallRecord.h"
+
+extern NSString *const PKTCallHistoryErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTCallHistoryError) {
+    PKTCallHistoryErrorCorrupt = 1,
+    PKTCallHistoryErrorIncompatibleVersion,
+};
+
+// A persistent, append-only call log. Records are stored as fixed-width
+// entries in one file, with numbers, cities and states interned into a
+// second string table; both are memory-mapped for reading, so opening a
+// large history costs a couple of mmaps and a hop over the string lengths,
+// and records are only inflated into PKTCallRecords a page at a time.
+//
+// Index 0 is the oldest record. Safe to use from any thread.
+@interface PKTCallHistory : NSObject
+
+@property (nonatomic, strong, readonly) NSString   *path;
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+// path is a directory, created if needed
+- (instancetype)initWithPath:(NSString *)path error:(NSError **)error;
+
+- (BOOL)appendRecord:(PKTCallRecord *)record error:(NSError **)error;
+- (BOOL)removeAllRecords:(NSError **)error;
+
+- (PKTCallRecord *)recordAtIndex:(NSUInteger)index;
+
+// newest first: offset 0 is the most recent call
+- (NSArray *)recentRecordsFromOffset:(NSUInteger)offset limit:(NSUInteger)limit;
+
+// calls with the given number (compared after sanitizeNumber), newest first
+- (NSArray *)recentRecordsForNumber:(NSString *)number limit:(NSUInteger)limit;
+- (NSUInteger)countOfRecordsForNumber:(NSString *)number;
+
+@end
@@ -0,0 +1,534 @@
+#import "PKTCallHistory.h"
+#import "NSString+PKTHelpers.h"
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+NSString *const PKTCallHistoryErrorDomain = @"PKTCallHistoryErrorDomain";
+
+static NSString *const kPKTCallHistoryRecordsFile = @"records.bin";
+static NSString *const kPKTCallHistoryStringsFile = @"strings.bin";
+
+static const uint32_t kPKTCallHistoryMagic   = 0x504b5448; // "PKTH"
+static const uint16_t kPKTCallHistoryVersion = 1;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    uint8_t  reserved[8];
+} PKTCallHistoryHeader;
+
+// one fixed-width record; strings are ids into the string table (0 = nil)
+typedef struct {
+    double   startTime;  // seconds since 1970
+    double   duration;
+    uint32_t number;
+    uint32_t numberKey;  // sanitized number, for per-number lookups
+    uint32_t city;
+    uint32_t state;
+    uint8_t  flags;
+    uint8_t  reserved[7];
+} PKTCallHistoryEntry;
+
+enum {
+    PKTCallHistoryEntryIncoming = 1 << 0,
+    PKTCallHistoryEntryMissed   = 1 << 1,
+};
+
+// string table entries are a uint32_t byte count followed by UTF-8 bytes;
+// a string's id is its offset + 1
+typedef uint32_t PKTStringLength;
+
+#pragma mark - Mapped Files
+
+typedef struct {
+    int          fd;
+    size_t       size;      // valid bytes on disk
+    const void   *bytes;
+    size_t       mappedSize;
+} PKTMappedFile;
+
+static NSError *PKTPOSIXError(void)
+{
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+}
+
+static BOOL PKTMappedFileOpen(PKTMappedFile *file, NSString *path, NSError **error)
+{
+    file->fd = open([path fileSystemRepresentation], O_RDWR | O_CREAT | O_APPEND, 0644);
+    struct stat info;
+    if (file->fd < 0 || fstat(file->fd, &info) != 0) {
+        if (error) *error = PKTPOSIXError();
+        return NO;
+    }
+    file->size = (size_t)info.st_size;
+    return YES;
+}
+
+// extends the read mapping to cover everything written so far. The mapping
+// reserves room past the end of the file, so appends that fit are visible
+// through it as they're written and only outgrowing it costs a remap.
+// Nothing past size is ever read, so a mapping that outlives a truncate is fine.
+static BOOL PKTMappedFileMap(PKTMappedFile *file)
+{
+    if (file->size <= file->mappedSize)
+        return YES;
+    if (file->bytes)
+        munmap((void *)file->bytes, file->mappedSize);
+    file->bytes      = NULL;
+    file->mappedSize = 0;
+
+    size_t page       = (size_t)getpagesize();
+    size_t mappedSize = MAX(file->size + file->size / 2, 16 * page);
+    mappedSize        = (mappedSize + page - 1) / page * page;
+
+    void *bytes = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, file->fd, 0);
+    if (bytes == MAP_FAILED)
+        return NO;
+    file->bytes      = bytes;
+    file->mappedSize = mappedSize;
+    return YES;
+}
+
+static BOOL PKTMappedFileAppend(PKTMappedFile *file, const void *bytes, size_t length, NSError **error)
+{
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = write(file->fd, (const char *)bytes + written, length - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            if (error) *error = PKTPOSIXError();
+            ftruncate(file->fd, file->size); // don't leave a torn entry behind
+            return NO;
+        }
+        written += n;
+    }
+    file->size += length;
+    return YES;
+}
+
+static BOOL PKTMappedFileTruncate(PKTMappedFile *file, size_t size)
+{
+    if (ftruncate(file->fd, size) != 0)
+        return NO;
+    file->size = size;
+    return YES;
+}
+
+static void PKTMappedFileClose(PKTMappedFile *file)
+{
+    if (file->bytes)
+        munmap((void *)file->bytes, file->mappedSize);
+    if (file->fd >= 0)
+        close(file->fd);
+    file->fd    = -1;
+    file->bytes = NULL;
+}
+
+#pragma mark - String Index
+
+// open-addressed set of string ids keyed by a hash of their UTF-8 bytes, so
+// interning compares bytes against the mapped table instead of decoding it
+typedef struct {
+    uint32_t *ids;       // 0 = empty slot
+    uint32_t *hashes;
+    size_t   capacity;   // a power of two
+    size_t   count;
+} PKTStringIndex;
+
+static uint32_t PKTStringHash(const void *bytes, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ ((const uint8_t *)bytes)[i]) * 16777619u;
+    return hash;
+}
+
+static void PKTStringIndexFree(PKTStringIndex *index)
+{
+    free(index->ids);
+    free(index->hashes);
+    memset(index, 0, sizeof(*index));
+}
+
+static BOOL PKTStringIndexResize(PKTStringIndex *index, size_t capacity)
+{
+    uint32_t *ids    = calloc(capacity, sizeof(uint32_t));
+    uint32_t *hashes = malloc(capacity * sizeof(uint32_t));
+    if (!ids || !hashes) {
+        free(ids);
+        free(hashes);
+        return NO;
+    }
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (!index->ids[i])
+            continue;
+        size_t slot = index->hashes[i] & (capacity - 1);
+        while (ids[slot])
+            slot = (slot + 1) & (capacity - 1);
+        ids[slot]    = index->ids[i];
+        hashes[slot] = index->hashes[i];
+    }
+    free(index->ids);
+    free(index->hashes);
+    index->ids      = ids;
+    index->hashes   = hashes;
+    index->capacity = capacity;
+    return YES;
+}
+
+static BOOL PKTStringIndexInsert(PKTStringIndex *index, uint32_t hash, uint32_t stringId)
+{
+    if ((index->count + 1) * 2 > index->capacity &&
+        !PKTStringIndexResize(index, index->capacity ? index->capacity * 2 : 64))
+        return NO;
+
+    size_t slot = hash & (index->capacity - 1);
+    while (index->ids[slot])
+        slot = (slot + 1) & (index->capacity - 1);
+    index->ids[slot]    = stringId;
+    index->hashes[slot] = hash;
+    index->count++;
+    return YES;
+}
+
+#pragma mark -
+
+@interface PKTCallHistory () {
+    PKTMappedFile  _records;
+    PKTMappedFile  _strings;
+    PKTStringIndex _stringIndex;  // built on first use
+}
+
+@property (nonatomic, strong) NSCache             *decodedStrings; // id -> NSString
+@property (nonatomic, strong) NSMutableDictionary *numberIndex;    // numberKey id -> NSMutableIndexSet, built on first use
+
+@end
+
+@implementation PKTCallHistory
+
+- (instancetype)initWithPath:(NSString *)path error:(NSError **)error
+{
+    if (self = [super init]) {
+        _path           = [path copy];
+        _records.fd     = _strings.fd = -1;
+        _decodedStrings = [NSCache new];
+
+        if (![[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:error] ||
+            !PKTMappedFileOpen(&_records, [path stringByAppendingPathComponent:kPKTCallHistoryRecordsFile], error) ||
+            !PKTMappedFileOpen(&_strings, [path stringByAppendingPathComponent:kPKTCallHistoryStringsFile], error) ||
+            ![self validateRecords:error] ||
+            ![self validateStrings:error]) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    PKTMappedFileClose(&_records);
+    PKTMappedFileClose(&_strings);
+    PKTStringIndexFree(&_stringIndex);
+}
+
+- (BOOL)validateRecords:(NSError **)error
+{
+    PKTCallHistoryHeader header = {0};
+    if (_records.size == 0) {
+        header.magic     = kPKTCallHistoryMagic;
+        header.version   = kPKTCallHistoryVersion;
+        header.entrySize = sizeof(PKTCallHistoryEntry);
+        return PKTMappedFileAppend(&_records, &header, sizeof(header), error);
+    }
+
+    if (_records.size < sizeof(header) || pread(_records.fd, &header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != kPKTCallHistoryMagic) {
+        if (error) *error = [NSError errorWithDomain:PKTCallHistoryErrorDomain code:PKTCallHistoryErrorCorrupt userInfo:nil];
+        return NO;
+    }
+    if (header.version != kPKTCallHistoryVersion || header.entrySize != sizeof(PKTCallHistoryEntry)) {
+        if (error) *error = [NSError errorWithDomain:PKTCallHistoryErrorDomain code:PKTCallHistoryErrorIncompatibleVersion userInfo:nil];
+        return NO;
+    }
+
+    // drop a record torn by a crash mid-append
+    size_t whole = sizeof(header) + (_records.size - sizeof(header)) / sizeof(PKTCallHistoryEntry) * sizeof(PKTCallHistoryEntry);
+    if (whole != _records.size && !PKTMappedFileTruncate(&_records, whole)) {
+        if (error) *error = PKTPOSIXError();
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)validateStrings:(NSError **)error
+{
+    if (!PKTMappedFileMap(&_strings)) {
+        if (error) *error = PKTPOSIXError();
+        return NO;
+    }
+
+    // hop over the length prefixes only; nothing is decoded until it's read
+    size_t offset = 0;
+    while (offset + sizeof(PKTStringLength) <= _strings.size) {
+        PKTStringLength length;
+        memcpy(&length, (const char *)_strings.bytes + offset, sizeof(length));
+        if (offset + sizeof(length) + length > _strings.size)
+            break;
+        offset += sizeof(length) + length;
+    }
+    if (offset != _strings.size && !PKTMappedFileTruncate(&_strings, offset)) {
+        if (error) *error = PKTPOSIXError();
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark - Strings
+
+- (NSString *)stringForId:(uint32_t)stringId
+{
+    if (!stringId)
+        return nil;
+
+    NSString *string = [self.decodedStrings objectForKey:@(stringId)];
+    if (string)
+        return string;
+
+    size_t offset = stringId - 1;
+    if (offset + sizeof(PKTStringLength) > _strings.size || !PKTMappedFileMap(&_strings))
+        return nil;
+
+    PKTStringLength length;
+    memcpy(&length, (const char *)_strings.bytes + offset, sizeof(length));
+    string = [[NSString alloc] initWithBytes:(const char *)_strings.bytes + offset + sizeof(length)
+                                      length:length
+                                    encoding:NSUTF8StringEncoding];
+    if (string)
+        [self.decodedStrings setObject:string forKey:@(stringId)];
+    return string;
+}
+
+// one pass over the length prefixes, hashing bytes in place; nothing is decoded
+- (BOOL)buildStringIndex
+{
+    if (_stringIndex.ids)
+        return YES;
+    if (!PKTMappedFileMap(&_strings) || !PKTStringIndexResize(&_stringIndex, 64))
+        return NO;
+
+    size_t offset = 0;
+    while (offset < _strings.size) {
+        PKTStringLength length;
+        memcpy(&length, (const char *)_strings.bytes + offset, sizeof(length));
+        uint32_t hash = PKTStringHash((const char *)_strings.bytes + offset + sizeof(length), length);
+        if (!PKTStringIndexInsert(&_stringIndex, hash, (uint32_t)offset + 1)) {
+            PKTStringIndexFree(&_stringIndex);
+            return NO;
+        }
+        offset += sizeof(length) + length;
+    }
+    return YES;
+}
+
+// the id of the string with these UTF-8 bytes, or 0 if it isn't in the table
+- (uint32_t)idForBytes:(const void *)bytes length:(PKTStringLength)length hash:(uint32_t)hash
+{
+    if (![self buildStringIndex])
+        return 0;
+
+    for (size_t slot = hash & (_stringIndex.capacity - 1); _stringIndex.ids[slot];
+         slot = (slot + 1) & (_stringIndex.capacity - 1)) {
+        if (_stringIndex.hashes[slot] != hash)
+            continue;
+
+        size_t offset = _stringIndex.ids[slot] - 1;
+        // strings appended past the end of the mapping are only mapped once one is compared
+        if (offset + sizeof(PKTStringLength) + length > _strings.mappedSize && !PKTMappedFileMap(&_strings))
+            return 0;
+
+        PKTStringLength candidate;
+        memcpy(&candidate, (const char *)_strings.bytes + offset, sizeof(candidate));
+        if (candidate == length && memcmp((const char *)_strings.bytes + offset + sizeof(candidate), bytes, length) == 0)
+            return _stringIndex.ids[slot];
+    }
+    return 0;
+}
+
+- (uint32_t)idForString:(NSString *)string
+{
+    NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+    return utf8 ? [self idForBytes:utf8.bytes length:(PKTStringLength)utf8.length hash:PKTStringHash(utf8.bytes, utf8.length)] : 0;
+}
+
+- (uint32_t)internString:(NSString *)string error:(NSError **)error
+{
+    if (!string)
+        return 0;
+
+    NSData *utf8            = [string dataUsingEncoding:NSUTF8StringEncoding];
+    PKTStringLength length  = (PKTStringLength)utf8.length;
+    uint32_t hash           = PKTStringHash(utf8.bytes, length);
+    uint32_t existing       = [self idForBytes:utf8.bytes length:length hash:hash];
+    if (existing)
+        return existing;
+
+    NSMutableData *entry    = [NSMutableData dataWithBytes:&length length:sizeof(length)];
+    [entry appendData:utf8];
+
+    uint32_t stringId = (uint32_t)_strings.size + 1;
+    if (!PKTMappedFileAppend(&_strings, entry.bytes, entry.length, error))
+        return UINT32_MAX;
+
+    if (_stringIndex.ids && !PKTStringIndexInsert(&_stringIndex, hash, stringId))
+        PKTStringIndexFree(&_stringIndex); // rebuilt from the table on next use
+    return stringId;
+}
+
+#pragma mark - Records
+
+- (NSUInteger)count
+{
+    @synchronized(self) {
+        return (_records.size - sizeof(PKTCallHistoryHeader)) / sizeof(PKTCallHistoryEntry);
+    }
+}
+
+- (const PKTCallHistoryEntry *)entryAtIndex:(NSUInteger)index
+{
+    if (!PKTMappedFileMap(&_records))
+        return NULL;
+    return (const PKTCallHistoryEntry *)((const char *)_records.bytes + sizeof(PKTCallHistoryHeader)) + index;
+}
+
+- (PKTCallRecord *)recordForEntry:(const PKTCallHistoryEntry *)entry
+{
+    PKTCallRecord *record = [PKTCallRecord new];
+    record.incoming  = (entry->flags & PKTCallHistoryEntryIncoming) != 0;
+    record.missed    = (entry->flags & PKTCallHistoryEntryMissed) != 0;
+    record.startTime = [NSDate dateWithTimeIntervalSince1970:entry->startTime];
+    record.duration  = entry->duration;
+    record.number    = [self stringForId:entry->number];
+    record.city      = [self stringForId:entry->city];
+    record.state     = [self stringForId:entry->state];
+    return record;
+}
+
+- (BOOL)appendRecord:(PKTCallRecord *)record error:(NSError **)error
+{
+    @synchronized(self) {
+        PKTCallHistoryEntry entry = {0};
+        entry.startTime = [record.startTime timeIntervalSince1970];
+        entry.duration  = record.duration;
+        entry.flags     = (record.incoming ? PKTCallHistoryEntryIncoming : 0) |
+                          (record.missed   ? PKTCallHistoryEntryMissed   : 0);
+        entry.number    = [self internString:record.number error:error];
+        entry.numberKey = [self internString:[record.number sanitizeNumber] error:error];
+        entry.city      = [self internString:record.city error:error];
+        entry.state     = [self internString:record.state error:error];
+        if (entry.number == UINT32_MAX || entry.numberKey == UINT32_MAX ||
+            entry.city == UINT32_MAX || entry.state == UINT32_MAX)
+            return NO;
+
+        NSUInteger index = self.count;
+        if (!PKTMappedFileAppend(&_records, &entry, sizeof(entry), error))
+            return NO;
+
+        if (_numberIndex && entry.numberKey)
+            [[self indexesForNumberKey:entry.numberKey create:YES] addIndex:index];
+        return YES;
+    }
+}
+
+- (BOOL)removeAllRecords:(NSError **)error
+{
+    @synchronized(self) {
+        if (!PKTMappedFileTruncate(&_records, sizeof(PKTCallHistoryHeader)) ||
+            !PKTMappedFileTruncate(&_strings, 0)) {
+            if (error) *error = PKTPOSIXError();
+            return NO;
+        }
+        [self.decodedStrings removeAllObjects];
+        PKTStringIndexFree(&_stringIndex);
+        self.numberIndex = nil;
+        return YES;
+    }
+}
+
+- (PKTCallRecord *)recordAtIndex:(NSUInteger)index
+{
+    @synchronized(self) {
+        if (index >= self.count)
+            return nil;
+        const PKTCallHistoryEntry *entry = [self entryAtIndex:index];
+        return entry ? [self recordForEntry:entry] : nil;
+    }
+}
+
+- (NSArray *)recentRecordsFromOffset:(NSUInteger)offset limit:(NSUInteger)limit
+{
+    @synchronized(self) {
+        NSUInteger count = self.count;
+        NSMutableArray *records = [NSMutableArray arrayWithCapacity:MIN(limit, count)];
+        for (NSUInteger i = offset; i < count && records.count < limit; i++) {
+            const PKTCallHistoryEntry *entry = [self entryAtIndex:count - 1 - i];
+            if (!entry)
+                break;
+            [records addObject:[self recordForEntry:entry]];
+        }
+        return records;
+    }
+}
+
+#pragma mark - Per-Number Index
+
+- (NSMutableIndexSet *)indexesForNumberKey:(uint32_t)numberKey create:(BOOL)create
+{
+    if (!_numberIndex) {
+        // one pass over the mapped entries; only ids are compared
+        _numberIndex     = [NSMutableDictionary dictionary];
+        NSUInteger count = self.count;
+        const PKTCallHistoryEntry *entries = count ? [self entryAtIndex:0] : NULL;
+        for (NSUInteger i = 0; entries && i < count; i++) {
+            if (!entries[i].numberKey)
+                continue;
+            NSNumber *key = @(entries[i].numberKey);
+            NSMutableIndexSet *indexes = _numberIndex[key] ?: (_numberIndex[key] = [NSMutableIndexSet indexSet]);
+            [indexes addIndex:i];
+        }
+    }
+    NSMutableIndexSet *indexes = _numberIndex[@(numberKey)];
+    if (!indexes && create)
+        indexes = _numberIndex[@(numberKey)] = [NSMutableIndexSet indexSet];
+    return indexes;
+}
+
+- (NSIndexSet *)indexesForNumber:(NSString *)number
+{
+    uint32_t numberKey = number ? [self idForString:[number sanitizeNumber]] : 0;
+    return numberKey ? [self indexesForNumberKey:numberKey create:NO] : nil;
+}
+
+- (NSArray *)recentRecordsForNumber:(NSString *)number limit:(NSUInteger)limit
+{
+    @synchronized(self) {
+        NSMutableArray *records = [NSMutableArray array];
+        [[self indexesForNumber:number] enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger i, BOOL *stop) {
+            [records addObject:[self recordForEntry:[self entryAtIndex:i]]];
+            *stop = records.count >= limit;
+        }];
+        return records;
+    }
+}
+
+- (NSUInteger)countOfRecordsForNumber:(NSString *)number
+{
+    @synchronized(self) {
+        return [self indexesForNumber:number].count;
+    }
+}
+
+@end
@@ -0,0 +1,57 @@
+#import <Foundation/Foundation.h>
+#import "PKTLatencyHistogram.h"
+
+// timeline events, in the order a call usually reaches them
+extern NSString *const PKTCallEventConnectIssued;   // -[PKTPhone call:withParams:]
+extern NSString *const PKTCallEventRinging;         // incoming connection received
+extern NSString *const PKTCallEventResponded;       // -[PKTPhone respondToIncomingCall:...]
+extern NSString *const PKTCallEventConnecting;
+extern NSString *const PKTCallEventConnected;
+extern NSString *const PKTCallEventFirstDigits;     // first sendDigits: on the call
+extern NSString *const PKTCallEventDisconnected;
+
+// histogram spans
+extern NSString *const PKTCallSpanTokenReady;       // capability token set -> device ready
+extern NSString *const PKTCallSpanOutgoingSetup;    // connect issued -> connected
+extern NSString *const PKTCallSpanAnswer;           // ringing -> responded
+extern NSString *const PKTCallSpanIncomingSetup;    // responded -> connected
+extern NSString *const PKTCallSpanDelegateHop;      // delegate callback queued -> run on main
+
+// The events of one call, each stamped with PKTMonotonicTime() the first
+// time it happens.
+@interface PKTCallTimeline : NSObject
+
+@property (nonatomic, strong, readonly) NSArray *eventNames;  // in the order recorded
+
+// later recordings of an event already in the timeline are ignored
+- (void)recordEvent:(NSString *)name;
+- (void)recordEvent:(NSString *)name atTime:(NSTimeInterval)time;
+
+// 0 if the event hasn't happened
+- (NSTimeInterval)timeOfEvent:(NSString *)name;
+// negative if either event hasn't happened
+- (NSTimeInterval)intervalFromEvent:(NSString *)fromName toEvent:(NSString *)toName;
+
+@end
+
+// Latency instrumentation for PKTPhone. Disabled by default; while disabled,
+// calls get no timeline and each instrumentation point costs one BOOL check.
+@interface PKTCallMetrics : NSObject
+
+@property (nonatomic, assign, getter=isEnabled) BOOL enabled;
+
+// timelines of the most recent finished calls, oldest first
+@property (nonatomic, assign          ) NSUInteger recentTimelineLimit;  // default 20
+@property (nonatomic, strong, readonly) NSArray    *recentTimelines;
+
+// created on first use
+- (PKTLatencyHistogram *)histogramForSpan:(NSString *)span;
+- (NSTimeInterval)latencyForSpan:(NSString *)span percentile:(double)percentile;
+- (void)recordLatency:(NSTimeInterval)latency forSpan:(NSString *)span;
+
+// folds a finished call's spans into the histograms and keeps its timeline
+- (void)finishTimeline:(PKTCallTimeline *)timeline;
+
+- (void)reset;
+
+@end
@@ -0,0 +1,158 @@
+#import "PKTCallMetrics.h"
+#import "PKTCallSession.h"
+
+NSString *const PKTCallEventConnectIssued = @"connect-issued";
+NSString *const PKTCallEventRinging       = @"ringing";
+NSString *const PKTCallEventResponded     = @"responded";
+NSString *const PKTCallEventConnecting    = @"connecting";
+NSString *const PKTCallEventConnected     = @"connected";
+NSString *const PKTCallEventFirstDigits   = @"first-digits";
+NSString *const PKTCallEventDisconnected  = @"disconnected";
+
+NSString *const PKTCallSpanTokenReady     = @"token-ready";
+NSString *const PKTCallSpanOutgoingSetup  = @"outgoing-setup";
+NSString *const PKTCallSpanAnswer         = @"answer";
+NSString *const PKTCallSpanIncomingSetup  = @"incoming-setup";
+NSString *const PKTCallSpanDelegateHop    = @"delegate-hop";
+
+@interface PKTCallTimeline ()
+
+@property (nonatomic, strong) NSMutableArray      *names;
+@property (nonatomic, strong) NSMutableDictionary *timesByName;
+
+@end
+
+@implementation PKTCallTimeline
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _names       = [NSMutableArray array];
+        _timesByName = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSArray *)eventNames
+{
+    return [self.names copy];
+}
+
+- (void)recordEvent:(NSString *)name
+{
+    [self recordEvent:name atTime:PKTMonotonicTime()];
+}
+
+- (void)recordEvent:(NSString *)name atTime:(NSTimeInterval)time
+{
+    if (!name || self.timesByName[name])
+        return;
+
+    [self.names addObject:name];
+    self.timesByName[name] = @(time);
+}
+
+- (NSTimeInterval)timeOfEvent:(NSString *)name
+{
+    return [self.timesByName[name] doubleValue];
+}
+
+- (NSTimeInterval)intervalFromEvent:(NSString *)fromName toEvent:(NSString *)toName
+{
+    NSNumber *from = self.timesByName[fromName];
+    NSNumber *to   = self.timesByName[toName];
+    if (!from || !to)
+        return -1;
+    return [to doubleValue] - [from doubleValue];
+}
+
+- (NSString *)description
+{
+    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p", [self class], self];
+    NSTimeInterval start = [self timeOfEvent:[self.names firstObject]];
+    for (NSString *name in self.names) {
+        [description appendFormat:@" %@=+%.1fms", name, ([self timeOfEvent:name] - start) * 1000];
+    }
+    [description appendString:@">"];
+    return description;
+}
+
+@end
+
+@interface PKTCallMetrics ()
+
+@property (nonatomic, strong) NSMutableDictionary *histograms;
+@property (nonatomic, strong) NSMutableArray      *timelines;
+
+@end
+
+@implementation PKTCallMetrics
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _histograms          = [NSMutableDictionary dictionary];
+        _timelines           = [NSMutableArray array];
+        _recentTimelineLimit = 20;
+    }
+    return self;
+}
+
+- (NSArray *)recentTimelines
+{
+    @synchronized(self) {
+        return [self.timelines copy];
+    }
+}
+
+- (PKTLatencyHistogram *)histogramForSpan:(NSString *)span
+{
+    @synchronized(self) {
+        PKTLatencyHistogram *histogram = self.histograms[span];
+        if (!histogram) {
+            histogram = [PKTLatencyHistogram new];
+            self.histograms[span] = histogram;
+        }
+        return histogram;
+    }
+}
+
+- (NSTimeInterval)latencyForSpan:(NSString *)span percentile:(double)percentile
+{
+    return [[self histogramForSpan:span] valueAtPercentile:percentile];
+}
+
+- (void)recordLatency:(NSTimeInterval)latency forSpan:(NSString *)span
+{
+    if (self.enabled)
+        [[self histogramForSpan:span] recordValue:latency];
+}
+
+- (void)finishTimeline:(PKTCallTimeline *)timeline
+{
+    if (!timeline || !self.enabled)
+        return;
+
+    [self recordLatency:[timeline intervalFromEvent:PKTCallEventConnectIssued toEvent:PKTCallEventConnected]
+                forSpan:PKTCallSpanOutgoingSetup];
+    [self recordLatency:[timeline intervalFromEvent:PKTCallEventRinging toEvent:PKTCallEventResponded]
+                forSpan:PKTCallSpanAnswer];
+    [self recordLatency:[timeline intervalFromEvent:PKTCallEventResponded toEvent:PKTCallEventConnected]
+                forSpan:PKTCallSpanIncomingSetup];
+
+    @synchronized(self) {
+        [self.timelines addObject:timeline];
+        if (self.timelines.count > self.recentTimelineLimit)
+            [self.timelines removeObjectsInRange:NSMakeRange(0, self.timelines.count - self.recentTimelineLimit)];
+    }
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        [self.histograms removeAllObjects];
+        [self.timelines removeAllObjects];
+    }
+}
+
+@end
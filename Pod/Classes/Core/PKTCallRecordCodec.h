@@ -0,0 +1,63 @@
+#import <Foundation/Foundation.h>
+#import "PKTCallRecord.h"
+
+extern NSString *const PKTCallRecordCodecErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTCallRecordCodecError) {
+    PKTCallRecordCodecErrorCorrupt = 1,
+    PKTCallRecordCodecErrorIncompatibleVersion,
+    PKTCallRecordCodecErrorStreamFailed,  // the stream's own error, if any, is the underlying error
+};
+
+// Writes call records to a stream in a compact, versioned binary format:
+// a short header, then one record after another with no framing. Durations
+// are varint milliseconds, start times are epoch milliseconds stored as a
+// varint delta from the previous record, and numbers, cities and states are
+// dictionary-coded, with each string written out in full only the first time
+// the stream uses it. Records are written straight from their properties into
+// a small buffer that's flushed to the stream as it fills.
+//
+// Not thread-safe; use one encoder per stream.
+@interface PKTCallRecordEncoder : NSObject
+
+// opened if it isn't already; it's left open once encoding is finished
+- (instancetype)initWithOutputStream:(NSOutputStream *)stream;
+
+- (BOOL)encodeRecord:(PKTCallRecord *)record error:(NSError **)error;
+- (BOOL)encodeRecords:(id<NSFastEnumeration>)records error:(NSError **)error;
+// writes out anything still buffered; encoding more afterwards is fine
+- (BOOL)finish:(NSError **)error;
+
++ (NSData *)dataWithRecords:(NSArray *)records;
+
+@end
+
+// Reads records written by PKTCallRecordEncoder one at a time, pulling
+// from the stream only as much as it needs.
+@interface PKTCallRecordDecoder : NSObject
+
+// opened if it isn't already
+- (instancetype)initWithInputStream:(NSInputStream *)stream;
+- (instancetype)initWithData:(NSData *)data;
+
+// nil at the end of the stream, or with *error set if it can't be read
+- (PKTCallRecord *)decodeRecord:(NSError **)error;
+
++ (NSArray *)recordsWithData:(NSData *)data error:(NSError **)error;
+
+@end
+
+// Writes call records as JSON lines, one object per record, for backends
+// that don't take the binary format. Keys are the PKTCallRecord property
+// names; startTime is in seconds since 1970, and missing values, and
+// durations or times that aren't finite, are null.
+@interface PKTCallRecordJSONLinesWriter : NSObject
+
+// opened if it isn't already; it's left open once writing is finished
+- (instancetype)initWithOutputStream:(NSOutputStream *)stream;
+
+- (BOOL)writeRecord:(PKTCallRecord *)record error:(NSError **)error;
+- (BOOL)writeRecords:(id<NSFastEnumeration>)records error:(NSError **)error;
+- (BOOL)finish:(NSError **)error;
+
+@end
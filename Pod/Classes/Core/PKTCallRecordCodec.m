@@ -0,0 +1,551 @@
+#import "PKTCallRecordCodec.h"
+
+NSString *const PKTCallRecordCodecErrorDomain = @"PKTCallRecordCodecErrorDomain";
+
+static const uint8_t    kPKTCallRecordMagic[4]  = {'P', 'K', 'T', 'R'};
+static const uint8_t    kPKTCallRecordVersion   = 1;
+static const NSUInteger kPKTCallRecordChunkSize = 64 * 1024;  // buffered before a write, and per read
+
+// Each record is a flags byte, then
+//   startTime  zigzag varint: epoch milliseconds minus the previous record's
+//              (0 before the first); only if PKTCallRecordHasStartTime
+//   duration   varint milliseconds
+//   number, city, state
+//              varint string references: 0 is nil, 1 is a new string given
+//              as a varint byte count and UTF-8 bytes, which takes the next
+//              id, and id + 2 is a string given earlier in the stream
+enum {
+    PKTCallRecordIncoming     = 1 << 0,
+    PKTCallRecordMissed       = 1 << 1,
+    PKTCallRecordHasStartTime = 1 << 2,
+    PKTCallRecordKnownFlags   = (1 << 3) - 1,
+};
+
+enum {
+    PKTStringRefNil    = 0,
+    PKTStringRefNew    = 1,
+    PKTStringRefIdBase = 2,
+};
+
+static NSError *PKTCallRecordCodecError(PKTCallRecordCodecError code, NSError *underlyingError)
+{
+    return [NSError errorWithDomain:PKTCallRecordCodecErrorDomain
+                               code:code
+                           userInfo:underlyingError ? @{NSUnderlyingErrorKey: underlyingError} : nil];
+}
+
+static int64_t PKTMillisFromSeconds(NSTimeInterval seconds)
+{
+    return (int64_t)llround(seconds * 1000.0);
+}
+
+#pragma mark - Writing
+
+static void PKTAppendBytes(NSMutableData *buffer, const void *bytes, size_t length)
+{
+    [buffer appendBytes:bytes length:length];
+}
+
+static void PKTAppendVarint(NSMutableData *buffer, uint64_t value)
+{
+    uint8_t bytes[10];
+    size_t length = 0;
+    while (value >= 0x80) {
+        bytes[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+    PKTAppendBytes(buffer, bytes, length);
+}
+
+static uint64_t PKTZigZagEncode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t PKTZigZagDecode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void PKTOpenStream(NSStream *stream)
+{
+    if (stream.streamStatus == NSStreamStatusNotOpen)
+        [stream open];
+}
+
+// writes out and empties buffer
+static BOOL PKTFlushBuffer(NSMutableData *buffer, NSOutputStream *stream, NSError **error)
+{
+    const uint8_t *bytes = buffer.bytes;
+    NSUInteger written   = 0;
+    while (written < buffer.length) {
+        NSInteger n = [stream write:bytes + written maxLength:buffer.length - written];
+        if (n <= 0) {
+            if (error) *error = PKTCallRecordCodecError(PKTCallRecordCodecErrorStreamFailed, stream.streamError);
+            return NO;
+        }
+        written += n;
+    }
+    buffer.length = 0;
+    return YES;
+}
+
+#pragma mark - Reading
+
+typedef NS_ENUM(NSUInteger, PKTDecodeStatus) {
+    PKTDecodeOK,
+    PKTDecodeShort,    // ran out of bytes; read more and try again
+    PKTDecodeCorrupt,
+    PKTDecodeIncompatibleVersion,
+};
+
+typedef struct {
+    const uint8_t *bytes;
+    size_t        length;
+    size_t        offset;
+} PKTByteReader;
+
+static PKTDecodeStatus PKTReadVarint(PKTByteReader *reader, uint64_t *value)
+{
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (reader->offset >= reader->length)
+            return PKTDecodeShort;
+        uint8_t byte = reader->bytes[reader->offset++];
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return PKTDecodeOK;
+        }
+    }
+    return PKTDecodeCorrupt;
+}
+
+#pragma mark - PKTCallRecordEncoder
+
+@interface PKTCallRecordEncoder ()
+
+@property (nonatomic, strong) NSOutputStream      *stream;
+@property (nonatomic, strong) NSMutableData       *buffer;
+@property (nonatomic, strong) NSMutableDictionary *stringIds;  // NSString -> id
+@property (nonatomic, assign) int64_t             lastStartMillis;
+
+@end
+
+@implementation PKTCallRecordEncoder
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)stream
+{
+    if (self = [super init]) {
+        _stream    = stream;
+        _buffer    = [NSMutableData dataWithCapacity:kPKTCallRecordChunkSize];
+        _stringIds = [NSMutableDictionary dictionary];
+        PKTOpenStream(stream);
+
+        PKTAppendBytes(_buffer, kPKTCallRecordMagic, sizeof(kPKTCallRecordMagic));
+        PKTAppendBytes(_buffer, &kPKTCallRecordVersion, sizeof(kPKTCallRecordVersion));
+    }
+    return self;
+}
+
++ (NSData *)dataWithRecords:(NSArray *)records
+{
+    NSOutputStream *stream        = [NSOutputStream outputStreamToMemory];
+    PKTCallRecordEncoder *encoder = [[self alloc] initWithOutputStream:stream];
+    if (![encoder encodeRecords:records error:NULL] || ![encoder finish:NULL])
+        return nil;
+    NSData *data = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+    [stream close];
+    return data;
+}
+
+- (void)appendString:(NSString *)string
+{
+    if (!string) {
+        PKTAppendVarint(self.buffer, PKTStringRefNil);
+        return;
+    }
+
+    NSNumber *stringId = self.stringIds[string];
+    if (stringId) {
+        PKTAppendVarint(self.buffer, PKTStringRefIdBase + [stringId unsignedLongLongValue]);
+        return;
+    }
+    self.stringIds[string] = @(self.stringIds.count);
+
+    // encoded straight into the buffer, without an intermediate NSData
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    PKTAppendVarint(self.buffer, PKTStringRefNew);
+    PKTAppendVarint(self.buffer, length);
+    NSUInteger start = self.buffer.length;
+    [self.buffer increaseLengthBy:length];
+    [string getBytes:(uint8_t *)self.buffer.mutableBytes + start
+           maxLength:length
+          usedLength:NULL
+            encoding:NSUTF8StringEncoding
+             options:0
+               range:NSMakeRange(0, string.length)
+      remainingRange:NULL];
+}
+
+- (BOOL)encodeRecord:(PKTCallRecord *)record error:(NSError **)error
+{
+    uint8_t flags = (record.incoming  ? PKTCallRecordIncoming     : 0) |
+                    (record.missed    ? PKTCallRecordMissed       : 0) |
+                    (record.startTime ? PKTCallRecordHasStartTime : 0);
+    PKTAppendBytes(self.buffer, &flags, sizeof(flags));
+
+    if (record.startTime) {
+        int64_t startMillis = PKTMillisFromSeconds([record.startTime timeIntervalSince1970]);
+        PKTAppendVarint(self.buffer, PKTZigZagEncode(startMillis - self.lastStartMillis));
+        self.lastStartMillis = startMillis;
+    }
+    PKTAppendVarint(self.buffer, record.duration > 0 ? (uint64_t)PKTMillisFromSeconds(record.duration) : 0);
+    [self appendString:record.number];
+    [self appendString:record.city];
+    [self appendString:record.state];
+
+    if (self.buffer.length >= kPKTCallRecordChunkSize)
+        return PKTFlushBuffer(self.buffer, self.stream, error);
+    return YES;
+}
+
+- (BOOL)encodeRecords:(id<NSFastEnumeration>)records error:(NSError **)error
+{
+    for (PKTCallRecord *record in records) {
+        if (![self encodeRecord:record error:error])
+            return NO;
+    }
+    return YES;
+}
+
+- (BOOL)finish:(NSError **)error
+{
+    return PKTFlushBuffer(self.buffer, self.stream, error);
+}
+
+@end
+
+#pragma mark - PKTCallRecordDecoder
+
+@interface PKTCallRecordDecoder ()
+
+@property (nonatomic, strong) NSInputStream  *stream;
+@property (nonatomic, strong) NSMutableData  *buffer;
+@property (nonatomic, assign) NSUInteger     offset;   // of the first unread byte in buffer
+@property (nonatomic, strong) NSMutableArray *strings;  // by id
+@property (nonatomic, assign) int64_t        lastStartMillis;
+@property (nonatomic, assign) BOOL           readHeader;
+@property (nonatomic, assign) BOOL           streamEnded;
+
+@end
+
+@implementation PKTCallRecordDecoder
+
+- (instancetype)initWithInputStream:(NSInputStream *)stream
+{
+    if (self = [super init]) {
+        _stream  = stream;
+        _buffer  = [NSMutableData dataWithCapacity:kPKTCallRecordChunkSize];
+        _strings = [NSMutableArray array];
+        PKTOpenStream(stream);
+    }
+    return self;
+}
+
+- (instancetype)initWithData:(NSData *)data
+{
+    if (self = [self initWithInputStream:nil]) {
+        _buffer      = [data mutableCopy] ?: [NSMutableData data];
+        _streamEnded = YES;
+    }
+    return self;
+}
+
++ (NSArray *)recordsWithData:(NSData *)data error:(NSError **)error
+{
+    PKTCallRecordDecoder *decoder = [[self alloc] initWithData:data];
+    NSMutableArray *records       = [NSMutableArray array];
+    NSError *decodeError          = nil;
+    PKTCallRecord *record;
+    while ((record = [decoder decodeRecord:&decodeError])) {
+        [records addObject:record];
+    }
+    if (decodeError) {
+        if (error) *error = decodeError;
+        return nil;
+    }
+    return records;
+}
+
+- (PKTDecodeStatus)decodeHeaderFrom:(PKTByteReader *)reader
+{
+    if (reader->length < sizeof(kPKTCallRecordMagic) + 1)
+        return PKTDecodeShort;
+    if (memcmp(reader->bytes, kPKTCallRecordMagic, sizeof(kPKTCallRecordMagic)) != 0)
+        return PKTDecodeCorrupt;
+    if (reader->bytes[sizeof(kPKTCallRecordMagic)] != kPKTCallRecordVersion)
+        return PKTDecodeIncompatibleVersion;
+    reader->offset = sizeof(kPKTCallRecordMagic) + 1;
+    return PKTDecodeOK;
+}
+
+// strings first given by this record go in newStrings, so that nothing is
+// kept from a record that turns out to be cut short
+- (PKTDecodeStatus)decodeString:(NSString **)string from:(PKTByteReader *)reader newStrings:(NSMutableArray *)newStrings
+{
+    uint64_t ref;
+    PKTDecodeStatus status = PKTReadVarint(reader, &ref);
+    if (status != PKTDecodeOK)
+        return status;
+
+    if (ref == PKTStringRefNil) {
+        *string = nil;
+    } else if (ref == PKTStringRefNew) {
+        uint64_t length;
+        if ((status = PKTReadVarint(reader, &length)) != PKTDecodeOK)
+            return status;
+        if (length > reader->length - reader->offset)
+            return PKTDecodeShort;
+        *string = [[NSString alloc] initWithBytes:reader->bytes + reader->offset
+                                           length:(NSUInteger)length
+                                         encoding:NSUTF8StringEncoding];
+        if (!*string)
+            return PKTDecodeCorrupt;
+        reader->offset += length;
+        [newStrings addObject:*string];
+    } else {
+        uint64_t stringId = ref - PKTStringRefIdBase;
+        if (stringId < self.strings.count)
+            *string = self.strings[(NSUInteger)stringId];
+        else if (stringId - self.strings.count < newStrings.count)
+            *string = newStrings[(NSUInteger)(stringId - self.strings.count)];
+        else
+            return PKTDecodeCorrupt;
+    }
+    return PKTDecodeOK;
+}
+
+- (PKTDecodeStatus)decodeRecord:(PKTCallRecord **)record from:(PKTByteReader *)reader
+{
+    if (reader->offset >= reader->length)
+        return PKTDecodeShort;
+    uint8_t flags = reader->bytes[reader->offset++];
+    if (flags & ~PKTCallRecordKnownFlags)
+        return PKTDecodeCorrupt;
+
+    PKTDecodeStatus status;
+    int64_t startMillis = self.lastStartMillis;
+    if (flags & PKTCallRecordHasStartTime) {
+        uint64_t delta;
+        if ((status = PKTReadVarint(reader, &delta)) != PKTDecodeOK)
+            return status;
+        startMillis += PKTZigZagDecode(delta);
+    }
+    uint64_t durationMillis;
+    if ((status = PKTReadVarint(reader, &durationMillis)) != PKTDecodeOK)
+        return status;
+
+    NSMutableArray *newStrings = [NSMutableArray array];
+    NSString *number, *city, *state;
+    if ((status = [self decodeString:&number from:reader newStrings:newStrings]) != PKTDecodeOK ||
+        (status = [self decodeString:&city from:reader newStrings:newStrings]) != PKTDecodeOK ||
+        (status = [self decodeString:&state from:reader newStrings:newStrings]) != PKTDecodeOK)
+        return status;
+
+    PKTCallRecord *decoded = [PKTCallRecord new];
+    decoded.incoming  = (flags & PKTCallRecordIncoming) != 0;
+    decoded.missed    = (flags & PKTCallRecordMissed) != 0;
+    decoded.duration  = durationMillis / 1000.0;
+    decoded.number    = number;
+    decoded.city      = city;
+    decoded.state     = state;
+    if (flags & PKTCallRecordHasStartTime) {
+        decoded.startTime    = [NSDate dateWithTimeIntervalSince1970:startMillis / 1000.0];
+        self.lastStartMillis = startMillis;
+    }
+    [self.strings addObjectsFromArray:newStrings];
+    *record = decoded;
+    return PKTDecodeOK;
+}
+
+// appends up to a chunk from the stream; 0 at its end, -1 on failure
+- (NSInteger)fillBuffer
+{
+    if (self.offset) {
+        [self.buffer replaceBytesInRange:NSMakeRange(0, self.offset) withBytes:NULL length:0];
+        self.offset = 0;
+    }
+    NSUInteger start = self.buffer.length;
+    [self.buffer increaseLengthBy:kPKTCallRecordChunkSize];
+    NSInteger n = [self.stream read:(uint8_t *)self.buffer.mutableBytes + start maxLength:kPKTCallRecordChunkSize];
+    self.buffer.length = start + MAX(n, 0);
+    return n;
+}
+
+- (PKTCallRecord *)decodeRecord:(NSError **)error
+{
+    while (YES) {
+        PKTByteReader reader = {(const uint8_t *)self.buffer.bytes + self.offset, self.buffer.length - self.offset, 0};
+        PKTCallRecord *record  = nil;
+        PKTDecodeStatus status = self.readHeader ? [self decodeRecord:&record from:&reader]
+                                                 : [self decodeHeaderFrom:&reader];
+        if (status == PKTDecodeOK) {
+            self.offset += reader.offset;
+            if (record)
+                return record;
+            self.readHeader = YES;
+            continue;
+        }
+
+        if (status == PKTDecodeShort && !self.streamEnded) {
+            NSInteger n = [self fillBuffer];
+            if (n < 0) {
+                if (error) *error = PKTCallRecordCodecError(PKTCallRecordCodecErrorStreamFailed, self.stream.streamError);
+                return nil;
+            }
+            self.streamEnded = n == 0;
+            continue;
+        }
+
+        if (status == PKTDecodeShort && self.readHeader && reader.length == 0) {
+            if (error) *error = nil;
+            return nil;
+        }
+        if (error) *error = PKTCallRecordCodecError(status == PKTDecodeIncompatibleVersion ? PKTCallRecordCodecErrorIncompatibleVersion
+                                                                                          : PKTCallRecordCodecErrorCorrupt, nil);
+        return nil;
+    }
+}
+
+@end
+
+#pragma mark - PKTCallRecordJSONLinesWriter
+
+static void PKTAppendCString(NSMutableData *buffer, const char *string)
+{
+    PKTAppendBytes(buffer, string, strlen(string));
+}
+
+static void PKTAppendJSONString(NSMutableData *buffer, NSString *string)
+{
+    if (!string) {
+        PKTAppendCString(buffer, "null");
+        return;
+    }
+
+    // the full byte length, so an embedded NUL is escaped rather than ending
+    // the string; short strings are encoded on the stack
+    char stackBytes[256];
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    char *utf8 = length <= sizeof(stackBytes) ? stackBytes : malloc(length);
+    [string getBytes:utf8
+           maxLength:length
+          usedLength:&length
+            encoding:NSUTF8StringEncoding
+             options:0
+               range:NSMakeRange(0, string.length)
+      remainingRange:NULL];
+
+    // copies runs of plain bytes, escaping only quotes, backslashes and
+    // control characters
+    const char *run = utf8, *end = utf8 + length;
+    PKTAppendCString(buffer, "\"");
+    for (const char *c = utf8; c < end; c++) {
+        unsigned char ch = (unsigned char)*c;
+        if (ch >= 0x20 && ch != '"' && ch != '\\')
+            continue;
+
+        PKTAppendBytes(buffer, run, c - run);
+        run = c + 1;
+        switch (ch) {
+            case '"':  PKTAppendCString(buffer, "\\\""); break;
+            case '\\': PKTAppendCString(buffer, "\\\\"); break;
+            case '\n': PKTAppendCString(buffer, "\\n");  break;
+            case '\r': PKTAppendCString(buffer, "\\r");  break;
+            case '\t': PKTAppendCString(buffer, "\\t");  break;
+            default: {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                PKTAppendCString(buffer, escaped);
+            }
+        }
+    }
+    PKTAppendBytes(buffer, run, end - run);
+    PKTAppendCString(buffer, "\"");
+    if (utf8 != stackBytes)
+        free(utf8);
+}
+
+// JSON has no nan or infinity, so those are written as null
+static void PKTAppendJSONNumber(NSMutableData *buffer, double value)
+{
+    if (!isfinite(value)) {
+        PKTAppendCString(buffer, "null");
+        return;
+    }
+    char number[32];
+    snprintf(number, sizeof(number), "%.3f", value);
+    PKTAppendCString(buffer, number);
+}
+
+@interface PKTCallRecordJSONLinesWriter ()
+
+@property (nonatomic, strong) NSOutputStream *stream;
+@property (nonatomic, strong) NSMutableData  *buffer;
+
+@end
+
+@implementation PKTCallRecordJSONLinesWriter
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)stream
+{
+    if (self = [super init]) {
+        _stream = stream;
+        _buffer = [NSMutableData dataWithCapacity:kPKTCallRecordChunkSize];
+        PKTOpenStream(stream);
+    }
+    return self;
+}
+
+- (BOOL)writeRecord:(PKTCallRecord *)record error:(NSError **)error
+{
+    // written field by field; no dictionary or NSJSONSerialization pass
+    PKTAppendCString(self.buffer, record.incoming ? "{\"incoming\":true" : "{\"incoming\":false");
+    PKTAppendCString(self.buffer, record.missed ? ",\"missed\":true" : ",\"missed\":false");
+    PKTAppendCString(self.buffer, ",\"duration\":");
+    PKTAppendJSONNumber(self.buffer, record.duration);
+    PKTAppendCString(self.buffer, ",\"startTime\":");
+    if (record.startTime)
+        PKTAppendJSONNumber(self.buffer, [record.startTime timeIntervalSince1970]);
+    else
+        PKTAppendCString(self.buffer, "null");
+    PKTAppendCString(self.buffer, ",\"number\":");
+    PKTAppendJSONString(self.buffer, record.number);
+    PKTAppendCString(self.buffer, ",\"city\":");
+    PKTAppendJSONString(self.buffer, record.city);
+    PKTAppendCString(self.buffer, ",\"state\":");
+    PKTAppendJSONString(self.buffer, record.state);
+    PKTAppendCString(self.buffer, "}\n");
+
+    if (self.buffer.length >= kPKTCallRecordChunkSize)
+        return PKTFlushBuffer(self.buffer, self.stream, error);
+    return YES;
+}
+
+- (BOOL)writeRecords:(id<NSFastEnumeration>)records error:(NSError **)error
+{
+    for (PKTCallRecord *record in records) {
+        if (![self writeRecord:record error:error])
+            return NO;
+    }
+    return YES;
+}
+
+- (BOOL)finish:(NSError **)error
+{
+    return PKTFlushBuffer(self.buffer, self.stream, error);
+}
+
+@end
@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+#import "PKTBackend.h"
+
+@class PKTCallTimeline;
+@class PKTDigitSender;
+@class RACCompoundDisposable;
+
+typedef NS_ENUM(NSUInteger, PKTCallState) {
+    PKTCallStateRinging,     // incoming, not yet answered
+    PKTCallStateConnecting,  // outgoing dialed, or incoming accepted
+    PKTCallStateActive,
+    PKTCallStateEnded
+};
+
+extern BOOL PKTCallStateCanTransition(PKTCallState from, PKTCallState to);
+extern NSString *PKTCallStateName(PKTCallState state);
+
+// seconds on a monotonic clock (mach_absolute_time); unaffected by changes to
+// the wall clock, and only meaningful relative to another reading
+extern NSTimeInterval PKTMonotonicTime(void);
+
+@interface PKTCallSession : NSObject
+
+@property (nonatomic, strong, readonly) id<PKTConnection> connection;
+@property (nonatomic, strong, readonly) NSString     *callSid;
+@property (nonatomic, assign, readonly) PKTCallState state;
+@property (nonatomic, assign, readonly) BOOL         incoming;
+@property (nonatomic, assign, readonly) BOOL         answered;
+@property (nonatomic, strong, readonly) NSDate       *startDate;
+@property (nonatomic, strong, readonly) NSDate       *connectedDate;
+@property (nonatomic, strong, readonly) NSDictionary *parameters;
+
+// PKTMonotonicTime() at each milestone, or 0 if it hasn't been reached.
+// requestTime is when the call was dialed or first reported as incoming;
+// outgoing calls count as ringing once Twilio starts connecting them.
+@property (nonatomic, assign, readonly) NSTimeInterval requestTime;
+@property (nonatomic, assign, readonly) NSTimeInterval ringingTime;
+@property (nonatomic, assign, readonly) NSTimeInterval connectedTime;
+@property (nonatomic, assign, readonly) NSTimeInterval disconnectedTime;
+
+// time connected so far, or in total once ended; 0 if it never connected
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+// set by PKTPhone while its metrics are enabled
+@property (nonatomic, strong) PKTCallTimeline *timeline;
+// created by PKTPhone for the first digits sent on this call
+@property (nonatomic, strong) PKTDigitSender  *digitSender;
+// for subscriptions and timers that should last only as long as the call;
+// disposed by PKTPhone when the call ends
+@property (nonatomic, strong, readonly) RACCompoundDisposable *disposable;
+
+- (instancetype)initWithConnection:(id<PKTConnection>)connection incoming:(BOOL)incoming;
+
+- (BOOL)isLive;
+
+@end
@@ -0,0 +1,131 @@
+#import "PKTCallSession.h"
+#import <mach/mach_time.h>
+#import "ReactiveCocoa.h"
+
+BOOL PKTCallStateCanTransition(PKTCallState from, PKTCallState to)
+{
+    switch (from) {
+        case PKTCallStateRinging:
+            return to == PKTCallStateConnecting || to == PKTCallStateEnded;
+        case PKTCallStateConnecting:
+            return to == PKTCallStateActive || to == PKTCallStateEnded;
+        case PKTCallStateActive:
+            return to == PKTCallStateEnded;
+        case PKTCallStateEnded:
+            return NO;
+    }
+    return NO;
+}
+
+NSString *PKTCallStateName(PKTCallState state)
+{
+    switch (state) {
+        case PKTCallStateRinging:    return @"ringing";
+        case PKTCallStateConnecting: return @"connecting";
+        case PKTCallStateActive:     return @"active";
+        case PKTCallStateEnded:      return @"ended";
+    }
+    return @"unknown";
+}
+
+NSTimeInterval PKTMonotonicTime(void)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (NSTimeInterval)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface PKTCallSession ()
+
+@property (nonatomic, strong, readwrite) NSString       *callSid;
+@property (nonatomic, assign, readwrite) PKTCallState   state;
+@property (nonatomic, assign, readwrite) BOOL           answered;
+@property (nonatomic, assign, readwrite) NSTimeInterval ringingTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval connectedTime;
+@property (nonatomic, assign, readwrite) NSTimeInterval disconnectedTime;
+
+@end
+
+@implementation PKTCallSession
+
+- (instancetype)initWithConnection:(id<PKTConnection>)connection incoming:(BOOL)incoming
+{
+    if (self = [super init]) {
+        _connection  = connection;
+        _incoming    = incoming;
+        _state       = incoming ? PKTCallStateRinging : PKTCallStateConnecting;
+        _answered    = !incoming;
+        _requestTime = PKTMonotonicTime();
+        _startDate   = [NSDate date];
+        _ringingTime = incoming ? _requestTime : 0;
+        _disposable  = [RACCompoundDisposable compoundDisposable];
+        [self refreshCallSid];
+    }
+    return self;
+}
+
+- (NSDictionary *)parameters
+{
+    return self.connection.parameters;
+}
+
+// wall-clock dates are derived from startDate, so they stay consistent with
+// the monotonic timestamps even if the clock is changed mid-call
+- (NSDate *)connectedDate
+{
+    return self.connectedTime ? [self.startDate dateByAddingTimeInterval:self.connectedTime - self.requestTime] : nil;
+}
+
+- (NSTimeInterval)duration
+{
+    if (!self.connectedTime)
+        return 0;
+    return (self.disconnectedTime ?: PKTMonotonicTime()) - self.connectedTime;
+}
+
+- (BOOL)isLive
+{
+    return self.state == PKTCallStateConnecting || self.state == PKTCallStateActive;
+}
+
+// outgoing connections only learn their CallSid once Twilio has set up the call
+- (NSString *)refreshCallSid
+{
+    NSString *sid = self.connection.parameters[TCConnectionParameterCallSIDKey];
+    if (sid.length && ![sid isEqualToString:self.callSid]) {
+        self.callSid = sid;
+    }
+    return self.callSid;
+}
+
+- (BOOL)transitionToState:(PKTCallState)state
+{
+    if (!PKTCallStateCanTransition(self.state, state))
+        return NO;
+
+    if (state == PKTCallStateConnecting)
+        self.answered = YES;
+    if (state == PKTCallStateActive && !self.connectedTime)
+        self.connectedTime = PKTMonotonicTime();
+    if (state == PKTCallStateEnded)
+        self.disconnectedTime = PKTMonotonicTime();
+    self.state = state;
+    return YES;
+}
+
+- (void)markRinging
+{
+    if (!self.ringingTime)
+        self.ringingTime = PKTMonotonicTime();
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p sid=%@ %@%@>", [self class], self, self.callSid,
+            self.incoming ? @"incoming " : @"", PKTCallStateName(self.state)];
+}
+
+@end
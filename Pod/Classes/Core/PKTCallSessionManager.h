@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+#import "PKTCallSession.h"
+
+@class PKTCallSessionManager;
+
+@protocol PKTCallSessionManagerDelegate <NSObject>
+@optional
+// newly registered sessions are reported with oldState == session.state
+- (void)sessionManager:(PKTCallSessionManager *)manager
+               session:(PKTCallSession *)session
+    didChangeFromState:(PKTCallState)oldState;
+@end
+
+// Tracks every connection PKTPhone knows about, keyed by CallSid, and drives
+// each one through the PKTCallState machine. At most one session is live
+// (connecting or active) at a time; the rest are ringing.
+//
+// TwilioSDK has no hold, and it neither dials nor accepts a connection while
+// the device is busy. So there's no dialing out during a call, and accepting
+// a waiting call hangs up the live one first and answers once it's gone.
+@interface PKTCallSessionManager : NSObject
+
+@property (nonatomic, weak  ) id<PKTCallSessionManagerDelegate> delegate;
+
+// 0 means unlimited. Incoming connections beyond this are rejected.
+@property (nonatomic, assign) NSUInteger maximumSessionCount;
+
+@property (nonatomic, strong, readonly) NSArray        *sessions;
+@property (nonatomic, strong, readonly) PKTCallSession *liveSession;
+@property (nonatomic, strong, readonly) NSArray        *ringingSessions;
+// accepted, still ringing until the calls it displaces have disconnected
+@property (nonatomic, strong, readonly) PKTCallSession *sessionAwaitingAccept;
+
+- (PKTCallSession *)sessionForCallSid:(NSString *)callSid;
+- (PKTCallSession *)sessionForConnection:(id<PKTConnection>)connection;
+
+// NO while a call is live or a waiting call is being answered; addOutgoingConnection: then disconnects the connection and
+// returns nil rather than orphan a session
+- (BOOL)canDialOut;
+
+// registration; both return nil if the connection was turned away
+- (PKTCallSession *)addOutgoingConnection:(id<PKTConnection>)connection;
+- (PKTCallSession *)addIncomingConnection:(id<PKTConnection>)connection;
+
+// user actions
+- (BOOL)acceptSession:(PKTCallSession *)session;
+// ends the session right away: TwilioSDK reports no disconnect for a reject
+- (BOOL)rejectSession:(PKTCallSession *)session;
+- (BOOL)ignoreSession:(PKTCallSession *)session;
+
+// events reported by the connection; each returns the affected session, if known
+- (PKTCallSession *)connectionDidStartConnecting:(id<PKTConnection>)connection;
+- (PKTCallSession *)connectionDidConnect:(id<PKTConnection>)connection;
+- (PKTCallSession *)connectionDidDisconnect:(id<PKTConnection>)connection;
+
+@end
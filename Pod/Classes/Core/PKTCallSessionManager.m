@@ -0,0 +1,236 @@
+#import "PKTCallSessionManager.h"
+
+@interface PKTCallSession (Transitions)
+- (NSString *)refreshCallSid;
+- (BOOL)transitionToState:(PKTCallState)state;
+- (void)markRinging;
+@end
+
+@interface PKTCallSessionManager ()
+
+@property (nonatomic, strong, readwrite) PKTCallSession *liveSession;
+@property (nonatomic, strong, readwrite) PKTCallSession *sessionAwaitingAccept;
+
+@property (nonatomic, strong) NSMutableArray      *orderedSessions;
+@property (nonatomic, strong) NSMutableDictionary *sessionsBySid;
+@property (nonatomic, strong) NSMapTable          *sessionsByConnection;
+
+@end
+
+@implementation PKTCallSessionManager
+
+- (id)init
+{
+    if (self = [super init]) {
+        _orderedSessions      = [NSMutableArray array];
+        _sessionsBySid        = [NSMutableDictionary dictionary];
+        _sessionsByConnection = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                      valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    return self;
+}
+
+#pragma mark - Lookup
+
+- (NSArray *)sessions
+{
+    return [self.orderedSessions copy];
+}
+
+- (NSArray *)ringingSessions
+{
+    return [self sessionsInState:PKTCallStateRinging];
+}
+
+- (NSArray *)sessionsInState:(PKTCallState)state
+{
+    NSMutableArray *matching = [NSMutableArray array];
+    for (PKTCallSession *session in self.orderedSessions) {
+        if (session.state == state)
+            [matching addObject:session];
+    }
+    return matching;
+}
+
+- (PKTCallSession *)sessionForCallSid:(NSString *)callSid
+{
+    return callSid ? self.sessionsBySid[callSid] : nil;
+}
+
+- (PKTCallSession *)sessionForConnection:(id<PKTConnection>)connection
+{
+    return connection ? [self.sessionsByConnection objectForKey:connection] : nil;
+}
+
+#pragma mark - Registration
+
+- (PKTCallSession *)addOutgoingConnection:(id<PKTConnection>)connection
+{
+    if (!connection)
+        return nil;
+    if (![self canDialOut]) {
+        [connection disconnect];
+        return nil;
+    }
+
+    PKTCallSession *session = [[PKTCallSession alloc] initWithConnection:connection incoming:NO];
+    self.liveSession = session;
+    [self registerSession:session];
+    return session;
+}
+
+- (BOOL)canDialOut
+{
+    return !self.liveSession && !self.sessionAwaitingAccept;
+}
+
+- (PKTCallSession *)addIncomingConnection:(id<PKTConnection>)connection
+{
+    if (!connection)
+        return nil;
+
+    if (self.maximumSessionCount && self.orderedSessions.count >= self.maximumSessionCount) {
+        [connection reject];
+        return nil;
+    }
+    PKTCallSession *session = [[PKTCallSession alloc] initWithConnection:connection incoming:YES];
+    [self registerSession:session];
+    return session;
+}
+
+- (void)registerSession:(PKTCallSession *)session
+{
+    [self.orderedSessions addObject:session];
+    [self.sessionsByConnection setObject:session forKey:session.connection];
+    [self indexSession:session];
+
+    if ([self.delegate respondsToSelector:@selector(sessionManager:session:didChangeFromState:)]) {
+        [self.delegate sessionManager:self session:session didChangeFromState:session.state];
+    }
+}
+
+- (void)indexSession:(PKTCallSession *)session
+{
+    NSString *sid = [session refreshCallSid];
+    if (sid)
+        self.sessionsBySid[sid] = session;
+}
+
+#pragma mark - User Actions
+
+- (BOOL)acceptSession:(PKTCallSession *)session
+{
+    if (session.state != PKTCallStateRinging || self.sessionAwaitingAccept)
+        return NO;
+
+    // the device is busy while we're on a call and TwilioSDK won't accept
+    // then; hang it up and answer once it's gone
+    if (self.liveSession) {
+        self.sessionAwaitingAccept = session;
+        [self.liveSession.connection disconnect];
+        return YES;
+    }
+
+    [session.connection accept];
+    [self transitionSession:session toState:PKTCallStateConnecting];
+    return YES;
+}
+
+- (void)acceptAwaitingSessionIfFree
+{
+    PKTCallSession *session = self.sessionAwaitingAccept;
+    if (!session || self.liveSession)
+        return;
+
+    self.sessionAwaitingAccept = nil;
+    [self acceptSession:session];
+}
+
+- (BOOL)rejectSession:(PKTCallSession *)session
+{
+    if (session.state != PKTCallStateRinging)
+        return NO;
+
+    // a rejected connection never reports a disconnect, so forget it right away
+    [session.connection reject];
+    [self transitionSession:session toState:PKTCallStateEnded];
+    [self.sessionsByConnection removeObjectForKey:session.connection];
+    return YES;
+}
+
+- (BOOL)ignoreSession:(PKTCallSession *)session
+{
+    if (session.state != PKTCallStateRinging)
+        return NO;
+
+    // stays reachable by connection until the disconnect arrives
+    [session.connection ignore];
+    [self transitionSession:session toState:PKTCallStateEnded];
+    return YES;
+}
+
+#pragma mark - Connection Events
+
+- (PKTCallSession *)connectionDidStartConnecting:(id<PKTConnection>)connection
+{
+    PKTCallSession *session = [self sessionForConnection:connection];
+    [session markRinging];
+    if (session.state == PKTCallStateRinging)
+        [self transitionSession:session toState:PKTCallStateConnecting];
+    return session;
+}
+
+- (PKTCallSession *)connectionDidConnect:(id<PKTConnection>)connection
+{
+    PKTCallSession *session = [self sessionForConnection:connection];
+    if (!session)
+        return nil;
+
+    [self indexSession:session];
+    if (session.state == PKTCallStateRinging)
+        [self transitionSession:session toState:PKTCallStateConnecting];
+    [self transitionSession:session toState:PKTCallStateActive];
+    return session;
+}
+
+- (PKTCallSession *)connectionDidDisconnect:(id<PKTConnection>)connection
+{
+    PKTCallSession *session = [self sessionForConnection:connection];
+    if (!session)
+        return nil;
+
+    [self.sessionsByConnection removeObjectForKey:connection];
+    if (session.state != PKTCallStateEnded)
+        [self transitionSession:session toState:PKTCallStateEnded];
+    [self acceptAwaitingSessionIfFree];
+    return session;
+}
+
+#pragma mark - State Machine
+
+- (BOOL)transitionSession:(PKTCallSession *)session toState:(PKTCallState)state
+{
+    PKTCallState oldState = session.state;
+    if (![session transitionToState:state])
+        return NO;
+
+    if ([session isLive]) {
+        self.liveSession = session;
+    } else if (session == self.liveSession) {
+        self.liveSession = nil;
+    }
+    if (state == PKTCallStateEnded) {
+        if (session == self.sessionAwaitingAccept)
+            self.sessionAwaitingAccept = nil;  // the caller gave up first
+        [self.orderedSessions removeObject:session];
+        if (session.callSid)
+            [self.sessionsBySid removeObjectForKey:session.callSid];
+    }
+
+    if ([self.delegate respondsToSelector:@selector(sessionManager:session:didChangeFromState:)]) {
+        [self.delegate sessionManager:self session:session didChangeFromState:oldState];
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,88 @@
+#import <Foundation/Foundation.h>
+
+@class PKTPhone;
+@class PKTCallRecord;
+
+extern NSString *const PKTDialQueueErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTDialQueueError) {
+    PKTDialQueueErrorTimedOut = 1,  // the call never connected or ended within attemptTimeout
+};
+
+typedef NS_ENUM(NSUInteger, PKTDialItemState) {
+    PKTDialItemStatePending,     // waiting for its turn, or for a retry
+    PKTDialItemStateDialing,
+    PKTDialItemStateAnswered,
+    PKTDialItemStateUnanswered,  // ended without connecting, no error
+    PKTDialItemStateFailed,      // out of attempts
+};
+
+@interface PKTDialItem : NSObject
+
+@property (nonatomic, strong, readonly) NSString         *number;  // as dialed, after normalization
+@property (nonatomic, strong, readonly) NSDictionary     *params;
+@property (nonatomic, assign, readonly) PKTDialItemState state;
+@property (nonatomic, assign, readonly) NSUInteger       attempts;
+@property (nonatomic, strong, readonly) NSError          *lastError;
+@property (nonatomic, strong, readonly) PKTCallRecord    *record;  // of the last attempt
+
+@end
+
+@class PKTDialQueue;
+
+@protocol PKTDialQueueDelegate <NSObject>
+@optional
+- (void)dialQueue:(PKTDialQueue *)queue didStartItem:(PKTDialItem *)item;
+- (void)dialQueue:(PKTDialQueue *)queue didFinishItem:(PKTDialItem *)item;
+- (void)dialQueueDidFinish:(PKTDialQueue *)queue;
+@end
+
+// Works through a list of numbers with -[PKTPhone call:withParams:]. Numbers
+// are normalized up front (digits only, keeping a leading "+"; client names
+// as given) and duplicates dropped. Calls start at most callInterval apart,
+// with up to maximumConcurrentCalls in progress; calls that fail with an
+// error are retried with jittered exponential backoff. Outcomes come from
+// PKTPhoneCallDidConnectNotification and PKTPhoneCallDidEndNotification, so
+// the phone's delegate stays free.
+//
+// TwilioSDK won't dial while the device is busy, so PKTPhone refuses a call
+// while another is in progress; keep maximumConcurrentCalls at 1.
+//
+// Drive it with a PKTFakeDevice (Testing subspec) as the phone's device to
+// exercise a whole campaign offline.
+//
+// Use from the main thread.
+@interface PKTDialQueue : NSObject
+
+@property (nonatomic, weak  ) id<PKTDialQueueDelegate> delegate;
+@property (nonatomic, strong, readonly) PKTPhone *phone;
+
+@property (nonatomic, assign) NSUInteger     maximumConcurrentCalls;  // default 1
+@property (nonatomic, assign) NSTimeInterval callInterval;            // between call starts; default 1
+@property (nonatomic, assign) NSUInteger     maximumAttempts;         // default 3
+@property (nonatomic, assign) NSTimeInterval initialRetryInterval;    // default 5, doubling per attempt
+@property (nonatomic, assign) NSTimeInterval maximumRetryInterval;    // default 300
+// how long an attempt may take to connect; answered calls run as long as they like
+@property (nonatomic, assign) NSTimeInterval attemptTimeout;          // default 300
+
+@property (nonatomic, strong, readonly) NSArray *items;  // in the order added
+@property (nonatomic, assign, readonly, getter=isRunning) BOOL running;
+
+// totals over the campaign
+@property (nonatomic, assign, readonly) NSUInteger callCount;      // attempts finished
+@property (nonatomic, assign, readonly) NSUInteger answeredCount;
+@property (nonatomic, assign, readonly) double     answerRate;     // answered items / finished items
+// attempts finished in the last hour
+@property (nonatomic, assign, readonly) NSUInteger callsInLastHour;
+
+- (instancetype)initWithPhone:(PKTPhone *)phone;
+
+// params are passed to call:withParams: for each number; returns how many were new
+- (NSUInteger)addNumbers:(NSArray *)numbers params:(NSDictionary *)params;
+
+- (void)start;
+// stops starting calls; calls in progress are left alone
+- (void)pause;
+- (void)removeAllItems;
+
+@end
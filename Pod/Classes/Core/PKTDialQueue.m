@@ -0,0 +1,323 @@
+#import "PKTDialQueue.h"
+#import "PKTPhone.h"
+#import "PKTCallSession.h"
+#import "NSString+PKTHelpers.h"
+
+NSString *const PKTDialQueueErrorDomain = @"PKTDialQueueErrorDomain";
+
+@interface PKTDialItem ()
+
+@property (nonatomic, strong, readwrite) NSString         *number;
+@property (nonatomic, strong, readwrite) NSDictionary     *params;
+@property (nonatomic, assign, readwrite) PKTDialItemState state;
+@property (nonatomic, assign, readwrite) NSUInteger       attempts;
+@property (nonatomic, strong, readwrite) NSError          *lastError;
+@property (nonatomic, strong, readwrite) PKTCallRecord    *record;
+
+@property (nonatomic, assign) NSTimeInterval notBefore;          // PKTMonotonicTime() of the next allowed attempt
+@property (nonatomic, assign) NSUInteger     attemptGeneration;  // to ignore a stale timeout
+@property (nonatomic, assign) BOOL           connected;          // this attempt has; its timeout no longer applies
+
+@end
+
+@implementation PKTDialItem
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p %@ state=%lu attempts=%lu>", [self class], self,
+            self.number, (unsigned long)self.state, (unsigned long)self.attempts];
+}
+
+@end
+
+@interface PKTDialQueue ()
+
+@property (nonatomic, strong, readwrite) PKTPhone *phone;
+@property (nonatomic, assign, readwrite, getter=isRunning) BOOL running;
+@property (nonatomic, assign, readwrite) NSUInteger callCount;
+@property (nonatomic, assign, readwrite) NSUInteger answeredCount;
+
+@property (nonatomic, strong) NSMutableArray      *allItems;
+@property (nonatomic, assign) NSUInteger          nextFreshIndex;  // first item in allItems never dialed
+@property (nonatomic, strong) NSMutableArray      *retryItems;      // waiting out a backoff
+@property (nonatomic, strong) NSMutableSet        *numberKeys;     // sanitized numbers already added
+@property (nonatomic, strong) NSMutableDictionary *dialingByKey;   // sanitized number -> dialing item
+@property (nonatomic, strong) NSMutableArray      *finishTimes;    // PKTMonotonicTime() of recent attempts
+@property (nonatomic, assign) NSUInteger          finishedItemCount;
+@property (nonatomic, assign) NSTimeInterval      lastStartTime;
+@property (nonatomic, assign) BOOL                pumpScheduled;
+@property (nonatomic, strong) id                  callEndObserver;
+@property (nonatomic, strong) id                  callConnectObserver;
+
+@end
+
+@implementation PKTDialQueue
+
+- (instancetype)initWithPhone:(PKTPhone *)phone
+{
+    if (self = [super init]) {
+        _phone                  = phone;
+        _maximumConcurrentCalls = 1;
+        _callInterval           = 1;
+        _maximumAttempts        = 3;
+        _initialRetryInterval   = 5;
+        _maximumRetryInterval   = 300;
+        _attemptTimeout         = 300;
+        _allItems               = [NSMutableArray array];
+        _retryItems             = [NSMutableArray array];
+        _numberKeys             = [NSMutableSet set];
+        _dialingByKey           = [NSMutableDictionary dictionary];
+        _finishTimes            = [NSMutableArray array];
+
+        __weak PKTDialQueue *weakSelf = self;
+        _callEndObserver = [[NSNotificationCenter defaultCenter] addObserverForName:PKTPhoneCallDidEndNotification
+                                                                             object:phone
+                                                                              queue:[NSOperationQueue mainQueue]
+                                                                         usingBlock:^(NSNotification *note) {
+            [weakSelf callDidEndWithRecord:note.userInfo[PKTPhoneCallRecordKey]
+                                     error:note.userInfo[PKTPhoneCallErrorKey]];
+        }];
+        _callConnectObserver = [[NSNotificationCenter defaultCenter] addObserverForName:PKTPhoneCallDidConnectNotification
+                                                                                 object:phone
+                                                                                  queue:[NSOperationQueue mainQueue]
+                                                                             usingBlock:^(NSNotification *note) {
+            if (![note.userInfo[PKTPhoneCallIncomingKey] boolValue])
+                [weakSelf callDidConnectToNumber:note.userInfo[PKTPhoneCallParamsKey][@"callee"]];
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:_callEndObserver];
+    [[NSNotificationCenter defaultCenter] removeObserver:_callConnectObserver];
+}
+
+- (NSArray *)items
+{
+    return [self.allItems copy];
+}
+
+- (double)answerRate
+{
+    return self.finishedItemCount ? (double)self.answeredCount / self.finishedItemCount : 0;
+}
+
+- (NSUInteger)callsInLastHour
+{
+    [self pruneFinishTimes];
+    return self.finishTimes.count;
+}
+
+#pragma mark - Items
+
+- (NSUInteger)addNumbers:(NSArray *)numbers params:(NSDictionary *)params
+{
+    NSUInteger added = 0;
+    for (NSString *raw in numbers) {
+        NSString *number = [self normalizedNumber:raw];
+        NSString *key    = [number sanitizeNumber];
+        if (!key.length || [self.numberKeys containsObject:key])
+            continue;
+
+        PKTDialItem *item = [PKTDialItem new];
+        item.number       = number;
+        item.params       = params;
+        [self.allItems addObject:item];
+        [self.numberKeys addObject:key];
+        added++;
+    }
+    if (added)
+        [self setNeedsPump];
+    return added;
+}
+
+- (void)removeAllItems
+{
+    [self.allItems removeAllObjects];
+    [self.retryItems removeAllObjects];
+    self.nextFreshIndex = 0;
+    [self.numberKeys removeAllObjects];
+    [self.dialingByKey removeAllObjects];
+}
+
+- (NSString *)normalizedNumber:(NSString *)number
+{
+    if (![number isKindOfClass:[NSString class]])
+        return nil;
+    if ([number isClientNumber])
+        return [number stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+
+    NSString *digits = [number stripToDigitsOnly];
+    BOOL plus = [[number stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] hasPrefix:@"+"];
+    return plus ? [@"+" stringByAppendingString:digits] : digits;
+}
+
+#pragma mark - Running
+
+- (void)start
+{
+    self.running = YES;
+    [self setNeedsPump];
+}
+
+- (void)pause
+{
+    self.running = NO;
+}
+
+- (void)setNeedsPump
+{
+    if (self.pumpScheduled)
+        return;
+
+    self.pumpScheduled = YES;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        self.pumpScheduled = NO;
+        [self pump];
+    });
+}
+
+// starts whatever calls are due, then sleeps until the next one is. Retries
+// that are due go ahead of numbers not yet dialed.
+- (void)pump
+{
+    if (!self.running)
+        return;
+
+    while (self.dialingByKey.count < self.maximumConcurrentCalls) {
+        NSTimeInterval now      = PKTMonotonicTime();
+        NSTimeInterval nextSlot = self.lastStartTime ? self.lastStartTime + self.callInterval : 0;
+
+        PKTDialItem *retry = [self.retryItems firstObject];
+        PKTDialItem *item  = nil;
+        NSTimeInterval due = 0;
+        if (retry && retry.notBefore <= now) {
+            item = retry;
+        } else if (self.nextFreshIndex < self.allItems.count) {
+            item = self.allItems[self.nextFreshIndex];
+        } else if (retry) {
+            item = retry;
+            due  = retry.notBefore;
+        }
+        if (!item)
+            break;
+
+        due = MAX(due, nextSlot);
+        if (due > now) {
+            [self pumpAfter:due - now];
+            return;
+        }
+
+        if (item == retry)
+            [self.retryItems removeObjectAtIndex:0];
+        else
+            self.nextFreshIndex++;
+        [self dialItem:item];
+    }
+
+    if (!self.dialingByKey.count && !self.retryItems.count && self.nextFreshIndex >= self.allItems.count) {
+        self.running = NO;
+        if ([self.delegate respondsToSelector:@selector(dialQueueDidFinish:)])
+            [self.delegate dialQueueDidFinish:self];
+    }
+}
+
+- (void)pumpAfter:(NSTimeInterval)delay
+{
+    __weak PKTDialQueue *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(delay, 0) * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [weakSelf setNeedsPump];
+    });
+}
+
+- (void)dialItem:(PKTDialItem *)item
+{
+    item.state     = PKTDialItemStateDialing;
+    item.connected = NO;
+    item.attempts++;
+    NSUInteger generation = ++item.attemptGeneration;
+    self.dialingByKey[[item.number sanitizeNumber]] = item;
+    self.lastStartTime = PKTMonotonicTime();
+
+    if ([self.delegate respondsToSelector:@selector(dialQueue:didStartItem:)])
+        [self.delegate dialQueue:self didStartItem:item];
+    [self.phone call:item.number withParams:item.params];
+
+    // if the phone couldn't place the call at all, no end is ever reported.
+    // only setup is timed: once connected, the call ends when it ends
+    __weak PKTDialQueue *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.attemptTimeout * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        if (item.state == PKTDialItemStateDialing && item.attemptGeneration == generation && !item.connected) {
+            [weakSelf finishAttemptOfItem:item record:nil error:[NSError errorWithDomain:PKTDialQueueErrorDomain
+                                                                                    code:PKTDialQueueErrorTimedOut
+                                                                                userInfo:nil]];
+        }
+    });
+}
+
+- (void)callDidConnectToNumber:(NSString *)number
+{
+    PKTDialItem *item = number ? self.dialingByKey[[number sanitizeNumber]] : nil;
+    item.connected    = YES;
+}
+
+- (void)callDidEndWithRecord:(PKTCallRecord *)record error:(NSError *)error
+{
+    if (record.incoming || !record.number)
+        return;
+
+    PKTDialItem *item = self.dialingByKey[[record.number sanitizeNumber]];
+    if (item)
+        [self finishAttemptOfItem:item record:record error:error];
+}
+
+- (void)finishAttemptOfItem:(PKTDialItem *)item record:(PKTCallRecord *)record error:(NSError *)error
+{
+    [self.dialingByKey removeObjectForKey:[item.number sanitizeNumber]];
+    item.record    = record;
+    item.lastError = error;
+    self.callCount++;
+    [self.finishTimes addObject:@(PKTMonotonicTime())];
+    [self pruneFinishTimes];
+
+    if (error && item.attempts < self.maximumAttempts) {
+        // "equal jitter": half the backoff is fixed, the other half random
+        double backoff = MIN(self.maximumRetryInterval, self.initialRetryInterval * pow(2, item.attempts - 1));
+        item.notBefore = PKTMonotonicTime() + backoff / 2 * (1 + arc4random_uniform(1001) / 1000.0);
+        item.state     = PKTDialItemStatePending;
+
+        NSUInteger index = [self.retryItems indexOfObject:item
+                                            inSortedRange:NSMakeRange(0, self.retryItems.count)
+                                                  options:NSBinarySearchingInsertionIndex
+                                          usingComparator:^NSComparisonResult(PKTDialItem *a, PKTDialItem *b) {
+            return a.notBefore < b.notBefore ? NSOrderedAscending : a.notBefore > b.notBefore ? NSOrderedDescending : NSOrderedSame;
+        }];
+        [self.retryItems insertObject:item atIndex:index];
+    } else {
+        if (error)
+            item.state = PKTDialItemStateFailed;
+        else
+            item.state = record.duration > 0 ? PKTDialItemStateAnswered : PKTDialItemStateUnanswered;
+        self.finishedItemCount++;
+        if (item.state == PKTDialItemStateAnswered)
+            self.answeredCount++;
+
+        if ([self.delegate respondsToSelector:@selector(dialQueue:didFinishItem:)])
+            [self.delegate dialQueue:self didFinishItem:item];
+    }
+    [self setNeedsPump];
+}
+
+- (void)pruneFinishTimes
+{
+    NSTimeInterval hourAgo = PKTMonotonicTime() - 3600;
+    NSUInteger stale = 0;
+    while (stale < self.finishTimes.count && [self.finishTimes[stale] doubleValue] < hourAgo)
+        stale++;
+    if (stale)
+        [self.finishTimes removeObjectsInRange:NSMakeRange(0, stale)];
+}
+
+@end
@@ -0,0 +1,40 @@
+#import <Foundation/Foundation.h>
+#import "PKTCallRecord.h"
+#import "PKTCallHistory.h"
+
+@interface PKTDialSuggestion : NSObject
+
+@property (nonatomic, strong, readonly) NSString   *number;    // digits only
+@property (nonatomic, strong, readonly) NSString   *name;      // for contacts
+@property (nonatomic, assign, readonly) NSUInteger callCount;
+@property (nonatomic, strong, readonly) NSDate     *lastCallDate;
+@property (nonatomic, assign, readonly) BOOL       matchedName;  // the digits matched the name on the keypad, not the number
+
+@end
+
+// Suggests numbers as digits are typed on a dial pad, from call history and
+// contacts. Numbers match by digit prefix and names by their keypad (T9)
+// digits from the start of any word, so "76" finds "Bob Smith".
+//
+// Entries are ranked by frecency: each call adds weight that halves every
+// recencyHalfLife. Every trie node keeps its best few entries, so a lookup is
+// one step per typed digit whatever the size of the history. Updates and
+// lookups run on a private serial queue; the completion-based lookup never
+// blocks the caller.
+@interface PKTDialSuggester : NSObject
+
+@property (nonatomic, assign) NSTimeInterval recencyHalfLife;  // default 30 days; set before adding
+
+// loads the whole history in the background; completion runs on the main queue
+- (void)addRecordsFromHistory:(PKTCallHistory *)history completion:(void (^)(void))completion;
+- (void)addRecord:(PKTCallRecord *)record;
+- (void)addContactWithName:(NSString *)name number:(NSString *)number;
+
+// at most 6 suggestions, best first; completion runs on the main queue
+- (void)suggestionsForDigits:(NSString *)digits completion:(void (^)(NSArray *suggestions))completion;
+// the same, waiting for any updates queued before it
+- (NSArray *)suggestionsForDigits:(NSString *)digits;
+
+- (void)removeAll;
+
+@end
@@ -0,0 +1,380 @@
+#import "PKTDialSuggester.h"
+#import "NSString+PKTHelpers.h"
+#import "PKTNumberNormalizer.h"
+
+#define PKT_SUGGEST_TOP_COUNT 6
+
+static const NSUInteger kPKTSuggestMaxKeyLength = 20;
+static const NSUInteger kPKTSuggestHistoryPage  = 1000;
+static const double     kPKTSuggestMaxHalfLives = 256;  // weights stay far below DBL_MAX
+
+// ranked entries per node, best first; child lists are sibling chains
+typedef struct {
+    int32_t firstChild;
+    int32_t nextSibling;
+    int32_t top[PKT_SUGGEST_TOP_COUNT];
+    uint8_t digit;
+    uint8_t topCount;
+} PKTSuggestNode;
+
+enum {
+    PKTSuggestNumberRoot = 0,
+    PKTSuggestNameRoot   = 1,
+};
+
+static char PKTKeypadDigitForLetter(unichar c)
+{
+    static const char digits[] = "22233344455566677778889999";
+    if (c >= 'A' && c <= 'Z')
+        c += 'a' - 'A';
+    return (c >= 'a' && c <= 'z') ? digits[c - 'a'] : 0;
+}
+
+@interface PKTDialSuggestion ()
+
+@property (nonatomic, strong, readwrite) NSString   *number;
+@property (nonatomic, strong, readwrite) NSString   *name;
+@property (nonatomic, assign, readwrite) NSUInteger callCount;
+@property (nonatomic, strong, readwrite) NSDate     *lastCallDate;
+@property (nonatomic, assign, readwrite) BOOL       matchedName;
+
+@end
+
+@implementation PKTDialSuggestion
+@end
+
+// the suggester's own record of a number
+@interface PKTSuggestEntry : NSObject
+
+@property (nonatomic, strong) NSString   *number;
+@property (nonatomic, strong) NSString   *name;
+@property (nonatomic, assign) NSUInteger callCount;
+@property (nonatomic, strong) NSDate     *lastCallDate;
+@property (nonatomic, assign) double     score;
+@property (nonatomic, strong) NSArray    *nameKeys;  // keypad digits indexed in the name trie
+
+@end
+
+@implementation PKTSuggestEntry
+@end
+
+@interface PKTDialSuggester ()
+
+@property (nonatomic, strong) dispatch_queue_t    queue;
+@property (nonatomic, strong) NSMutableData       *nodes;
+@property (nonatomic, strong) NSMutableArray      *entries;        // entry id -> PKTSuggestEntry
+@property (nonatomic, strong) NSMutableDictionary *entryIds;       // number -> entry id
+@property (nonatomic, assign) NSTimeInterval      scoreEpoch;     // scores are weights relative to this time
+@property (nonatomic, assign) BOOL                hasScoreEpoch;
+
+@end
+
+@implementation PKTDialSuggester
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _queue           = dispatch_queue_create("com.phonekit.dial-suggester", DISPATCH_QUEUE_SERIAL);
+        _recencyHalfLife = 30 * 24 * 3600;
+        [self reset];
+    }
+    return self;
+}
+
+- (void)reset
+{
+    _nodes    = [NSMutableData dataWithLength:2 * sizeof(PKTSuggestNode)];
+    _entries  = [NSMutableArray array];
+    _entryIds = [NSMutableDictionary dictionary];
+    _hasScoreEpoch = NO;
+    PKTSuggestNode *roots = _nodes.mutableBytes;
+    roots[0].firstChild = roots[1].firstChild = -1;
+    roots[0].nextSibling = roots[1].nextSibling = -1;
+}
+
+#pragma mark - Adding
+
+- (void)addRecordsFromHistory:(PKTCallHistory *)history completion:(void (^)(void))completion
+{
+    dispatch_async(self.queue, ^{
+        // a page at a time, so only one page of records is ever inflated
+        NSUInteger count = history.count;
+        for (NSUInteger offset = 0; offset < count; offset += kPKTSuggestHistoryPage) {
+            @autoreleasepool {
+                for (PKTCallRecord *record in [history recentRecordsFromOffset:offset limit:kPKTSuggestHistoryPage]) {
+                    [self recordCallToNumber:record.number date:record.startTime];
+                }
+            }
+        }
+        if (completion)
+            dispatch_async(dispatch_get_main_queue(), completion);
+    });
+}
+
+- (void)addRecord:(PKTCallRecord *)record
+{
+    NSString *number = record.number;
+    NSDate *date     = record.startTime;
+    dispatch_async(self.queue, ^{
+        [self recordCallToNumber:number date:date];
+    });
+}
+
+- (void)addContactWithName:(NSString *)name number:(NSString *)number
+{
+    dispatch_async(self.queue, ^{
+        PKTSuggestEntry *entry = [self entryForNumber:number];
+        if (!entry || !name.length || [entry.name isEqualToString:name])
+            return;
+
+        entry.name = name;
+        [self indexName:entry];
+    });
+}
+
+- (void)removeAll
+{
+    dispatch_async(self.queue, ^{
+        [self reset];
+    });
+}
+
+#pragma mark - Lookup
+
+- (void)suggestionsForDigits:(NSString *)digits completion:(void (^)(NSArray *))completion
+{
+    dispatch_async(self.queue, ^{
+        NSArray *suggestions = [self lookupDigits:digits];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(suggestions);
+        });
+    });
+}
+
+- (NSArray *)suggestionsForDigits:(NSString *)digits
+{
+    __block NSArray *suggestions = nil;
+    dispatch_sync(self.queue, ^{
+        suggestions = [self lookupDigits:digits];
+    });
+    return suggestions;
+}
+
+- (NSArray *)lookupDigits:(NSString *)typed
+{
+    NSString *digits = [typed stripToDigitsOnly];
+    if (!digits.length)
+        return @[];
+
+    int32_t numberNode = [self nodeForKey:digits root:PKTSuggestNumberRoot create:NO];
+    int32_t nameNode   = [self nodeForKey:digits root:PKTSuggestNameRoot create:NO];
+
+    // merge the two ranked lists
+    NSMutableArray *merged = [NSMutableArray array];
+    NSMutableSet *seen     = [NSMutableSet set];
+    const PKTSuggestNode *nodes = self.nodes.bytes;
+    const PKTSuggestNode *lists[2] = {numberNode >= 0 ? &nodes[numberNode] : NULL,
+                                      nameNode >= 0 ? &nodes[nameNode] : NULL};
+    NSUInteger next[2] = {0, 0};
+    while (merged.count < PKT_SUGGEST_TOP_COUNT) {
+        PKTSuggestEntry *best = nil;
+        int bestList = -1;
+        for (int l = 0; l < 2; l++) {
+            if (!lists[l] || next[l] >= lists[l]->topCount)
+                continue;
+            PKTSuggestEntry *candidate = self.entries[lists[l]->top[next[l]]];
+            if (!best || candidate.score > best.score) {
+                best     = candidate;
+                bestList = l;
+            }
+        }
+        if (!best)
+            break;
+
+        next[bestList]++;
+        if ([seen containsObject:best.number])
+            continue;
+        [seen addObject:best.number];
+
+        PKTDialSuggestion *suggestion = [PKTDialSuggestion new];
+        suggestion.number       = best.number;
+        suggestion.name         = best.name;
+        suggestion.callCount    = best.callCount;
+        suggestion.lastCallDate = best.lastCallDate;
+        suggestion.matchedName  = bestList == 1;
+        [merged addObject:suggestion];
+    }
+    return merged;
+}
+
+#pragma mark - Helpers
+
+- (PKTSuggestEntry *)entryForNumber:(NSString *)rawNumber
+{
+    if (!rawNumber.length || [rawNumber isClientNumber])
+        return nil;
+
+    NSString *number = [rawNumber stripToDigitsOnly];
+    if (!number.length)
+        return nil;
+
+    NSNumber *entryId = self.entryIds[number];
+    if (entryId)
+        return self.entries[[entryId unsignedIntegerValue]];
+
+    PKTSuggestEntry *entry = [PKTSuggestEntry new];
+    entry.number = number;
+    self.entryIds[number] = @(self.entries.count);
+    [self.entries addObject:entry];
+
+    [self rankEntry:entry inKey:number root:PKTSuggestNumberRoot];
+    return entry;
+}
+
+- (void)recordCallToNumber:(NSString *)number date:(NSDate *)date
+{
+    PKTSuggestEntry *entry = [self entryForNumber:number];
+    if (!entry)
+        return;
+
+    date = date ?: [NSDate date];
+    entry.callCount++;
+    if (!entry.lastCallDate || [date compare:entry.lastCallDate] == NSOrderedDescending)
+        entry.lastCallDate = date;
+    // weights grow with time instead of old ones decaying, which ranks the
+    // same and means scores only ever go up
+    entry.score += exp2([self halfLivesSinceEpoch:date]);
+
+    [self rankEntry:entry inKey:entry.number root:PKTSuggestNumberRoot];
+    for (NSString *key in entry.nameKeys) {
+        [self rankEntry:entry inKey:key root:PKTSuggestNameRoot];
+    }
+}
+
+// half-lives from the score epoch to date. The epoch starts at the first call
+// and moves forward once weights get large, scaling every score down by the
+// same power of two so they stay finite and keep their order.
+- (double)halfLivesSinceEpoch:(NSDate *)date
+{
+    NSTimeInterval time = [date timeIntervalSinceReferenceDate];
+    if (!self.hasScoreEpoch) {
+        self.scoreEpoch    = time;
+        self.hasScoreEpoch = YES;
+    }
+
+    double halfLives = (time - self.scoreEpoch) / self.recencyHalfLife;
+    if (halfLives > kPKTSuggestMaxHalfLives) {
+        double shift = floor(halfLives);
+        for (PKTSuggestEntry *entry in self.entries) {
+            entry.score = ldexp(entry.score, -(int)shift);
+        }
+        self.scoreEpoch += shift * self.recencyHalfLife;
+        halfLives       -= shift;
+    }
+    return halfLives;
+}
+
+- (void)indexName:(PKTSuggestEntry *)entry
+{
+    // keypad digits from the start of each word to the end of the name
+    NSString *folded = [entry.name stringByFoldingWithOptions:NSDiacriticInsensitiveSearch | NSCaseInsensitiveSearch
+                                                       locale:nil];
+    NSMutableString *letters = [NSMutableString string];
+    NSMutableArray *wordStarts = [NSMutableArray array];
+    BOOL inWord = NO;
+    for (NSUInteger i = 0; i < folded.length; i++) {
+        char digit = PKTKeypadDigitForLetter([folded characterAtIndex:i]);
+        if (!digit) {
+            inWord = NO;
+            continue;
+        }
+        if (!inWord)
+            [wordStarts addObject:@(letters.length)];
+        inWord = YES;
+        [letters appendFormat:@"%c", digit];
+    }
+
+    NSMutableArray *keys = [NSMutableArray array];
+    for (NSNumber *start in wordStarts) {
+        NSString *key = [letters substringFromIndex:[start unsignedIntegerValue]];
+        [keys addObject:key];
+        [self rankEntry:entry inKey:key root:PKTSuggestNameRoot];
+    }
+    entry.nameKeys = keys;
+}
+
+// puts the entry into the ranked list of every node along key, creating nodes
+- (void)rankEntry:(PKTSuggestEntry *)entry inKey:(NSString *)key root:(int32_t)root
+{
+    int32_t entryId = [self.entryIds[entry.number] intValue];
+    NSUInteger length = MIN(key.length, kPKTSuggestMaxKeyLength);
+
+    int32_t node = root;
+    for (NSUInteger i = 0; i < length; i++) {
+        node = [self childOf:node digit:(uint8_t)([key characterAtIndex:i] - '0') create:YES];
+        [self rankEntryId:entryId score:entry.score atNode:node];
+    }
+}
+
+- (void)rankEntryId:(int32_t)entryId score:(double)score atNode:(int32_t)index
+{
+    PKTSuggestNode *node = (PKTSuggestNode *)self.nodes.mutableBytes + index;
+
+    NSInteger position = -1;
+    for (NSUInteger i = 0; i < node->topCount; i++) {
+        if (node->top[i] == entryId) {
+            position = i;
+            break;
+        }
+    }
+    if (position < 0) {
+        if (node->topCount < PKT_SUGGEST_TOP_COUNT) {
+            position = node->topCount++;
+        } else if (score > [self.entries[node->top[PKT_SUGGEST_TOP_COUNT - 1]] score]) {
+            position = PKT_SUGGEST_TOP_COUNT - 1;  // bumps the lowest
+        } else {
+            return;
+        }
+        node->top[position] = entryId;
+    }
+
+    // scores only increase, so the entry can only move up
+    while (position > 0 && [self.entries[node->top[position - 1]] score] < score) {
+        node->top[position]     = node->top[position - 1];
+        node->top[position - 1] = entryId;
+        position--;
+    }
+}
+
+- (int32_t)nodeForKey:(NSString *)key root:(int32_t)root create:(BOOL)create
+{
+    int32_t node = root;
+    for (NSUInteger i = 0; i < key.length && node >= 0; i++) {
+        int digit = PKTDigitValue([key characterAtIndex:i]);
+        if (digit >= 0)
+            node = [self childOf:node digit:(uint8_t)digit create:create];
+    }
+    return node == root ? -1 : node;
+}
+
+- (int32_t)childOf:(int32_t)parent digit:(uint8_t)digit create:(BOOL)create
+{
+    PKTSuggestNode *nodes = self.nodes.mutableBytes;
+    for (int32_t child = nodes[parent].firstChild; child >= 0; child = nodes[child].nextSibling) {
+        if (nodes[child].digit == digit)
+            return child;
+    }
+    if (!create)
+        return -1;
+
+    int32_t child = (int32_t)(self.nodes.length / sizeof(PKTSuggestNode));
+    [self.nodes increaseLengthBy:sizeof(PKTSuggestNode)];
+    nodes = self.nodes.mutableBytes;
+    nodes[child].digit       = digit;
+    nodes[child].firstChild  = -1;
+    nodes[child].nextSibling = nodes[parent].firstChild;
+    nodes[parent].firstChild = child;
+    return child;
+}
+
+@end
@@ -0,0 +1,35 @@
+#import <Foundation/Foundation.h>
+#import "PKTBackend.h"
+
+// Plays a string of DTMF digits into one connection. Digits can be queued
+// before the call connects and go out once it has; "w" (or ",") waits
+// pauseInterval before the rest. With interDigitInterval 0, each run of
+// digits between pauses goes out in a single sendDigits: call; otherwise
+// they're sent one at a time, that far apart.
+//
+// Not thread-safe; use from the queue it was created with, where its timers
+// and handler also run.
+@interface PKTDigitSender : NSObject
+
+@property (nonatomic, strong, readonly) id<PKTConnection> connection;
+
+@property (nonatomic, assign) NSTimeInterval interDigitInterval;  // default 0
+@property (nonatomic, assign) NSTimeInterval pauseInterval;       // default 0.5, as for TwilioSDK's "w"
+
+// called as digits actually go to the connection, with PKTMonotonicTime()
+@property (nonatomic, copy) void (^emitHandler)(NSString *digits, NSTimeInterval time);
+
+// queued and not yet sent, pauses included
+@property (nonatomic, strong, readonly) NSString *pendingDigits;
+
+- (instancetype)initWithConnection:(id<PKTConnection>)connection queue:(dispatch_queue_t)queue;
+
+// characters other than 0-9, *, #, w, W and , are ignored
+- (void)enqueueDigits:(NSString *)digits;
+
+// sends whatever is due; call when the connection connects
+- (void)resume;
+// drops everything still queued
+- (void)cancel;
+
+@end
@@ -0,0 +1,101 @@
+#import "PKTDigitSender.h"
+#import "PKTCallSession.h"
+
+static BOOL PKTIsPauseCharacter(unichar c)
+{
+    return c == 'w' || c == 'W' || c == ',';
+}
+
+static BOOL PKTIsDTMFCharacter(unichar c)
+{
+    return (c >= '0' && c <= '9') || c == '*' || c == '#';
+}
+
+@interface PKTDigitSender ()
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) NSMutableString  *queuedDigits;
+@property (nonatomic, assign) BOOL             waiting;     // a pause or gap is running
+@property (nonatomic, assign) NSUInteger       generation;  // bumped by cancel to drop a running wait
+
+@end
+
+@implementation PKTDigitSender
+
+- (instancetype)initWithConnection:(id<PKTConnection>)connection queue:(dispatch_queue_t)queue
+{
+    if (self = [super init]) {
+        _connection    = connection;
+        _queue         = queue ?: dispatch_get_main_queue();
+        _queuedDigits  = [NSMutableString string];
+        _pauseInterval = 0.5;
+    }
+    return self;
+}
+
+- (NSString *)pendingDigits
+{
+    return [self.queuedDigits copy];
+}
+
+- (void)enqueueDigits:(NSString *)digits
+{
+    for (NSUInteger i = 0; i < digits.length; i++) {
+        unichar c = [digits characterAtIndex:i];
+        if (PKTIsDTMFCharacter(c) || PKTIsPauseCharacter(c))
+            [self.queuedDigits appendFormat:@"%C", c];
+    }
+    [self resume];
+}
+
+- (void)resume
+{
+    while (!self.waiting && self.queuedDigits.length && self.connection.state == TCConnectionStateConnected) {
+        unichar first = [self.queuedDigits characterAtIndex:0];
+        if (PKTIsPauseCharacter(first)) {
+            [self.queuedDigits deleteCharactersInRange:NSMakeRange(0, 1)];
+            [self waitFor:self.pauseInterval];
+            continue;
+        }
+
+        NSUInteger length = 1;
+        if (self.interDigitInterval <= 0) {
+            while (length < self.queuedDigits.length && !PKTIsPauseCharacter([self.queuedDigits characterAtIndex:length]))
+                length++;
+        }
+        NSString *digits = [self.queuedDigits substringToIndex:length];
+        [self.queuedDigits deleteCharactersInRange:NSMakeRange(0, length)];
+
+        [self.connection sendDigits:digits];
+        if (self.emitHandler)
+            self.emitHandler(digits, PKTMonotonicTime());
+
+        if (self.interDigitInterval > 0 && self.queuedDigits.length)
+            [self waitFor:self.interDigitInterval];
+    }
+}
+
+- (void)cancel
+{
+    [self.queuedDigits setString:@""];
+    self.waiting = NO;
+    self.generation++;
+}
+
+#pragma mark - Helpers
+
+- (void)waitFor:(NSTimeInterval)interval
+{
+    self.waiting = YES;
+    NSUInteger generation = self.generation;
+    __weak PKTDigitSender *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(interval, 0) * NSEC_PER_SEC)), self.queue, ^{
+        PKTDigitSender *sender = weakSelf;
+        if (!sender || sender.generation != generation)
+            return;
+        sender.waiting = NO;
+        [sender resume];
+    });
+}
+
+@end
@@ -0,0 +1,24 @@
+#import <Foundation/Foundation.h>
+
+// A fixed-size latency histogram. Values are bucketed log-linearly (16
+// buckets per power of two of microseconds), so any percentile is accurate
+// to about 6% from 1µs up to days, recording is a few instructions plus a
+// lock, and memory doesn't grow with the number of samples.
+//
+// Safe to use from any thread.
+@interface PKTLatencyHistogram : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger     count;
+@property (nonatomic, assign, readonly) NSTimeInterval minimum;
+@property (nonatomic, assign, readonly) NSTimeInterval maximum;
+@property (nonatomic, assign, readonly) NSTimeInterval mean;
+
+// seconds; negative values are ignored
+- (void)recordValue:(NSTimeInterval)value;
+
+// percentile in 0...100, e.g. 99 for p99; 0 if nothing has been recorded
+- (NSTimeInterval)valueAtPercentile:(double)percentile;
+
+- (void)reset;
+
+@end
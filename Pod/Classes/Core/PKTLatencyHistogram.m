@@ -0,0 +1,128 @@
+#import "PKTLatencyHistogram.h"
+
+static const NSUInteger kPKTHistogramSubBuckets = 16;                                 // per power of two
+static const NSUInteger kPKTHistogramBuckets    = kPKTHistogramSubBuckets * 38;      // up to 2^41µs
+
+// values below 16µs get a bucket each; above that, bucket by the top 5 bits
+static NSUInteger PKTHistogramBucketForMicroseconds(uint64_t us)
+{
+    if (us < kPKTHistogramSubBuckets)
+        return (NSUInteger)us;
+
+    unsigned msb     = 63 - __builtin_clzll(us);  // >= 4
+    NSUInteger index = (msb - 3) * kPKTHistogramSubBuckets + ((us >> (msb - 4)) & (kPKTHistogramSubBuckets - 1));
+    return MIN(index, kPKTHistogramBuckets - 1);
+}
+
+static uint64_t PKTHistogramBucketLowerBound(NSUInteger index)
+{
+    if (index < kPKTHistogramSubBuckets)
+        return index;
+
+    unsigned msb = (unsigned)(index / kPKTHistogramSubBuckets) + 3;
+    return (uint64_t)(kPKTHistogramSubBuckets + index % kPKTHistogramSubBuckets) << (msb - 4);
+}
+
+static uint64_t PKTHistogramBucketWidth(NSUInteger index)
+{
+    if (index < kPKTHistogramSubBuckets)
+        return 1;
+    return (uint64_t)1 << ((index / kPKTHistogramSubBuckets) - 1);
+}
+
+@implementation PKTLatencyHistogram
+{
+    uint32_t       _buckets[kPKTHistogramBuckets];
+    NSUInteger     _count;
+    NSTimeInterval _minimum;
+    NSTimeInterval _maximum;
+    NSTimeInterval _sum;
+}
+
+- (NSUInteger)count
+{
+    @synchronized(self) {
+        return _count;
+    }
+}
+
+- (NSTimeInterval)minimum
+{
+    @synchronized(self) {
+        return _minimum;
+    }
+}
+
+- (NSTimeInterval)maximum
+{
+    @synchronized(self) {
+        return _maximum;
+    }
+}
+
+- (NSTimeInterval)mean
+{
+    @synchronized(self) {
+        return _count ? _sum / _count : 0;
+    }
+}
+
+- (void)recordValue:(NSTimeInterval)value
+{
+    if (!(value >= 0))
+        return;
+
+    NSUInteger bucket = PKTHistogramBucketForMicroseconds((uint64_t)(value * USEC_PER_SEC));
+    @synchronized(self) {
+        if (_buckets[bucket] == UINT32_MAX)
+            return;
+
+        _buckets[bucket]++;
+        _minimum = _count ? MIN(_minimum, value) : value;
+        _maximum = _count ? MAX(_maximum, value) : value;
+        _sum    += value;
+        _count++;
+    }
+}
+
+- (NSTimeInterval)valueAtPercentile:(double)percentile
+{
+    @synchronized(self) {
+        if (!_count)
+            return 0;
+
+        uint64_t rank = (uint64_t)ceil(MAX(0, MIN(percentile, 100)) / 100 * _count);
+        rank = MAX(rank, 1);
+
+        uint64_t seen = 0;
+        for (NSUInteger i = 0; i < kPKTHistogramBuckets; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                // the middle of the bucket, kept inside what was actually seen
+                double us = PKTHistogramBucketLowerBound(i) + PKTHistogramBucketWidth(i) / 2.0;
+                return MAX(_minimum, MIN(_maximum, us / USEC_PER_SEC));
+            }
+        }
+        return _maximum;
+    }
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        memset(_buckets, 0, sizeof(_buckets));
+        _count   = 0;
+        _minimum = 0;
+        _maximum = 0;
+        _sum     = 0;
+    }
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p n=%lu p50=%.1fms p95=%.1fms p99=%.1fms>", [self class], self,
+            (unsigned long)self.count, [self valueAtPercentile:50] * 1000,
+            [self valueAtPercentile:95] * 1000, [self valueAtPercentile:99] * 1000];
+}
+
+@end
@@ -0,0 +1,35 @@
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSUInteger, PKTNumberMatch) {
+    PKTNumberMatchExact,     // same digits, with any script's digits folded to ASCII
+    PKTNumberMatchNational,  // same digits ignoring a leading 1, as sanitizeNumberAndRemoveOne
+    PKTNumberMatchLast10,    // same last 10 digits
+    PKTNumberMatchLast7,     // same last 7 digits
+};
+
+// An immutable index over a list of phone numbers (e.g. an address book),
+// normalized once up front into packed digit keys so that each lookup is a
+// binary search with no string work on the indexed side.
+//
+// Digits from any script (Arabic-Indic, fullwidth, ...) count as their ASCII
+// values, unlike -[NSString equalsPhoneNumber:], which compares them as written.
+// Client numbers ("client:alice") only ever match exactly, by client name.
+// Numbers longer than 16 digits are keyed on their last 16.
+@interface PKTNumberIndex : NSObject
+
+@property (nonatomic, strong, readonly) NSArray    *numbers;
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+- (instancetype)initWithNumbers:(NSArray *)numbers;
+
+// indexes into numbers of every entry matching number
+- (NSIndexSet *)indexesOfNumber:(NSString *)number match:(PKTNumberMatch)match;
+// lowest such index, or NSNotFound
+- (NSUInteger)indexOfNumber:(NSString *)number match:(PKTNumberMatch)match;
+
+// Reconciles a whole batch (e.g. a call history) in one sort-merge pass.
+// Returns an array parallel to numbers holding, for each one, the NSNumber
+// index of its first matching entry, or NSNull.
+- (NSArray *)matchNumbers:(NSArray *)numbers match:(PKTNumberMatch)match;
+
+@end
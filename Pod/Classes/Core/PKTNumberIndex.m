@@ -0,0 +1,218 @@
+#import "PKTNumberIndex.h"
+#import "PKTNumberNormalizer.h"
+#import "NSString+PKTHelpers.h"
+
+#define PKT_MAX_KEY_DIGITS 16
+#define PKT_MATCH_KINDS    4
+
+typedef struct {
+    uint64_t key;
+    uint32_t index;
+} PKTNumberSlot;
+
+static int PKTCompareSlots(const void *a, const void *b)
+{
+    const PKTNumberSlot *x = a, *y = b;
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+// one nibble per digit, stored as digit + 1 so numbers of different lengths
+// (and leading zeros) never collide; 0 means "no key"
+static uint64_t PKTPackDigits(const uint8_t *ring, NSUInteger count, NSUInteger n)
+{
+    uint64_t key = 0;
+    for (NSUInteger i = count - n; i < count; i++) {
+        key = (key << 4) | (uint64_t)(ring[i % PKT_MAX_KEY_DIGITS] + 1);
+    }
+    return key;
+}
+
+static void PKTNumberKeys(const unichar *chars, NSUInteger length, uint64_t keys[PKT_MATCH_KINDS])
+{
+    uint8_t ring[PKT_MAX_KEY_DIGITS];
+    NSUInteger count = 0;
+    int first        = -1;
+    for (NSUInteger i = 0; i < length; i++) {
+        int value = PKTDigitValue(chars[i]);
+        if (value < 0)
+            continue;
+        if (first < 0)
+            first = value;
+        ring[count % PKT_MAX_KEY_DIGITS] = value;
+        count++;
+    }
+
+    NSUInteger national = count - (first == 1);
+    keys[PKTNumberMatchExact]    = PKTPackDigits(ring, count, MIN(count, PKT_MAX_KEY_DIGITS));
+    keys[PKTNumberMatchNational] = PKTPackDigits(ring, count, MIN(national, PKT_MAX_KEY_DIGITS));
+    keys[PKTNumberMatchLast10]   = count >= 10 ? PKTPackDigits(ring, count, 10) : 0;
+    keys[PKTNumberMatchLast7]    = count >= 7  ? PKTPackDigits(ring, count, 7)  : 0;
+}
+
+// as PKTCharactersAreClientNumber, but with digits from any script folded to
+// ASCII first, so "+1 (٤١٥) ５５５-0123" is a phone number like the digits it keys on
+static BOOL PKTFoldedCharactersAreClientNumber(const unichar *chars, NSUInteger length)
+{
+    for (NSUInteger i = 0; i < length; i++) {
+        int value = PKTDigitValue(chars[i]);
+        unichar folded = value < 0 ? chars[i] : (unichar)('0' + value);
+        if (PKTCharactersAreClientNumber(&folded, 1))
+            return YES;
+    }
+    return NO;
+}
+
+// returns the client name if number is a client number, else fills keys
+static NSString *PKTKeysForNumber(NSString *number, uint64_t keys[PKT_MATCH_KINDS])
+{
+    memset(keys, 0, sizeof(uint64_t) * PKT_MATCH_KINDS);
+    if (![number isKindOfClass:[NSString class]])
+        return nil;
+
+    PKTCharacterBuffer chars;
+    PKTCharacterBufferInit(&chars, number);
+    BOOL isClient = PKTFoldedCharactersAreClientNumber(chars.characters, chars.length);
+    if (!isClient)
+        PKTNumberKeys(chars.characters, chars.length, keys);
+    PKTCharacterBufferRelease(&chars);
+
+    return isClient ? [number sanitizeNumber] : nil;
+}
+
+@interface PKTNumberIndex () {
+    PKTNumberSlot *_slots[PKT_MATCH_KINDS];
+    NSUInteger    _slotCounts[PKT_MATCH_KINDS];
+}
+
+@property (nonatomic, strong) NSDictionary *clientIndexes;
+
+@end
+
+@implementation PKTNumberIndex
+
+- (instancetype)initWithNumbers:(NSArray *)numbers
+{
+    if (self = [super init]) {
+        _numbers = [numbers copy];
+        NSMutableDictionary *clients = [NSMutableDictionary dictionary];
+
+        for (NSUInteger m = 0; m < PKT_MATCH_KINDS; m++) {
+            _slots[m] = malloc(MAX(_numbers.count, 1) * sizeof(PKTNumberSlot));
+        }
+        for (NSUInteger i = 0; i < _numbers.count; i++) {
+            uint64_t keys[PKT_MATCH_KINDS];
+            NSString *client = PKTKeysForNumber(_numbers[i], keys);
+            if (client) {
+                NSMutableIndexSet *indexes = clients[client] ?: (clients[client] = [NSMutableIndexSet indexSet]);
+                [indexes addIndex:i];
+                continue;
+            }
+            for (NSUInteger m = 0; m < PKT_MATCH_KINDS; m++) {
+                if (keys[m])
+                    _slots[m][_slotCounts[m]++] = (PKTNumberSlot){keys[m], (uint32_t)i};
+            }
+        }
+        for (NSUInteger m = 0; m < PKT_MATCH_KINDS; m++) {
+            qsort(_slots[m], _slotCounts[m], sizeof(PKTNumberSlot), PKTCompareSlots);
+        }
+        _clientIndexes = clients;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger m = 0; m < PKT_MATCH_KINDS; m++) {
+        free(_slots[m]);
+    }
+}
+
+- (NSUInteger)count
+{
+    return self.numbers.count;
+}
+
+#pragma mark - Lookup
+
+- (NSUInteger)lowerBoundOfKey:(uint64_t)key match:(PKTNumberMatch)match
+{
+    const PKTNumberSlot *slots = _slots[match];
+    NSUInteger lo = 0, hi = _slotCounts[match];
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (slots[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+- (NSIndexSet *)indexesOfNumber:(NSString *)number match:(PKTNumberMatch)match
+{
+    uint64_t keys[PKT_MATCH_KINDS];
+    NSString *client = PKTKeysForNumber(number, keys);
+    if (client)
+        return [self.clientIndexes[client] copy] ?: [NSIndexSet indexSet];
+
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    uint64_t key = keys[match];
+    if (!key)
+        return indexes;
+
+    for (NSUInteger i = [self lowerBoundOfKey:key match:match]; i < _slotCounts[match] && _slots[match][i].key == key; i++) {
+        [indexes addIndex:_slots[match][i].index];
+    }
+    return indexes;
+}
+
+- (NSUInteger)indexOfNumber:(NSString *)number match:(PKTNumberMatch)match
+{
+    uint64_t keys[PKT_MATCH_KINDS];
+    NSString *client = PKTKeysForNumber(number, keys);
+    if (client)
+        return self.clientIndexes[client] ? [self.clientIndexes[client] firstIndex] : NSNotFound;
+
+    uint64_t key = keys[match];
+    NSUInteger i = [self lowerBoundOfKey:key match:match];
+    return (key && i < _slotCounts[match] && _slots[match][i].key == key) ? _slots[match][i].index : NSNotFound;
+}
+
+- (NSArray *)matchNumbers:(NSArray *)numbers match:(PKTNumberMatch)match
+{
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:numbers.count];
+    PKTNumberSlot *queries  = malloc(MAX(numbers.count, 1) * sizeof(PKTNumberSlot));
+    NSUInteger queryCount   = 0;
+
+    for (NSUInteger q = 0; q < numbers.count; q++) {
+        uint64_t keys[PKT_MATCH_KINDS];
+        NSString *client  = PKTKeysForNumber(numbers[q], keys);
+        NSIndexSet *found = client ? self.clientIndexes[client] : nil;
+        [results addObject:found ? @([found firstIndex]) : [NSNull null]];
+        if (keys[match])
+            queries[queryCount++] = (PKTNumberSlot){keys[match], (uint32_t)q};
+    }
+    qsort(queries, queryCount, sizeof(PKTNumberSlot), PKTCompareSlots);
+
+    // both sides are sorted by key, and the index's slots by entry within a
+    // key, so the first slot we meet for a key is the lowest matching entry
+    const PKTNumberSlot *slots = _slots[match];
+    NSUInteger i = 0, j = 0;
+    while (i < _slotCounts[match] && j < queryCount) {
+        if (slots[i].key < queries[j].key) {
+            i++;
+        } else if (slots[i].key > queries[j].key) {
+            j++;
+        } else {
+            results[queries[j].index] = @(slots[i].index);
+            j++;
+        }
+    }
+
+    free(queries);
+    return results;
+}
+
+@end
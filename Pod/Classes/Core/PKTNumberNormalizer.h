@@ -0,0 +1,38 @@
+#import <Foundation/Foundation.h>
+
+// Single-pass, allocation-free phone number normalization over UTF-16 buffers.
+// NSString+PKTHelpers is built on these; use them directly when normalizing
+// large batches (call logs, address books) into your own buffers.
+
+// Writes the decimal digits found in chars (any Unicode decimal digit, as
+// -[NSString stripToDigitsOnly] keeps) into buffer, stopping at capacity.
+// Returns the total number of digits, which may exceed capacity.
+extern NSUInteger PKTNormalizeDigits(const unichar *chars, NSUInteger length,
+                                     unichar *buffer, NSUInteger capacity);
+
+// YES if chars contain anything other than ASCII digits, "+-()", spaces and
+// non-breaking spaces, i.e. it names a Twilio client rather than a phone.
+extern BOOL PKTCharactersAreClientNumber(const unichar *chars, NSUInteger length);
+
+// Numeric value of a decimal digit from any script (ASCII, Arabic-Indic,
+// fullwidth, ...), or -1 if c isn't one.
+extern int PKTDigitValue(unichar c);
+
+// Compares the digits of two buffers without materializing either.
+extern BOOL PKTDigitsEqual(const unichar *a, NSUInteger aLength,
+                           const unichar *b, NSUInteger bLength);
+
+// Borrowed view of an NSString's UTF-16 contents: points straight at the
+// string's storage when possible, else copies into an inline stack buffer,
+// and only touches the heap for unusually long strings.
+#define PKT_INLINE_CHARACTER_COUNT 64
+
+typedef struct {
+    const unichar *characters;
+    NSUInteger    length;
+    unichar       *heapStorage;
+    unichar       inlineStorage[PKT_INLINE_CHARACTER_COUNT];
+} PKTCharacterBuffer;
+
+extern void PKTCharacterBufferInit(PKTCharacterBuffer *buffer, NSString *string);
+extern void PKTCharacterBufferRelease(PKTCharacterBuffer *buffer);
@@ -0,0 +1,142 @@
+#import "PKTNumberNormalizer.h"
+
+enum {
+    PKTCharClassDigit      = 1 << 0,
+    PKTCharClassPhoneChar  = 1 << 1, // allowed in a phone number, see PKTCharactersAreClientNumber
+};
+
+static const uint8_t kPKTASCIICharClasses[128] = {
+    ['0'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['1'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['2'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['3'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['4'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['5'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['6'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['7'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['8'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['9'] = PKTCharClassDigit | PKTCharClassPhoneChar,
+    ['+'] = PKTCharClassPhoneChar,
+    ['-'] = PKTCharClassPhoneChar,
+    ['('] = PKTCharClassPhoneChar,
+    [')'] = PKTCharClassPhoneChar,
+    [' '] = PKTCharClassPhoneChar,
+};
+
+static const unichar kPKTNonBreakingSpace = 0x00A0;
+
+// the '0' of every run of ten decimal digits in the BMP, in order
+static const unichar kPKTDigitZeros[] = {
+    0x0030, 0x0660, 0x06F0, 0x07C0, 0x0966, 0x09E6, 0x0A66, 0x0AE6, 0x0B66, 0x0BE6,
+    0x0C66, 0x0CE6, 0x0D66, 0x0DE6, 0x0E50, 0x0ED0, 0x0F20, 0x1040, 0x1090, 0x17E0,
+    0x1810, 0x1946, 0x19D0, 0x1A80, 0x1A90, 0x1B50, 0x1BB0, 0x1C40, 0x1C50, 0xA620,
+    0xA8D0, 0xA900, 0xA9D0, 0xA9F0, 0xAA50, 0xABF0, 0xFF10,
+};
+
+static CFCharacterSetRef PKTDecimalDigitSet(void)
+{
+    static CFCharacterSetRef digits = NULL;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        digits = CFCharacterSetGetPredefined(kCFCharacterSetDecimalDigit);
+    });
+    return digits;
+}
+
+static inline BOOL PKTIsDigit(unichar c)
+{
+    if (c < 128)
+        return kPKTASCIICharClasses[c] & PKTCharClassDigit;
+    return CFCharacterSetIsCharacterMember(PKTDecimalDigitSet(), c);
+}
+
+// index of the next digit at or after i, or length if there are none
+static inline NSUInteger PKTNextDigit(const unichar *chars, NSUInteger i, NSUInteger length)
+{
+    while (i < length && !PKTIsDigit(chars[i]))
+        i++;
+    return i;
+}
+
+int PKTDigitValue(unichar c)
+{
+    if (c < 128)
+        return (kPKTASCIICharClasses[c] & PKTCharClassDigit) ? c - '0' : -1;
+
+    NSUInteger lo = 0, hi = sizeof(kPKTDigitZeros) / sizeof(kPKTDigitZeros[0]);
+    while (hi - lo > 1) {
+        NSUInteger mid = (lo + hi) / 2;
+        if (kPKTDigitZeros[mid] <= c)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    unichar offset = c - kPKTDigitZeros[lo];
+    return offset < 10 ? offset : -1;
+}
+
+NSUInteger PKTNormalizeDigits(const unichar *chars, NSUInteger length,
+                              unichar *buffer, NSUInteger capacity)
+{
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = chars[i];
+        if (PKTIsDigit(c)) {
+            if (count < capacity)
+                buffer[count] = c;
+            count++;
+        }
+    }
+    return count;
+}
+
+BOOL PKTCharactersAreClientNumber(const unichar *chars, NSUInteger length)
+{
+    for (NSUInteger i = 0; i < length; i++) {
+        unichar c = chars[i];
+        if (c < 128 ? !(kPKTASCIICharClasses[c] & PKTCharClassPhoneChar) : c != kPKTNonBreakingSpace)
+            return YES;
+    }
+    return NO;
+}
+
+BOOL PKTDigitsEqual(const unichar *a, NSUInteger aLength,
+                    const unichar *b, NSUInteger bLength)
+{
+    NSUInteger i = PKTNextDigit(a, 0, aLength);
+    NSUInteger j = PKTNextDigit(b, 0, bLength);
+    while (i < aLength && j < bLength) {
+        if (a[i] != b[j])
+            return NO;
+        i = PKTNextDigit(a, i + 1, aLength);
+        j = PKTNextDigit(b, j + 1, bLength);
+    }
+    return i == aLength && j == bLength;
+}
+
+#pragma mark - Character Buffers
+
+void PKTCharacterBufferInit(PKTCharacterBuffer *buffer, NSString *string)
+{
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    buffer->length       = string.length;
+    buffer->heapStorage  = NULL;
+    buffer->characters   = cfString ? CFStringGetCharactersPtr(cfString) : NULL;
+    if (buffer->characters || !buffer->length)
+        return;
+
+    unichar *storage = buffer->inlineStorage;
+    if (buffer->length > PKT_INLINE_CHARACTER_COUNT) {
+        storage = buffer->heapStorage = malloc(buffer->length * sizeof(unichar));
+    }
+    [string getCharacters:storage range:NSMakeRange(0, buffer->length)];
+    buffer->characters = storage;
+}
+
+void PKTCharacterBufferRelease(PKTCharacterBuffer *buffer)
+{
+    free(buffer->heapStorage);
+    buffer->heapStorage = NULL;
+    buffer->characters  = NULL;
+    buffer->length      = 0;
+}
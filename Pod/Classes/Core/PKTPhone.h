@@ -1,13 +1,39 @@
 #import <Foundation/Foundation.h>
 #import "ReactiveCocoa.h"
-#import "TwilioClient.h"
+#import "PKTBackend.h"
 #import "PKTCallRecord.h"
+#import "PKTCallHistory.h"
+#import "PKTCallSessionManager.h"
+#import "PKTPresenceRoster.h"
+#import "PKTCallMetrics.h"
+#import "PKTTokenManager.h"
+#import "PKTDigitSender.h"
+#import "PKTAreaCodeGeocoder.h"
+#import "PKTDialSuggester.h"
+
+// Posted on delegateQueue alongside callEndedWithRecord:error:, for observers
+// other than the delegate. The error key is absent for a normal hangup.
+extern NSString *const PKTPhoneCallDidEndNotification;
+extern NSString *const PKTPhoneCallRecordKey;
+extern NSString *const PKTPhoneCallErrorKey;
+// Posted on delegateQueue alongside callConnected, with the connection's
+// parameters ("callee" for outgoing calls, "From" for incoming ones)
+extern NSString *const PKTPhoneCallDidConnectNotification;
+extern NSString *const PKTPhoneCallParamsKey;
+extern NSString *const PKTPhoneCallIncomingKey;
+
+extern NSString *const PKTPhoneErrorDomain;
+typedef NS_ENUM(NSInteger, PKTPhoneError) {
+    PKTPhoneErrorDeviceBusy = 1,  // TwilioSDK returned no connection for a call
+};
 
 @protocol PKTPhoneDelegate <NSObject>
 @optional
 - (void)callStartedWithParams:(NSDictionary *)params incoming:(BOOL)incoming;
 - (void)callConnected;
 - (void)callEndedWithRecord:(PKTCallRecord *)record error:(NSError *)error;
+// digits actually handed to the connection, and when (PKTMonotonicTime())
+- (void)sentDigits:(NSString *)digits atTime:(NSTimeInterval)time;
 @end
 
 typedef NS_ENUM(NSUInteger, IncomingCallResponse) {
@@ -16,31 +42,78 @@ typedef NS_ENUM(NSUInteger, IncomingCallResponse) {
     PKTCallResponseReject
 };
 
+// Call state is owned by a private serial call-control queue: TwilioSDK
+// callbacks and the call actions below (call:, hangup, respondToIncomingCall:,
+// ...) hop onto it, so a busy main thread doesn't hold up call handling.
+// Delegate callbacks are delivered on delegateQueue.
 @interface PKTPhone : NSObject<TCDeviceDelegate, TCConnectionDelegate>
 
 @property (nonatomic, weak            ) id             delegate;
+// serial queue for delegate callbacks; default main queue. Callbacks that
+// pile up while it's busy are delivered together, with a ring that has
+// already ended left unannounced.
+@property (nonatomic, strong          ) dispatch_queue_t delegateQueue;
 
 @property (nonatomic, strong          ) NSString       *capabilityToken;
 @property (nonatomic, strong          ) NSString       *callerId;
 @property (nonatomic, assign          ) BOOL           muted;
 @property (nonatomic, assign          ) BOOL           speakerEnabled;
-@property (nonatomic, strong, readonly) NSArray        *presenceContactsExceptMe;
+// pacing for sendDigits:; see PKTDigitSender. Apply to calls that haven't sent digits yet.
+@property (nonatomic, assign          ) NSTimeInterval interDigitInterval;  // default 0: runs go out together
+@property (nonatomic, assign          ) NSTimeInterval digitPauseInterval;  // default 0.5, for each "w"
+@property (nonatomic, strong, readonly) NSArray        *presenceContactsExceptMe;  // presenceRoster.names
 @property (nonatomic, assign, readonly) TCDeviceState  state;
-@property (nonatomic, assign, readonly) NSTimeInterval callDuration;
+@property (nonatomic, assign, readonly) NSTimeInterval callDuration;  // computed on each read; not KVO-observable
 @property (nonatomic, assign, readonly) BOOL           hasActiveCall;
 @property (nonatomic, assign, readonly) BOOL           hasPendingCall;
+@property (nonatomic, assign, readonly) NSUInteger     callCount;  // calls not yet ended: ringing or live
+
+@property (nonatomic, strong          ) PKTCallHistory *callHistory;  // if set, every finished call is appended
+// fills in the city and state of call records that Twilio didn't; default
+// PKTAreaCodeGeocoder.NANPGeocoder, nil to turn off
+@property (nonatomic, strong          ) PKTAreaCodeGeocoder *geocoder;
+// if set, learns from every finished call
+@property (nonatomic, strong          ) PKTDialSuggester    *dialSuggester;
+
+// if set, it's started and keeps capabilityToken fresh; calls made while the
+// token has expired wait for a new one
+@property (nonatomic, strong          ) PKTTokenManager *tokenManager;
+
+// created from capabilityToken as a TCDevice, unless another PKTDevice
+// (e.g. a PKTFakeDevice) is assigned first; an assigned device's delegate is
+// set to the phone
+@property (nonatomic, strong          ) id<PKTDevice>     phoneDevice;
+@property (atomic,    strong, readonly) id<PKTConnection> activeConnection;
+@property (atomic,    strong, readonly) id<PKTConnection> pendingIncomingConnection;
+// only touched on the call-control queue; don't call into it directly
+@property (nonatomic, strong, readonly) PKTCallSessionManager *sessionManager;
+// observe PKTPresenceRosterDidChangeNotification on it for row-level diffs
+@property (nonatomic, strong, readonly) PKTPresenceRoster     *presenceRoster;
+
+// call-setup latency; set metrics.enabled to start recording
+@property (nonatomic, strong, readonly) PKTCallMetrics        *metrics;
 
-@property (nonatomic, strong          ) TCDevice       *phoneDevice;
-@property (nonatomic, strong          ) TCConnection   *activeConnection;
-@property (nonatomic, strong          ) TCConnection   *pendingIncomingConnection;
+// sends callDuration about once a second while a call is connected, and
+// once more when there's no live call; nothing ticks unless something is
+// subscribed
+@property (nonatomic, strong, readonly) RACSignal *callDurationSignal;
 
 + (instancetype)sharedPhone;
 
+// refused while another call is in progress: TwilioSDK won't dial while busy.
+// if it turns the call away anyway, there's no callStartedWithParams:, only a
+// callEndedWithRecord:error: with PKTPhoneErrorDeviceBusy and a record that
+// isn't saved to callHistory
 - (void)call:(NSString *)callee;
 - (void)call:(NSString *)callee withParams:(NSDictionary *)params;
+// queued on the live call, including while it's still connecting, and sent
+// once it's connected; "w" pauses for digitPauseInterval
 - (void)sendDigits:(NSString *)digitsString;
 - (void)hangup;
 
+// TwilioSDK can't answer while the device is busy, so accepting a waiting
+// call hangs up the one in progress and answers once it's ended
 - (void)respondToIncomingCall:(IncomingCallResponse)response;
+- (void)respondToIncomingCall:(IncomingCallResponse)response withCallSid:(NSString *)callSid;
 
 @end
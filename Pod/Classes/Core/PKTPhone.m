@@ -5,9 +5,55 @@
 #import "PKTCallRecord.h"
 #import "NSString+PKTHelpers.h"
 
-@interface PKTPhone ()
+NSString *const PKTPhoneCallDidEndNotification = @"PKTPhoneCallDidEndNotification";
+NSString *const PKTPhoneCallRecordKey          = @"record";
+NSString *const PKTPhoneCallErrorKey           = @"error";
+NSString *const PKTPhoneCallDidConnectNotification = @"PKTPhoneCallDidConnectNotification";
+NSString *const PKTPhoneCallParamsKey              = @"params";
+NSString *const PKTPhoneCallIncomingKey            = @"incoming";
+NSString *const PKTPhoneErrorDomain                = @"PKTPhoneErrorDomain";
+
+static void *kPKTPhoneControlQueueKey = &kPKTPhoneControlQueueKey;
+
+typedef NS_ENUM(NSUInteger, PKTPhoneEventType) {
+    PKTPhoneEventCallStarted,
+    PKTPhoneEventCallConnected,
+    PKTPhoneEventCallEnded,
+    PKTPhoneEventDigitsSent,
+};
+
+// one PKTPhoneDelegate callback waiting to be delivered
+@interface PKTPhoneEvent : NSObject
+
+@property (nonatomic, assign) PKTPhoneEventType type;
+@property (nonatomic, strong) NSString          *callSid;
+@property (nonatomic, strong) NSDictionary      *params;
+@property (nonatomic, assign) BOOL              incoming;
+@property (nonatomic, strong) PKTCallRecord     *record;
+@property (nonatomic, strong) NSError           *error;
+@property (nonatomic, strong) NSString          *digits;
+@property (nonatomic, assign) NSTimeInterval    time;
+@property (nonatomic, assign) NSTimeInterval    queuedTime;
 
-@property (strong, nonatomic) NSDate *callStart;
+@end
+
+@implementation PKTPhoneEvent
+@end
+
+@interface PKTPhone () <PKTCallSessionManagerDelegate>
+
+@property (atomic, strong, readwrite) id<PKTConnection> activeConnection;
+@property (atomic, strong, readwrite) id<PKTConnection> pendingIncomingConnection;
+
+@property (nonatomic, strong) dispatch_queue_t controlQueue;
+@property (nonatomic, weak  ) PKTCallSession   *announcedSession;
+@property (nonatomic, assign) NSTimeInterval   tokenSetTime;  // for PKTCallSpanTokenReady
+@property (atomic,    assign) BOOL             applicationActive;
+// the live call's connectedTime, or 0; set on the control queue, read anywhere
+@property (atomic,    assign) NSTimeInterval   liveConnectedTime;
+
+@property (nonatomic, strong) NSMutableArray   *pendingEvents;  // guarded by @synchronized
+@property (nonatomic, assign) BOOL             eventDeliveryScheduled;
 
 @end
 
@@ -27,61 +73,119 @@
 - (id)init
 {
 	if (self = [super init]) {
-        [self setupBindingsForActiveConnection];
-        
-        //bind self.state to phoneDevice.state:  
-        RAC(self, state) = RACObserve(self.phoneDevice, state);
-        //update the audio route whenever self.speakerEnabled changes:
-        [RACObserve(self, speakerEnabled) subscribeNext:^(NSNumber *enabled) {
-            [self changeRouteToSpeaker:[enabled boolValue]];
-        }];
-        //update the phoneDevice whenever the capability token changes:
-        [[RACObserve(self, capabilityToken) ignore:nil] subscribeNext:^(NSString *token) {
-            if (self.phoneDevice)
-                [self.phoneDevice updateCapabilityToken:token];
-            else {
-                self.phoneDevice = [[TCDevice alloc] initWithCapabilityToken:token delegate:self];
-            }
-        }];
-        
-        RACSignal *didBecomeActive = [[NSNotificationCenter defaultCenter]
-                                      rac_addObserverForName:UIApplicationDidBecomeActiveNotification  object:nil];
-        [didBecomeActive subscribeNext:^(id _) {
-            [self informOfPendingCall];
-        }];
-        
-		_presenceContactsExceptMe = @[];
+        _sessionManager          = [PKTCallSessionManager new];
+        _sessionManager.delegate = self;
+        _metrics                 = [PKTCallMetrics new];
+        _controlQueue            = dispatch_queue_create("com.phonekit.call-control", DISPATCH_QUEUE_SERIAL);
+        _delegateQueue           = dispatch_get_main_queue();
+        _pendingEvents           = [NSMutableArray array];
+        _digitPauseInterval      = 0.5;
+        _applicationActive       = [UIApplication sharedApplication].applicationState == UIApplicationStateActive;
+        dispatch_queue_set_specific(_controlQueue, kPKTPhoneControlQueueKey, kPKTPhoneControlQueueKey, NULL);
+        _presenceRoster = [PKTPresenceRoster new];
+        _geocoder       = [PKTAreaCodeGeocoder NANPGeocoder];
+        [self setupBindings];
     }
 
 	return self;
 }
 
-- (void)setupBindingsForActiveConnection
+- (void)dealloc
 {
-    [RACObserve(self, activeConnection) subscribeNext:^(TCConnection *conn) {
-        if (conn) {
-            RAC(conn, muted) = RACObserve(self, muted);
-        } else {
-            self.muted = NO;
+    [_phoneDevice disconnectAll];
+}
+
+// Every subscription here holds the phone weakly and ends when it deallocates:
+// the KVO ones complete with it, and the notification ones are disposed with
+// it. Anything that should last only as long as one call goes in that call's
+// session.disposable instead.
+- (void)setupBindings
+{
+    @weakify(self);
+    
+    //bind self.state to phoneDevice.state:
+    RAC(self, state) = RACObserve(self, phoneDevice.state);
+    [RACObserve(self, state) subscribeNext:^(NSNumber *state) {
+        @strongify(self);
+        if (self.tokenSetTime && [state integerValue] == TCDeviceStateReady) {
+            [self.metrics recordLatency:PKTMonotonicTime() - self.tokenSetTime forSpan:PKTCallSpanTokenReady];
+            self.tokenSetTime = 0;
+        }
+    }];
+    //update the audio route whenever self.speakerEnabled changes, on the
+    //control queue, where connecting a call sets it too:
+    [RACObserve(self, speakerEnabled) subscribeNext:^(NSNumber *enabled) {
+        @strongify(self);
+        [self performOnControlQueue:^{
+            [self changeRouteToSpeaker:self.speakerEnabled];
+        }];
+    }];
+    //update the phoneDevice whenever the capability token changes:
+    [[RACObserve(self, capabilityToken) ignore:nil] subscribeNext:^(NSString *token) {
+        @strongify(self);
+        if (self.metrics.enabled)
+            self.tokenSetTime = PKTMonotonicTime();
+        if (self.phoneDevice)
+            [self.phoneDevice updateCapabilityToken:token];
+        else {
+            self.phoneDevice = [[TCDevice alloc] initWithCapabilityToken:token delegate:self];
         }
+        // the device knows the real expiry; let the token manager plan around it
+        NSNumber *expires = self.phoneDevice.capabilities[TCDeviceCapabilityExpirationKey];
+        if (expires)
+            [self.tokenManager updateExpirationDate:[NSDate dateWithTimeIntervalSince1970:[expires doubleValue]] forToken:token];
+    }];
+    [[RACObserve(self, tokenManager.token) ignore:nil] subscribeNext:^(NSString *token) {
+        @strongify(self);
+        self.capabilityToken = token;
     }];
     
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+    RACCompoundDisposable *lifetime = self.rac_deallocDisposable;
+    [lifetime addDisposable:
+     [[center rac_addObserverForName:UIApplicationDidBecomeActiveNotification object:nil]
+     subscribeNext:^(id _) {
+        @strongify(self);
+        self.applicationActive = YES;
+        [self performOnControlQueue:^{
+            [self informOfPendingCall];
+        }];
+    }]];
+    [lifetime addDisposable:
+     [[center rac_addObserverForName:UIApplicationWillResignActiveNotification object:nil]
+     subscribeNext:^(id _) {
+        @strongify(self);
+        self.applicationActive = NO;
+    }]];
     // set proximity sensor = on if using the iphone's built-in receiver:
-    RACSignal *audioRouteChanged = [[NSNotificationCenter defaultCenter]
-                                    rac_addObserverForName:AVAudioSessionRouteChangeNotification
-                                                    object:[AVAudioSession sharedInstance]];
-    
-    RAC([UIDevice currentDevice], proximityMonitoringEnabled) = [RACSignal
-    combineLatest:@[RACObserve(self, activeConnection), audioRouteChanged]
-    reduce:^NSNumber *(TCConnection *conn, NSNotification *notif){
+    [lifetime addDisposable:
+     [[center rac_addObserverForName:AVAudioSessionRouteChangeNotification object:[AVAudioSession sharedInstance]]
+     subscribeNext:^(NSNotification *notif) {
+        @strongify(self);
+        [self updateProximityMonitoring];
+    }]];
+}
 
-        return (conn && (conn.state == TCConnectionStateConnecting || conn.state == TCConnectionStateConnected))
-               ? @([[self audioOutputPorts] containsObject:AVAudioSessionPortBuiltInReceiver])
-               : @NO;
-    }];
-    //disconnect connections when phone will dealloc:
-    [self.rac_willDeallocSignal subscribeNext:^(id _) {
-        [self.phoneDevice disconnectAll];
+- (void)setPhoneDevice:(id<PKTDevice>)phoneDevice
+{
+    // a device assigned from outside (e.g. a PKTFakeDevice) reports to us too
+    phoneDevice.delegate = self;
+    _phoneDevice = phoneDevice;
+}
+
+- (void)setTokenManager:(PKTTokenManager *)tokenManager
+{
+    [_tokenManager stop];
+    _tokenManager = tokenManager;
+    [tokenManager start];
+}
+
+- (void)setMuted:(BOOL)muted
+{
+    _muted = muted;
+    // the latest value wins even if several changes queue up
+    [self performOnControlQueue:^{
+        self.activeConnection.muted = self.muted;
     }];
 }
 
@@ -93,36 +197,149 @@
 }
 
 - (void)call:(NSString *)callee withParams:(NSDictionary *)params
+{
+    if (self.tokenManager && ![self.tokenManager hasValidToken]) {
+        [self.tokenManager refreshTokenWithCompletion:^(NSString *token, NSError *error) {
+            if (token) {
+                [self performOnControlQueue:^{
+                    [self placeCall:callee withParams:params];
+                }];
+            } else {
+                NSLog(@"Error: Could not fetch a capability token: %@", error);
+            }
+        }];
+        return;
+    }
+    [self performOnControlQueue:^{
+        [self placeCall:callee withParams:params];
+    }];
+}
+
+- (void)placeCall:(NSString *)callee withParams:(NSDictionary *)params
 {
     if (!(self.phoneDevice && self.capabilityToken)) {
         NSLog(@"Error: You must set PKTPhone's capability token before you make a call");
         return;
     }
+    if (![self.sessionManager canDialOut]) {
+        NSLog(@"Error: Can't call %@ while another call is in progress", callee);
+        return;
+    }
     
+    NSTimeInterval issued = self.metrics.enabled ? PKTMonotonicTime() : 0;
     NSMutableDictionary *connectParams = [NSMutableDictionary dictionaryWithDictionary:params];
     if (callee.length)
         connectParams[@"callee"] = callee;
     if (self.callerId.length)
         connectParams[@"callerId"] = self.callerId;
-    self.activeConnection = [self.phoneDevice connect:connectParams delegate:self];
-    
-    if ([self.delegate respondsToSelector:@selector(callStartedWithParams:incoming:)]) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [self.delegate callStartedWithParams:connectParams incoming:NO];
-        });
+    PKTCallSession *session = [self.sessionManager addOutgoingConnection:[self.phoneDevice connect:connectParams delegate:self]];
+    if (!session) {
+        NSLog(@"Error: TwilioSDK turned away the call to %@", callee);
+        [self refuseCall:callee];
+        return;
+    }
+    if (issued) {
+        session.timeline = [PKTCallTimeline new];
+        [session.timeline recordEvent:PKTCallEventConnectIssued atTime:issued];
     }
+    
+    PKTPhoneEvent *event = [PKTPhoneEvent new];
+    event.type     = PKTPhoneEventCallStarted;
+    event.params   = connectParams;
+    event.incoming = NO;
+    [self queueEvent:event];
+}
+
+// reports a call that never got a connection, so its caller isn't left waiting for one to end
+- (void)refuseCall:(NSString *)callee
+{
+    PKTCallRecord *record = [PKTCallRecord new];
+    record.startTime      = [NSDate date];
+    record.number         = [callee isClientNumber] ? [callee sanitizeNumber] : callee;
+
+    PKTPhoneEvent *event = [PKTPhoneEvent new];
+    event.type   = PKTPhoneEventCallEnded;
+    event.record = record;
+    event.error  = [NSError errorWithDomain:PKTPhoneErrorDomain code:PKTPhoneErrorDeviceBusy userInfo:nil];
+    [self queueEvent:event];
 }
 
 -(void)sendDigits:(NSString*)digits
 {
-	if (self.activeConnection && self.activeConnection.state == TCConnectionStateConnected) {
-		[self.activeConnection sendDigits:digits];
-	}
+    [self performOnControlQueue:^{
+        PKTCallSession *session = self.sessionManager.liveSession;
+        if (!session) {
+            NSLog(@"Error: No call to send digits %@ to", digits);
+            return;
+        }
+        if (!session.digitSender)
+            session.digitSender = [self digitSenderForSession:session];
+        [session.digitSender enqueueDigits:digits];
+    }];
+}
+
+- (PKTDigitSender *)digitSenderForSession:(PKTCallSession *)session
+{
+    PKTDigitSender *sender    = [[PKTDigitSender alloc] initWithConnection:session.connection queue:self.controlQueue];
+    sender.interDigitInterval = self.interDigitInterval;
+    sender.pauseInterval      = self.digitPauseInterval;
+
+    __weak PKTCallSession *weakSession = session;
+    sender.emitHandler = ^(NSString *digits, NSTimeInterval time) {
+        [weakSession.timeline recordEvent:PKTCallEventFirstDigits atTime:time];
+
+        PKTPhoneEvent *event = [PKTPhoneEvent new];
+        event.type    = PKTPhoneEventDigitsSent;
+        event.callSid = weakSession.callSid;
+        event.digits  = digits;
+        event.time    = time;
+        [self queueEvent:event];
+    };
+    // digits still queued when the call ends are dropped, and the handler,
+    // which holds the phone, goes with them
+    __weak PKTDigitSender *weakSender = sender;
+    [session.disposable addDisposable:[RACDisposable disposableWithBlock:^{
+        [weakSender cancel];
+        weakSender.emitHandler = nil;
+    }]];
+    return sender;
 }
 
 - (void)hangup
 {
-    [self.activeConnection disconnect];
+    [self performOnControlQueue:^{
+        [self.activeConnection disconnect];
+    }];
+}
+
+- (NSTimeInterval)callDuration
+{
+    // read every second on the main thread, so it mustn't wait on the control queue
+    NSTimeInterval connected = self.liveConnectedTime;
+    return connected ? PKTMonotonicTime() - connected : 0;
+}
+
+- (RACSignal *)callDurationSignal
+{
+    // a timer only while there's a live call and a subscriber; the leeway lets
+    // the system fold its wakeups in with others. nothing is sent while the
+    // call is still connecting, so "connecting..." isn't overwritten by 00:00
+    @weakify(self);
+    return [[[RACObserve(self, activeConnection)
+    map:^RACSignal *(id<PKTConnection> connection) {
+        RACSignal *ticks = connection ? [[[RACSignal interval:1.0 onScheduler:[RACScheduler mainThreadScheduler] withLeeway:0.1]
+                                          startWith:nil]
+                                          filter:^BOOL(id _) {
+                                              return connection.state == TCConnectionStateConnected;
+                                          }]
+                                      : [RACSignal return:nil];
+        return [ticks map:^NSNumber *(id _) {
+            @strongify(self);
+            return @(self.callDuration);
+        }];
+    }]
+    switchToLatest]
+    deliverOn:[RACScheduler mainThreadScheduler]];
 }
 
 - (BOOL)hasActiveCall
@@ -135,24 +352,38 @@
     return self.pendingIncomingConnection != nil;
 }
 
-- (PKTCallRecord *)callRecordForConnection:(TCConnection*)connection
+- (NSUInteger)callCount
 {
-    PKTCallRecord *record = [PKTCallRecord new];
-    record.incoming   = connection.incoming;
-    record.startTime  = [NSDate dateWithTimeIntervalSinceNow:-self.callDuration];
-    record.duration   = self.callDuration;
+    __block NSUInteger count = 0;
+    [self performOnControlQueueAndWait:^{
+        count = self.sessionManager.sessions.count;
+    }];
+    return count;
+}
+
+- (PKTCallRecord *)callRecordForSession:(PKTCallSession *)session
+{
+    id<PKTConnection> connection = session.connection;
+    PKTCallRecord *record    = [PKTCallRecord new];
+    record.incoming   = session.incoming;
+    record.startTime  = session.connectedDate ?: session.startDate;
+    record.duration   = session.duration;
     if (record.incoming) {
         record.number = connection.parameters[@"From"];
-        record.city   = connection.parameters[@"FromState"];
-        record.state  = connection.parameters[@"FromCountry"];
-        record.missed = connection != self.activeConnection;
+        record.city   = connection.parameters[@"FromCity"];
+        record.state  = connection.parameters[@"FromState"];
+        record.missed = !session.answered;
     } else {
         record.number = connection.parameters[@"callee"];
-        record.city   = nil;
-        record.state  = nil;
     }
     if ([record.number isClientNumber]) {
         record.number = [record.number sanitizeNumber];
+    } else if (!record.city.length && !record.state.length) {
+        NSString *city = nil, *state = nil;
+        if ([self.geocoder getCity:&city state:&state forNumber:record.number]) {
+            record.city  = city;
+            record.state = state;
+        }
     }
     return record;
 }
@@ -161,53 +392,83 @@
 
 - (void)device:(TCDevice*)theDevice didReceiveIncomingConnection:(TCConnection*)connection
 {
-	if (!([self hasActiveCall] || [self hasPendingCall])) { // only the first incoming connection is handled,
-        // and once an active connection is established we auto-reject
-		connection.delegate = self;
-		self.pendingIncomingConnection = connection;
-        
-		if ([UIApplication sharedApplication].applicationState == UIApplicationStateActive) {
-            [self informOfPendingCall];
-        } else {
+    [self performOnControlQueue:^{
+        [self addIncomingConnection:connection];
+    }];
+}
+
+- (void)addIncomingConnection:(id<PKTConnection>)connection
+{
+    // calls arriving while we're busy are kept ringing as call-waiting sessions
+    // rather than rejected; the session manager enforces any limit.
+    PKTCallSession *session = [self.sessionManager addIncomingConnection:connection];
+    if (!session)
+        return;
+
+    if (self.metrics.enabled) {
+        session.timeline = [PKTCallTimeline new];
+        [session.timeline recordEvent:PKTCallEventRinging atTime:session.ringingTime];
+    }
+    connection.delegate = self;
+    if (self.applicationActive) {
+        [self informOfPendingCall];
+    } else {
+        NSString *from         = [connection.parameters[@"From"] sanitizeNumber] ?: @"unknown";
+        NSDictionary *callInfo = @{@"callSID": session.callSid ?: @"",
+                                   @"from": from};
+        dispatch_async(dispatch_get_main_queue(), ^{
             // Clear out the old notification before scheduling a new one.
             [[UIApplication sharedApplication] cancelAllLocalNotifications];
 
             UILocalNotification *alarm = [UILocalNotification new];
-            NSString *from             = [connection.parameters[@"From"] sanitizeNumber] ?: @"unknown";
-            NSDictionary *callInfo     = @{@"callSID": connection.parameters[TCConnectionIncomingParameterCallSIDKey],
-                                          @"from": from};
             alarm.soundName            = @"incoming.wav";
             alarm.alertBody            = [NSString stringWithFormat:@"Incoming Twilio Call From %@", from];
             alarm.userInfo             = callInfo;
-            
+
             [[UIApplication sharedApplication] scheduleLocalNotification:alarm];
-        }
-	} else {
-		[connection reject];
-	}
+        });
+    }
 }
 
 - (void)informOfPendingCall
 {
-    if ([self hasPendingCall] && ![self hasActiveCall]) {
-        if ([self.delegate respondsToSelector:@selector(callEndedWithRecord:error:)]) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [self.delegate callStartedWithParams:self.pendingIncomingConnection.parameters incoming:YES];
-            });
-        }
-    }
+    // announce the front of the ringing queue, once
+    PKTCallSession *pending = [self.sessionManager.ringingSessions firstObject];
+    if (!pending || pending == self.announcedSession)
+        return;
+    if (!self.applicationActive)
+        return;
+
+    self.announcedSession = pending;
+    PKTPhoneEvent *event = [PKTPhoneEvent new];
+    event.type     = PKTPhoneEventCallStarted;
+    event.callSid  = pending.callSid;
+    event.params   = pending.parameters;
+    event.incoming = YES;
+    [self queueEvent:event];
 }
 
 - (void)respondToIncomingCall:(IncomingCallResponse)response
 {
-    if (response == PKTCallResponseAccept) {
-        [self.pendingIncomingConnection accept];
-        self.activeConnection = self.pendingIncomingConnection;
-    } else {
-        response == PKTCallResponseReject ? [self.pendingIncomingConnection reject]
-                                          : [self.pendingIncomingConnection ignore];
-    }
-    self.pendingIncomingConnection = nil; // pending becomes active.
+    [self respondToIncomingCall:response withCallSid:nil];
+}
+
+- (void)respondToIncomingCall:(IncomingCallResponse)response withCallSid:(NSString *)callSid
+{
+    [self performOnControlQueue:^{
+        PKTCallSession *session = callSid ? [self.sessionManager sessionForCallSid:callSid]
+                                          : [self.sessionManager.ringingSessions firstObject];
+        [session.timeline recordEvent:PKTCallEventResponded];
+        switch (response) {
+            case PKTCallResponseAccept: [self.sessionManager acceptSession:session]; break;
+            case PKTCallResponseIgnore: [self.sessionManager ignoreSession:session]; break;
+            case PKTCallResponseReject:
+                // no disconnect follows a reject, so the call ends here
+                if ([self.sessionManager rejectSession:session])
+                    [self finishSession:session error:nil];
+                break;
+        }
+    }];
 }
 
 - (BOOL)shouldRingThroughSpeaker
@@ -233,90 +494,244 @@
 	if ([presenceEvent.name isEqualToString:clientName])
 		return;
     
-	NSString *contact = [self.presenceContactsExceptMe.rac_sequence objectPassingTest:^BOOL(NSString *c) {
-        return [c isEqualToString:presenceEvent.name];
-    }];
-    
-    NSMutableArray *newPresence = [self.presenceContactsExceptMe mutableCopy];
-	
-    BOOL changed = NO;
-    if (!contact && presenceEvent.available) {
-        [newPresence addObject:presenceEvent.name];
-		changed = YES;
-    }
-	else if (contact && !presenceEvent.available) {
-        [newPresence removeObject:contact];
-		changed = YES;
-    }
-	
-	if (changed) {
-		[newPresence sortUsingComparator:^(NSString *name1, NSString *name2) {
-            return [name1 localizedCaseInsensitiveCompare:name2];
-        }];
-		
-		_presenceContactsExceptMe = newPresence;
-	}
+    // queued, so a burst of events becomes one batch and one notification;
+    // the roster belongs to the main thread
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self.presenceRoster setName:presenceEvent.name available:presenceEvent.available];
+    });
+}
+
+- (NSArray *)presenceContactsExceptMe
+{
+    return self.presenceRoster.names;
 }
 
 #pragma mark - TCConnectionDelegate
 
--(void)connectionDidConnect:(TCConnection*)theConnection
+-(void)connectionDidStartConnecting:(TCConnection*)theConnection
 {
-    self.callStart = [NSDate date];
-    
-    //signal that sends next when activeConnection dies
-    RACSignal *endSignal = [RACObserve(self, activeConnection) filter:^BOOL(TCConnection *conn) {
-        return conn == nil;
-    }];
-    
-    //Every 1 second, until activeConnection is nil,
-    //set self.callDuration to the number of seconds since callStart
-    RAC(self, callDuration) = [[[RACSignal
-    interval:1.0 onScheduler:[RACScheduler mainThreadScheduler]]
-    takeUntil:endSignal]
-    map:^NSNumber *(NSDate *current) {
-        return @([current timeIntervalSinceDate:self.callStart]);
+    [self performOnControlQueue:^{
+        PKTCallSession *session = [self.sessionManager connectionDidStartConnecting:theConnection];
+        [session.timeline recordEvent:PKTCallEventConnecting];
     }];
+}
 
-	[self changeRouteToSpeaker:self.speakerEnabled];
-    
-    if ([self.delegate respondsToSelector:@selector(callConnected)]) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [self.delegate callConnected];
-        });
-    }
+-(void)connectionDidConnect:(TCConnection*)theConnection
+{
+    [self performOnControlQueue:^{
+        PKTCallSession *session = [self.sessionManager connectionDidConnect:theConnection];
+        [session.timeline recordEvent:PKTCallEventConnected atTime:session.connectedTime];
+        [session.digitSender resume];
+
+        [self changeRouteToSpeaker:self.speakerEnabled];
+
+        PKTPhoneEvent *event = [PKTPhoneEvent new];
+        event.type     = PKTPhoneEventCallConnected;
+        event.callSid  = session.callSid;
+        event.params   = session.parameters;
+        event.incoming = session.incoming;
+        [self queueEvent:event];
+    }];
 }
 
 -(void)connectionDidDisconnect:(TCConnection*)theConnection
 {
-	[self connectionDisconnected:theConnection error:nil];
+    [self performOnControlQueue:^{
+        [self connectionDisconnected:theConnection error:nil];
+    }];
 }
 
 -(void)connection:(TCConnection*)theConnection didFailWithError:(NSError*)error
 {
-	[self connectionDisconnected:theConnection error:error];
+    [self performOnControlQueue:^{
+        [self connectionDisconnected:theConnection error:error];
+    }];
 }
 
 // common behaviors whether the call disconnects normally or due to an error
 -(void)connectionDisconnected:(TCConnection*)connection error:(NSError *)error
 {
-    PKTCallRecord *record = [self callRecordForConnection:connection];
+    // one the manager isn't tracking was turned away or already finished
+    PKTCallSession *session = [self.sessionManager connectionDidDisconnect:connection];
+    if (!session)
+        return;
+    [self finishSession:session error:error];
+}
+
+// records an ended session and announces it
+- (void)finishSession:(PKTCallSession *)session error:(NSError *)error
+{
+    PKTCallRecord *record   = [self callRecordForSession:session];
+    [session.disposable dispose];
+    [session.timeline recordEvent:PKTCallEventDisconnected atTime:session.disconnectedTime ?: PKTMonotonicTime()];
+    [self.metrics finishTimeline:session.timeline];
+    
+    NSError *historyError = nil;
+    if (self.callHistory && ![self.callHistory appendRecord:record error:&historyError]) {
+        NSLog(@"Error: Could not save call record: %@", historyError);
+    }
+    [self.dialSuggester addRecord:record];
 	
-    if (connection == self.activeConnection) {
-		self.activeConnection = nil;
-		self.speakerEnabled = NO;
-	}
-    if (connection == self.pendingIncomingConnection) {
-		self.pendingIncomingConnection = nil;
+    if (!self.activeConnection) {
+        // observed by the UI, so changed on the main thread
+        dispatch_async(dispatch_get_main_queue(), ^{
+            self.speakerEnabled = NO;
+        });
 	}
     
-    if ([self.delegate respondsToSelector:@selector(callEndedWithRecord:error:)]) {
-        dispatch_async(dispatch_get_main_queue(), ^{
-            [self.delegate callEndedWithRecord:record error:error];
+    PKTPhoneEvent *event = [PKTPhoneEvent new];
+    event.type    = PKTPhoneEventCallEnded;
+    event.callSid = session.callSid;
+    event.record  = record;
+    event.error   = error;
+    [self queueEvent:event];
+}
+
+#pragma mark - PKTCallSessionManagerDelegate
+
+- (void)sessionManager:(PKTCallSessionManager *)manager
+               session:(PKTCallSession *)session
+    didChangeFromState:(PKTCallState)oldState
+{
+    id<PKTConnection> live = manager.liveSession.connection;
+    if (live != self.activeConnection) {
+        self.activeConnection = live;
+        if (live) {
+            live.muted = self.muted;
+        } else {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                self.muted = NO;
+            });
+        }
+    }
+    self.pendingIncomingConnection = [[manager.ringingSessions firstObject] connection];
+    self.liveConnectedTime         = manager.liveSession.connectedTime;
+
+    [self updateProximityMonitoring];
+    [self informOfPendingCall];
+}
+
+#pragma mark - Queues
+
+// runs block inline when already on the control queue, otherwise async
+- (void)performOnControlQueue:(dispatch_block_t)block
+{
+    if (dispatch_get_specific(kPKTPhoneControlQueueKey))
+        block();
+    else
+        dispatch_async(self.controlQueue, block);
+}
+
+- (void)performOnControlQueueAndWait:(dispatch_block_t)block
+{
+    if (dispatch_get_specific(kPKTPhoneControlQueueKey))
+        block();
+    else
+        dispatch_sync(self.controlQueue, block);
+}
+
+#pragma mark - Delegate Delivery
+
+// Events queue up until the delegate queue gets around to the one scheduled
+// delivery, which then hands over everything that has arrived since. A slow
+// delegate queue therefore sees fewer, larger batches rather than a backlog
+// of blocks.
+- (void)queueEvent:(PKTPhoneEvent *)event
+{
+    event.queuedTime = self.metrics.enabled ? PKTMonotonicTime() : 0;
+
+    BOOL schedule = NO;
+    @synchronized(self.pendingEvents) {
+        [self.pendingEvents addObject:event];
+        schedule = !self.eventDeliveryScheduled;
+        self.eventDeliveryScheduled = YES;
+    }
+    if (schedule) {
+        dispatch_async(self.delegateQueue ?: dispatch_get_main_queue(), ^{
+            [self deliverPendingEvents];
         });
     }
 }
 
+- (void)deliverPendingEvents
+{
+    NSArray *events = nil;
+    @synchronized(self.pendingEvents) {
+        events = [self.pendingEvents copy];
+        [self.pendingEvents removeAllObjects];
+        self.eventDeliveryScheduled = NO;
+    }
+
+    NSTimeInterval now = self.metrics.enabled ? PKTMonotonicTime() : 0;
+    for (PKTPhoneEvent *event in [self coalescedEvents:events]) {
+        if (event.queuedTime)
+            [self.metrics recordLatency:now - event.queuedTime forSpan:PKTCallSpanDelegateHop];
+        [self deliverEvent:event];
+    }
+}
+
+// Within a batch, a ring that has already ended isn't announced (its
+// callEnded still is), and back-to-back callConnected events for the same
+// call collapse.
+- (NSArray *)coalescedEvents:(NSArray *)events
+{
+    if (events.count < 2)
+        return events;
+
+    NSMutableSet *endedSids = [NSMutableSet set];
+    for (PKTPhoneEvent *event in events) {
+        if (event.type == PKTPhoneEventCallEnded && event.callSid)
+            [endedSids addObject:event.callSid];
+    }
+
+    NSMutableArray *coalesced = [NSMutableArray arrayWithCapacity:events.count];
+    for (PKTPhoneEvent *event in events) {
+        if (event.type == PKTPhoneEventCallStarted && event.incoming && [endedSids containsObject:event.callSid])
+            continue;
+        PKTPhoneEvent *last = [coalesced lastObject];
+        if (event.type == PKTPhoneEventCallConnected && last.type == PKTPhoneEventCallConnected &&
+            (last.callSid == event.callSid || [last.callSid isEqualToString:event.callSid]))
+            continue;
+        [coalesced addObject:event];
+    }
+    return coalesced;
+}
+
+- (void)deliverEvent:(PKTPhoneEvent *)event
+{
+    id delegate = self.delegate;
+    switch (event.type) {
+        case PKTPhoneEventCallStarted:
+            if ([delegate respondsToSelector:@selector(callStartedWithParams:incoming:)])
+                [delegate callStartedWithParams:event.params incoming:event.incoming];
+            break;
+        case PKTPhoneEventCallConnected:
+            if ([delegate respondsToSelector:@selector(callConnected)])
+                [delegate callConnected];
+            [[NSNotificationCenter defaultCenter] postNotificationName:PKTPhoneCallDidConnectNotification
+                                                                object:self
+                                                              userInfo:@{PKTPhoneCallParamsKey: event.params ?: @{},
+                                                                         PKTPhoneCallIncomingKey: @(event.incoming)}];
+            break;
+        case PKTPhoneEventCallEnded: {
+            if ([delegate respondsToSelector:@selector(callEndedWithRecord:error:)])
+                [delegate callEndedWithRecord:event.record error:event.error];
+
+            NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:event.record forKey:PKTPhoneCallRecordKey];
+            if (event.error)
+                userInfo[PKTPhoneCallErrorKey] = event.error;
+            [[NSNotificationCenter defaultCenter] postNotificationName:PKTPhoneCallDidEndNotification
+                                                                object:self
+                                                              userInfo:userInfo];
+            break;
+        }
+        case PKTPhoneEventDigitsSent:
+            if ([delegate respondsToSelector:@selector(sentDigits:atTime:)])
+                [delegate sentDigits:event.digits atTime:event.time];
+            break;
+    }
+}
+
 #pragma mark - Helpers
 
 - (void)changeRouteToSpeaker:(BOOL)speaker
@@ -327,6 +742,17 @@
     [[AVAudioSession sharedInstance] overrideOutputAudioPort:override error:nil];
 }
 
+- (void)updateProximityMonitoring
+{
+    id<PKTConnection> conn = self.activeConnection;
+    BOOL onCall        = conn && (conn.state == TCConnectionStateConnecting || conn.state == TCConnectionStateConnected);
+    BOOL enabled       = onCall && [[self audioOutputPorts] containsObject:AVAudioSessionPortBuiltInReceiver];
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [UIDevice currentDevice].proximityMonitoringEnabled = enabled;
+    });
+}
+
 - (NSArray *)audioOutputPorts
 {
     return [[[[AVAudioSession sharedInstance] currentRoute].outputs.rac_sequence
@@ -0,0 +1,34 @@
+#import <Foundation/Foundation.h>
+
+// Posted after a batch of updates changes the roster. Removed indexes refer to
+// the names before the batch and inserted indexes to the names after it, as
+// -[UITableView deleteRowsAtIndexPaths:...] and insertRows... expect.
+extern NSString *const PKTPresenceRosterDidChangeNotification;
+extern NSString *const PKTPresenceRosterRemovedIndexesKey;
+extern NSString *const PKTPresenceRosterInsertedIndexesKey;
+
+// The set of available client names, kept sorted case-insensitively.
+// Each name's collation key is computed once, when it's added. Lookups are a
+// hash probe, and adding or removing a name is a binary search plus one array
+// shift, so a burst of presence events never re-sorts the whole roster.
+//
+// Use from the main thread.
+@interface PKTPresenceRoster : NSObject
+
+@property (nonatomic, strong, readonly) NSArray    *names;
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+- (BOOL)containsName:(NSString *)name;
+- (NSUInteger)indexOfName:(NSString *)name;
+
+// Queues an update. Queued updates are applied together, with a single
+// notification, on the next turn of the main run loop; the last update for a
+// name wins.
+- (void)setName:(NSString *)name available:(BOOL)available;
+- (void)applyPendingUpdates;
+
+// name -> @YES / @NO, applied immediately as one batch
+- (void)applyUpdates:(NSDictionary *)availabilityByName;
+- (void)removeAllNames;
+
+@end
@@ -0,0 +1,178 @@
+#import "PKTPresenceRoster.h"
+
+NSString *const PKTPresenceRosterDidChangeNotification = @"PKTPresenceRosterDidChangeNotification";
+NSString *const PKTPresenceRosterRemovedIndexesKey     = @"removedIndexes";
+NSString *const PKTPresenceRosterInsertedIndexesKey    = @"insertedIndexes";
+
+@interface PKTPresenceRoster ()
+
+@property (nonatomic, strong) NSMutableArray      *sortedNames;
+@property (nonatomic, strong) NSMutableArray      *sortedKeys;    // parallel to sortedNames
+@property (nonatomic, strong) NSMutableDictionary *keysByName;
+@property (nonatomic, strong) NSMutableDictionary *pendingUpdates;
+@property (nonatomic, strong) NSArray             *namesSnapshot;
+
+@end
+
+@implementation PKTPresenceRoster
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _sortedNames    = [NSMutableArray array];
+        _sortedKeys     = [NSMutableArray array];
+        _keysByName     = [NSMutableDictionary dictionary];
+        _pendingUpdates = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSArray *)names
+{
+    if (!self.namesSnapshot)
+        self.namesSnapshot = [self.sortedNames copy];
+    return self.namesSnapshot;
+}
+
+- (NSUInteger)count
+{
+    return self.sortedNames.count;
+}
+
+- (BOOL)containsName:(NSString *)name
+{
+    return name && self.keysByName[name] != nil;
+}
+
+- (NSUInteger)indexOfName:(NSString *)name
+{
+    NSString *key = name ? self.keysByName[name] : nil;
+    if (!key)
+        return NSNotFound;
+
+    NSUInteger index = [self insertionIndexForName:name key:key];
+    return index < self.sortedNames.count && [self.sortedNames[index] isEqualToString:name] ? index : NSNotFound;
+}
+
+#pragma mark - Updates
+
+- (void)setName:(NSString *)name available:(BOOL)available
+{
+    if (!name)
+        return;
+
+    BOOL scheduled = self.pendingUpdates.count > 0;
+    self.pendingUpdates[name] = @(available);
+    if (!scheduled) {
+        __weak PKTPresenceRoster *weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf applyPendingUpdates];
+        });
+    }
+}
+
+- (void)applyPendingUpdates
+{
+    if (!self.pendingUpdates.count)
+        return;
+
+    NSDictionary *updates = [self.pendingUpdates copy];
+    [self.pendingUpdates removeAllObjects];
+    [self applyUpdates:updates];
+}
+
+- (void)applyUpdates:(NSDictionary *)availabilityByName
+{
+    NSMutableIndexSet *removed = [NSMutableIndexSet indexSet];
+    NSMutableArray *added      = [NSMutableArray array];
+
+    for (NSString *name in availabilityByName) {
+        BOOL available = [availabilityByName[name] boolValue];
+        BOOL present   = [self containsName:name];
+        if (present && !available) {
+            [removed addIndex:[self indexOfName:name]];
+        } else if (!present && available) {
+            [added addObject:name];
+        }
+    }
+    if (!removed.count && !added.count)
+        return;
+
+    // removals first, by their old positions
+    [removed enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        [self.keysByName removeObjectForKey:self.sortedNames[idx]];
+    }];
+    [self.sortedNames removeObjectsAtIndexes:removed];
+    [self.sortedKeys removeObjectsAtIndexes:removed];
+
+    for (NSString *name in added) {
+        NSString *key    = [self collationKeyForName:name];
+        NSUInteger index = [self insertionIndexForName:name key:key];
+        [self.sortedNames insertObject:name atIndex:index];
+        [self.sortedKeys insertObject:key atIndex:index];
+        self.keysByName[name] = key;
+    }
+
+    // then insertions, by their final positions
+    NSMutableIndexSet *inserted = [NSMutableIndexSet indexSet];
+    for (NSString *name in added) {
+        [inserted addIndex:[self indexOfName:name]];
+    }
+
+    self.namesSnapshot = nil;
+    [[NSNotificationCenter defaultCenter] postNotificationName:PKTPresenceRosterDidChangeNotification
+                                                        object:self
+                                                      userInfo:@{PKTPresenceRosterRemovedIndexesKey: removed,
+                                                                 PKTPresenceRosterInsertedIndexesKey: inserted}];
+}
+
+- (void)removeAllNames
+{
+    [self.pendingUpdates removeAllObjects];
+    if (!self.sortedNames.count)
+        return;
+
+    NSIndexSet *removed = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, self.sortedNames.count)];
+    [self.sortedNames removeAllObjects];
+    [self.sortedKeys removeAllObjects];
+    [self.keysByName removeAllObjects];
+
+    self.namesSnapshot = nil;
+    [[NSNotificationCenter defaultCenter] postNotificationName:PKTPresenceRosterDidChangeNotification
+                                                        object:self
+                                                      userInfo:@{PKTPresenceRosterRemovedIndexesKey: removed,
+                                                                 PKTPresenceRosterInsertedIndexesKey: [NSIndexSet indexSet]}];
+}
+
+#pragma mark - Ordering
+
+// folded once per name so that comparisons during a search skip the case
+// mapping localizedCaseInsensitiveCompare: would redo every time
+- (NSString *)collationKeyForName:(NSString *)name
+{
+    return [name stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSWidthInsensitiveSearch
+                                     locale:[NSLocale currentLocale]];
+}
+
+- (NSComparisonResult)compareName:(NSString *)name key:(NSString *)key toIndex:(NSUInteger)index
+{
+    NSComparisonResult result = [key localizedCompare:self.sortedKeys[index]];
+    // names that fold together still get a stable order
+    return result != NSOrderedSame ? result : [name compare:self.sortedNames[index]];
+}
+
+// index of name if present, else where it would go
+- (NSUInteger)insertionIndexForName:(NSString *)name key:(NSString *)key
+{
+    NSUInteger lo = 0, hi = self.sortedNames.count;
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if ([self compareName:name key:key toIndex:mid] == NSOrderedDescending)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+@end
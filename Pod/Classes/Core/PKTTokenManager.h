@@ -0,0 +1,75 @@
+#import <Foundation/Foundation.h>
+#import "PKTLatencyHistogram.h"
+
+extern NSString *const PKTTokenProviderErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTTokenProviderError) {
+    PKTTokenProviderErrorBadResponse = 1,
+    PKTTokenProviderErrorEmptyToken,
+};
+
+// expirationDate may be nil if the provider doesn't know it
+typedef void (^PKTTokenFetchCompletion)(NSString *token, NSDate *expirationDate, NSError *error);
+
+// Something that can fetch a fresh capability token, usually from your server.
+@protocol PKTTokenProvider <NSObject>
+
+// may call completion on any queue, but must call it exactly once
+- (void)fetchCapabilityTokenWithCompletion:(PKTTokenFetchCompletion)completion;
+
+@end
+
+// Fetches a token with a GET to a URL. The response body is either the token
+// itself or a JSON object with a "token" string and, optionally, "expires" in
+// seconds since 1970. Point it at a local stub server to exercise the whole
+// refresh path.
+@interface PKTURLTokenProvider : NSObject <PKTTokenProvider>
+
+@property (nonatomic, strong, readonly) NSURL  *URL;
+@property (nonatomic, assign) NSTimeInterval   timeout;  // default 15
+
+- (instancetype)initWithURL:(NSURL *)URL;
+
+@end
+
+// Keeps a capability token fresh. Once started, it refreshes refreshLeadTime
+// (less some random jitter, so a fleet of clients doesn't refresh in step)
+// before the token expires, and retries failed fetches with jittered
+// exponential backoff. Concurrent refresh requests share one fetch.
+//
+// Use from the main thread; completions and KVO notifications of token are
+// delivered there.
+@interface PKTTokenManager : NSObject
+
+@property (nonatomic, strong, readonly) id<PKTTokenProvider> provider;
+
+@property (nonatomic, strong, readonly) NSString *token;
+@property (nonatomic, strong, readonly) NSDate   *expirationDate;
+@property (nonatomic, strong, readonly) NSError  *lastError;
+@property (nonatomic, assign, readonly, getter=isRefreshing) BOOL refreshing;
+
+@property (nonatomic, assign) NSTimeInterval refreshLeadTime;       // default 60
+@property (nonatomic, assign) NSTimeInterval defaultTokenLifetime;  // used when the expiry is unknown; default 3600
+@property (nonatomic, assign) NSTimeInterval initialRetryInterval;  // default 1
+@property (nonatomic, assign) NSTimeInterval maximumRetryInterval;  // default 60
+
+// how long each successful fetch took
+@property (nonatomic, strong, readonly) PKTLatencyHistogram *fetchLatency;
+
+- (instancetype)initWithProvider:(id<PKTTokenProvider>)provider;
+
+// whether token is set and not yet expired
+- (BOOL)hasValidToken;
+
+// start fetches a token right away unless the current one is still fresh
+- (void)start;
+- (void)stop;
+
+// fetches a new token, joining a fetch already in flight
+- (void)refreshTokenWithCompletion:(void (^)(NSString *token, NSError *error))completion;
+
+// for when the expiry is learned later, e.g. from TCDeviceCapabilityExpirationKey;
+// ignored unless token is still the current one
+- (void)updateExpirationDate:(NSDate *)expirationDate forToken:(NSString *)token;
+
+@end
@@ -0,0 +1,208 @@
+#import "PKTTokenManager.h"
+#import "PKTCallSession.h"
+
+NSString *const PKTTokenProviderErrorDomain = @"PKTTokenProviderErrorDomain";
+
+@implementation PKTURLTokenProvider
+
+- (instancetype)initWithURL:(NSURL *)URL
+{
+    if (self = [super init]) {
+        _URL     = URL;
+        _timeout = 15;
+    }
+    return self;
+}
+
+- (void)fetchCapabilityTokenWithCompletion:(PKTTokenFetchCompletion)completion
+{
+    NSURLRequest *request = [NSURLRequest requestWithURL:self.URL
+                                             cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
+                                         timeoutInterval:self.timeout];
+    [NSURLConnection sendAsynchronousRequest:request
+                                       queue:[NSOperationQueue mainQueue]
+                           completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+        if (error) {
+            completion(nil, nil, error);
+            return;
+        }
+        NSInteger status = [response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse *)response statusCode] : 200;
+        if (status < 200 || status >= 300) {
+            completion(nil, nil, [NSError errorWithDomain:PKTTokenProviderErrorDomain
+                                                     code:PKTTokenProviderErrorBadResponse
+                                                 userInfo:@{NSLocalizedDescriptionKey: [NSHTTPURLResponse localizedStringForStatusCode:status]}]);
+            return;
+        }
+
+        NSString *token = nil;
+        NSDate *expires = nil;
+        id json = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+        if ([json isKindOfClass:[NSDictionary class]]) {
+            token = [json[@"token"] isKindOfClass:[NSString class]] ? json[@"token"] : nil;
+            if ([json[@"expires"] isKindOfClass:[NSNumber class]])
+                expires = [NSDate dateWithTimeIntervalSince1970:[json[@"expires"] doubleValue]];
+        } else {
+            token = [[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]
+                     stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        }
+
+        if (!token.length) {
+            completion(nil, nil, [NSError errorWithDomain:PKTTokenProviderErrorDomain
+                                                     code:PKTTokenProviderErrorEmptyToken
+                                                 userInfo:nil]);
+            return;
+        }
+        completion(token, expires, nil);
+    }];
+}
+
+@end
+
+@interface PKTTokenManager ()
+
+@property (nonatomic, strong, readwrite) NSString *token;
+@property (nonatomic, strong, readwrite) NSDate   *expirationDate;
+@property (nonatomic, strong, readwrite) NSError  *lastError;
+@property (nonatomic, assign, readwrite, getter=isRefreshing) BOOL refreshing;
+
+@property (nonatomic, assign) BOOL           started;
+@property (nonatomic, strong) NSMutableArray *completions;
+@property (nonatomic, assign) NSUInteger     failureCount;
+@property (nonatomic, assign) NSUInteger     timerGeneration;  // bumped to cancel a scheduled refresh
+
+@end
+
+@implementation PKTTokenManager
+
+- (instancetype)initWithProvider:(id<PKTTokenProvider>)provider
+{
+    if (self = [super init]) {
+        _provider             = provider;
+        _refreshLeadTime      = 60;
+        _defaultTokenLifetime = 3600;
+        _initialRetryInterval = 1;
+        _maximumRetryInterval = 60;
+        _completions          = [NSMutableArray array];
+        _fetchLatency         = [PKTLatencyHistogram new];
+    }
+    return self;
+}
+
+- (BOOL)hasValidToken
+{
+    return self.token && [self.expirationDate timeIntervalSinceNow] > 0;
+}
+
+- (void)start
+{
+    if (self.started)
+        return;
+
+    self.started = YES;
+    if ([self.expirationDate timeIntervalSinceNow] > self.refreshLeadTime)
+        [self scheduleRefresh];
+    else
+        [self refreshTokenWithCompletion:nil];
+}
+
+- (void)stop
+{
+    self.started = NO;
+    self.timerGeneration++;
+}
+
+- (void)refreshTokenWithCompletion:(void (^)(NSString *, NSError *))completion
+{
+    if (completion)
+        [self.completions addObject:[completion copy]];
+    if (self.refreshing)
+        return;
+
+    self.refreshing = YES;
+    self.timerGeneration++;
+
+    NSTimeInterval started = PKTMonotonicTime();
+    __weak PKTTokenManager *weakSelf = self;
+    [self.provider fetchCapabilityTokenWithCompletion:^(NSString *token, NSDate *expirationDate, NSError *error) {
+        NSTimeInterval finished = PKTMonotonicTime();
+        dispatch_async(dispatch_get_main_queue(), ^{
+            PKTTokenManager *manager = weakSelf;
+            if (token)
+                [manager.fetchLatency recordValue:finished - started];
+            [manager finishRefreshWithToken:token expirationDate:expirationDate error:error];
+        });
+    }];
+}
+
+- (void)updateExpirationDate:(NSDate *)expirationDate forToken:(NSString *)token
+{
+    if (!expirationDate || ![token isEqualToString:self.token] || [expirationDate isEqualToDate:self.expirationDate])
+        return;
+
+    self.expirationDate = expirationDate;
+    if (self.started && !self.refreshing)
+        [self scheduleRefresh];
+}
+
+#pragma mark - Helpers
+
+- (void)finishRefreshWithToken:(NSString *)token expirationDate:(NSDate *)expirationDate error:(NSError *)error
+{
+    self.refreshing = NO;
+    if (token) {
+        self.failureCount   = 0;
+        self.lastError      = nil;
+        self.expirationDate = expirationDate ?: [NSDate dateWithTimeIntervalSinceNow:self.defaultTokenLifetime];
+        self.token          = token;
+    } else {
+        self.failureCount++;
+        self.lastError = error;
+    }
+
+    NSArray *completions = [self.completions copy];
+    [self.completions removeAllObjects];
+    for (void (^completion)(NSString *, NSError *) in completions) {
+        completion(token, error);
+    }
+
+    if (!self.started)
+        return;
+    if (token)
+        [self scheduleRefresh];
+    else
+        [self scheduleRetry];
+}
+
+- (void)scheduleRefresh
+{
+    // up to a quarter of the lead time early, so clients spread out
+    NSTimeInterval lead  = self.refreshLeadTime * (1 + 0.25 * [self randomFraction]);
+    NSTimeInterval delay = [self.expirationDate timeIntervalSinceNow] - lead;
+    [self refreshAfter:MAX(delay, 0)];
+}
+
+- (void)scheduleRetry
+{
+    // "equal jitter": half the backoff is fixed, the other half random
+    double backoff = MIN(self.maximumRetryInterval,
+                         self.initialRetryInterval * pow(2, MIN(self.failureCount - 1, 30)));
+    [self refreshAfter:backoff / 2 * (1 + [self randomFraction])];
+}
+
+- (void)refreshAfter:(NSTimeInterval)delay
+{
+    NSUInteger generation = ++self.timerGeneration;
+    __weak PKTTokenManager *weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        PKTTokenManager *manager = weakSelf;
+        if (manager.started && manager.timerGeneration == generation)
+            [manager refreshTokenWithCompletion:nil];
+    });
+}
+
+- (double)randomFraction
+{
+    return arc4random_uniform(UINT32_MAX) / (double)UINT32_MAX;
+}
+
+@end
@@ -168,18 +168,52 @@
 
 - (void)setRawText:(NSString *)rawText
 {
-    self.numFormatter = [[NBAsYouTypeFormatter alloc] initWithRegionCode:@"US"];
-    _rawText = @"";
-    self.digitsTextField.text = @"";
-    for (int i = 0; i < rawText.length; ++i) {
-        NSString *c = [rawText substringWithRange:NSMakeRange(i, 1)];
-        [self appendText:c];
+    rawText = rawText ?: @"";
+    if (self.formatTextToPhoneNumber) {
+        [self formatRawTextChangeFrom:self.rawText ?: @"" to:rawText];
+    } else {
+        self.numFormatter = nil;
     }
+    _rawText = [rawText copy];
+    [self updateDigits];
+    
     if (!self.rawText.length) {
         [self toggleDeleteButtonVisible:NO animated:YES];
+    } else {
+        [self toggleDeleteButtonVisible:YES animated:YES];
+    }
+}
+
+// Feeds the formatter only what changed: typing (or binding a growing
+// string) appends the new suffix, and anything else replays the common
+// prefix once instead of rebuilding the formatter one character at a time.
+- (void)formatRawTextChangeFrom:(NSString *)oldText to:(NSString *)newText
+{
+    NSUInteger common = 0;
+    if (self.numFormatter) {
+        NSUInteger limit = MIN(oldText.length, newText.length);
+        while (common < limit && [oldText characterAtIndex:common] == [newText characterAtIndex:common]) {
+            common++;
+        }
+    } else {
+        self.numFormatter = [[NBAsYouTypeFormatter alloc] initWithRegionCode:@"US"];
+    }
+    
+    if (common < oldText.length) {
+        [self.numFormatter inputString:[newText substringToIndex:common]];
+    }
+    for (NSUInteger i = common; i < newText.length; i++) {
+        [self.numFormatter inputDigit:[newText substringWithRange:NSMakeRange(i, 1)]];
     }
 }
 
+// The text field is written as soon as the text changes, so anything reading
+// it, or a keystroke in the same turn, sees the current digits.
+- (void)updateDigits
+{
+    self.digitsTextField.text = self.formatTextToPhoneNumber ? [self.numFormatter description] : self.rawText;
+}
+
 - (void)setShowDeleteButton:(BOOL)showDeleteButton
 {
     _showDeleteButton = showDeleteButton;
@@ -191,13 +225,14 @@
 - (void)appendText:(NSString *)text
 {
     if (text.length) {
-        _rawText = [self.rawText stringByAppendingString:text];
-        NSString *formatted = self.rawText;
+        NSString *oldText = self.rawText;
+        _rawText = [oldText stringByAppendingString:text];
         if (self.formatTextToPhoneNumber) {
-            [self.numFormatter inputDigit:text];
-            formatted = [self.numFormatter description];
+            [self formatRawTextChangeFrom:oldText to:self.rawText];
+        } else {
+            self.numFormatter = nil;
         }
-        self.digitsTextField.text = formatted;
+        [self updateDigits];
         
         [self toggleDeleteButtonVisible:YES animated:YES];
     }
@@ -208,13 +243,14 @@
     if (!self.rawText.length)
         return;
     
-    _rawText = [self.rawText substringToIndex:self.rawText.length - 1];
-    NSString *formatted = self.rawText;
+    NSString *oldText = self.rawText;
+    _rawText = [oldText substringToIndex:oldText.length - 1];
     if (self.formatTextToPhoneNumber) {
-        [self.numFormatter removeLastDigit];
-        formatted = [self.numFormatter description];
+        [self formatRawTextChangeFrom:oldText to:self.rawText];
+    } else {
+        self.numFormatter = nil;
     }
-    self.digitsTextField.text = formatted;
+    [self updateDigits];
     if (!self.rawText.length) {
         [self toggleDeleteButtonVisible:NO animated:YES];
     }
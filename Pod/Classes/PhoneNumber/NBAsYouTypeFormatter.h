@@ -10,6 +10,9 @@
 
 @interface NBAsYouTypeFormatter : NSObject
 
++ (NBAsYouTypeFormatter *)formatterWithRegionCode:(NSString *)regionCode;
++ (void)recycleFormatter:(NBAsYouTypeFormatter *)formatter;
+
 - (id)initWithRegionCode:(NSString *)regionCode;
 - (id)initWithRegionCodeForTest:(NSString *)regionCode;
 - (id)initWithRegionCode:(NSString *)regionCode bundle:(NSBundle *)bundle;
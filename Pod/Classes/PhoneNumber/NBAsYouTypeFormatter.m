@@ -37,6 +37,93 @@
 
 @implementation NBAsYouTypeFormatter
 
+#define NB_FORMATTER_POOL_SIZE_PER_REGION 4
+
+static NBPhoneNumberUtil *kSharedPhoneUtil = nil;
+static NSRegularExpression *kDigitPattern = nil, *kNationalPrefixSeparatorsPattern = nil, *kCharacterClassPattern = nil;
+static NSRegularExpression *kStandaloneDigitPattern = nil, *kEligibleFormatPattern = nil;
+
+static NSMutableDictionary *kFormattingTemplateCache = nil;
+static NSLock *kFormattingTemplateCacheLock = nil;
+
+static NSMutableDictionary *kFormatterPool = nil;
+static NSLock *kFormatterPoolLock = nil;
+
+
+/**
+ * The patterns, phone util and template cache are the same for every
+ * formatter, so they are built once and shared; NSRegularExpression is
+ * immutable and NBPhoneNumberUtil's caches are thread-safe.
+ */
++ (void)initializeSharedState_
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSError *anError = nil;
+        kSharedPhoneUtil = [[NBPhoneNumberUtil alloc] init];
+        kDigitPattern = [NSRegularExpression regularExpressionWithPattern:@"\u2008" options:0 error:&anError];
+        kNationalPrefixSeparatorsPattern = [NSRegularExpression regularExpressionWithPattern:@"[- ]" options:0 error:&anError];
+        kCharacterClassPattern = [NSRegularExpression regularExpressionWithPattern:@"\\[([^\\[\\]])*\\]" options:0 error:&anError];
+        kStandaloneDigitPattern = [NSRegularExpression regularExpressionWithPattern:@"\\d(?=[^,}][^,}])" options:0 error:&anError];
+        
+        NSString *eligible_format = @"^[-x‐-―−ー－-／ ­​⁠　()（）［］.\\[\\]/~⁓∼～]*(\\$\\d[-x‐-―−ー－-／ ­​⁠　()（）［］.\\[\\]/~⁓∼～]*)+$";
+        kEligibleFormatPattern = [NSRegularExpression regularExpressionWithPattern:eligible_format options:0 error:&anError];
+        
+        kFormattingTemplateCache = [[NSMutableDictionary alloc] init];
+        kFormattingTemplateCacheLock = [[NSLock alloc] init];
+        kFormatterPool = [[NSMutableDictionary alloc] init];
+        kFormatterPoolLock = [[NSLock alloc] init];
+    });
+}
+
+
+/**
+ * Returns a cleared formatter for the region, reusing one handed back through
+ * recycleFormatter: when available. Use this instead of alloc/init when
+ * formatting many numbers, e.g. a whole call log.
+ */
++ (NBAsYouTypeFormatter *)formatterWithRegionCode:(NSString *)regionCode
+{
+    [self initializeSharedState_];
+    
+    NBAsYouTypeFormatter *formatter = nil;
+    [kFormatterPoolLock lock];
+    NSMutableArray *formatters = [kFormatterPool objectForKey:regionCode];
+    if (formatters.count > 0) {
+        formatter = [formatters lastObject];
+        [formatters removeLastObject];
+    }
+    [kFormatterPoolLock unlock];
+    
+    return formatter ?: [[NBAsYouTypeFormatter alloc] initWithRegionCode:regionCode];
+}
+
+
+/**
+ * Clears the formatter and keeps it for formatterWithRegionCode:. The caller
+ * must not use it afterwards.
+ */
++ (void)recycleFormatter:(NBAsYouTypeFormatter *)formatter
+{
+    if (formatter == nil || formatter.defaultCountry_ == nil) {
+        return;
+    }
+    
+    [formatter clear];
+    
+    [kFormatterPoolLock lock];
+    NSMutableArray *formatters = [kFormatterPool objectForKey:formatter.defaultCountry_];
+    if (formatters == nil) {
+        formatters = [[NSMutableArray alloc] init];
+        [kFormatterPool setObject:formatters forKey:formatter.defaultCountry_];
+    }
+    if (formatters.count < NB_FORMATTER_POOL_SIZE_PER_REGION && [formatters indexOfObjectIdenticalTo:formatter] == NSNotFound) {
+        [formatters addObject:formatter];
+    }
+    [kFormatterPoolLock unlock];
+}
+
+
 - (id)init
 {
     self = [super init];
@@ -83,13 +170,13 @@
          */
         self.formattingTemplate_ = [NSMutableString stringWithString:@""];
         
-        NSError *anError = nil;
+        [NBAsYouTypeFormatter initializeSharedState_];
         
         /**
          * @type {RegExp}
          * @private
          */
-        self.DIGIT_PATTERN_ = [NSRegularExpression regularExpressionWithPattern:self.DIGIT_PLACEHOLDER_ options:0 error:&anError];
+        self.DIGIT_PATTERN_ = kDigitPattern;
         
         /**
          * A set of characters that, if found in a national prefix formatting rules, are
@@ -99,7 +186,7 @@
          * @type {RegExp}
          * @private
          */
-        self.NATIONAL_PREFIX_SEPARATORS_PATTERN_ = [NSRegularExpression regularExpressionWithPattern:@"[- ]" options:0 error:&anError];
+        self.NATIONAL_PREFIX_SEPARATORS_PATTERN_ = kNationalPrefixSeparatorsPattern;
         
         /**
          * A pattern that is used to match character classes in regular expressions.
@@ -108,7 +195,7 @@
          * @type {RegExp}
          * @private
          */
-        self.CHARACTER_CLASS_PATTERN_ = [NSRegularExpression regularExpressionWithPattern:@"\\[([^\\[\\]])*\\]" options:0 error:&anError];
+        self.CHARACTER_CLASS_PATTERN_ = kCharacterClassPattern;
         
         /**
          * Any digit in a regular expression that actually denotes a digit. For
@@ -120,7 +207,7 @@
          * @type {RegExp}
          * @private
          */
-        self.STANDALONE_DIGIT_PATTERN_ = [NSRegularExpression regularExpressionWithPattern:@"\\d(?=[^,}][^,}])" options:0 error:&anError];
+        self.STANDALONE_DIGIT_PATTERN_ = kStandaloneDigitPattern;
         
         /**
          * A pattern that is used to determine if a numberFormat under availableFormats
@@ -133,8 +220,7 @@
          * @type {RegExp}
          * @private
          */
-        NSString *eligible_format = @"^[-x‐-―−ー－-／ ­​⁠　()（）［］.\\[\\]/~⁓∼～]*(\\$\\d[-x‐-―−ー－-／ ­​⁠　()（）［］.\\[\\]/~⁓∼～]*)+$";
-        self.ELIGIBLE_FORMAT_PATTERN_ = [NSRegularExpression regularExpressionWithPattern:eligible_format options:0 error:&anError];
+        self.ELIGIBLE_FORMAT_PATTERN_ = kEligibleFormatPattern;
         
         /**
          * The pattern from numberFormat that is currently used to create
@@ -277,7 +363,7 @@
 		* @private
 		* @type {i18n.phonenumbers.PhoneNumberUtil}
 		*/
-        self.phoneUtil_ = [[NBPhoneNumberUtil alloc] init];
+        self.phoneUtil_ = kSharedPhoneUtil;
         self.defaultCountry_ = regionCode;
         self.currentMetaData_ = [self getMetadataForRegion_:self.defaultCountry_];
         /**
@@ -304,7 +390,7 @@
 	self = [self init];
     
     if (self) {
-        self.phoneUtil_ = [[NBPhoneNumberUtil alloc] init];
+        self.phoneUtil_ = kSharedPhoneUtil;
         
         self.defaultCountry_ = regionCode;
         self.currentMetaData_ = [self getMetadataForRegion_:self.defaultCountry_];
@@ -477,6 +563,47 @@
  * @private
  */
 - (BOOL)createFormattingTemplate_:(NBNumberFormat*)format
+{
+    // Templates only depend on the format, so they are shared between
+    // formatters: each entry is @[template, digits it can hold], or NSNull
+    // when the format can't be used as you type.
+    NSString *cacheKey = [NSString stringWithFormat:@"%@\n%@", format.pattern, format.format];
+    
+    [kFormattingTemplateCacheLock lock];
+    id entry = [kFormattingTemplateCache objectForKey:cacheKey];
+    [kFormattingTemplateCacheLock unlock];
+    
+    if (entry == nil) {
+        entry = [self buildFormattingTemplateEntry_:format] ?: [NSNull null];
+        [kFormattingTemplateCacheLock lock];
+        [kFormattingTemplateCache setObject:entry forKey:cacheKey];
+        [kFormattingTemplateCacheLock unlock];
+    }
+    
+    self.formattingTemplate_ = [NSMutableString stringWithString:@""];
+    if (entry == [NSNull null]) {
+        return NO;
+    }
+    
+    // No formatting template can be created if the number of digits entered so
+    // far is longer than the maximum the current formatting rule can accommodate.
+    NSString *tempTemplate = [entry objectAtIndex:0];
+    if ([[entry objectAtIndex:1] unsignedIntegerValue] < self.nationalNumber_.length || tempTemplate.length <= 0) {
+        return NO;
+    }
+    
+    [self.formattingTemplate_ appendString:tempTemplate];
+    return YES;
+};
+
+
+/**
+ * @param {i18n.phonenumbers.NumberFormat} format
+ * @return {Array} the template and the number of digits it holds, or nil if
+ *     the format can't be used.
+ * @private
+ */
+- (NSArray*)buildFormattingTemplateEntry_:(NBNumberFormat*)format
 {
     /** @type {string} */
     NSString *numberPattern = format.pattern;
@@ -485,7 +612,7 @@
     // (20|3)\d{4}. In those cases we quickly return.
     NSRange stringRange = [numberPattern rangeOfString:@"|"];
     if (stringRange.location != NSNotFound) {
-        return NO;
+        return nil;
     }
     
     // Replace anything in the form of [..] with \d
@@ -497,15 +624,12 @@
     numberPattern = [self.STANDALONE_DIGIT_PATTERN_ stringByReplacingMatchesInString:numberPattern
                                                                              options:0 range:NSMakeRange(0, [numberPattern length])
                                                                         withTemplate:@"\\\\d"];
-    self.formattingTemplate_ = [NSMutableString stringWithString:@""];
     
-    /** @type {string} */
-    NSString *tempTemplate = [self getFormattingTemplate_:numberPattern numberFormat:format.format];
-    if (tempTemplate.length > 0) {
-        [self.formattingTemplate_ appendString:tempTemplate];
-        return YES;
-    }
-    return NO;
+    // Creates a phone number consisting only of the digit 9 that matches the
+    // numberPattern by applying the pattern to the longestPhoneNumber string.
+    NSString *aPhoneNumber = [[self.phoneUtil_ matchedStringByRegex:@"999999999999999" regex:numberPattern] safeObjectAtIndex:0];
+    NSString *template = [self getFormattingTemplate_:numberPattern numberFormat:format.format];
+    return @[ template ?: @"", @(aPhoneNumber.length) ];
 };
 
 
@@ -531,11 +655,6 @@
     // this match will always succeed
     /** @type {string} */
     NSString *aPhoneNumber = [m safeObjectAtIndex:0];
-    // No formatting template can be created if the number of digits entered so
-    // far is longer than the maximum the current formatting rule can accommodate.
-    if (aPhoneNumber.length < self.nationalNumber_.length) {
-        return @"";
-    }
     // Formats the number according to numberFormat
     /** @type {string} */
     NSString *template = [self.phoneUtil_ replaceStringByRegex:aPhoneNumber regex:numberPattern withTemplate:numberFormat];
@@ -21,6 +21,15 @@
 + (NBPhoneMetaData *)getMetadataForNonGeographicalRegion:(NSNumber *)countryCallingCode;
 + (NBPhoneMetaData *)getMetadataForRegion:(NSString *)regionCode;
 
++ (void)setMetadataCacheLimit:(NSUInteger)limit;
++ (NSUInteger)metadataCacheLimit;
++ (NSUInteger)metadataCacheHitCount;
++ (NSUInteger)metadataCacheMissCount;
++ (void)clearMetadataCache;
+
++ (BOOL)writeMetadataArchiveToPath:(NSString *)path error:(NSError **)error;
++ (BOOL)loadMetadataArchiveAtPath:(NSString *)path error:(NSError **)error;
+
 + (NSArray *)regionCodeFromCountryCode:(NSNumber *)countryCodeNumber;
 + (NSString *)countryCodeFromRegionCode:(NSString *)regionCode;
 
@@ -100,6 +100,8 @@
 
 - (BOOL)formattingRuleHasFirstGroupOnly:(NSString*)nationalPrefixFormattingRule;
 
+- (void)prewarmRegularExpressionsForRegions:(NSArray*)regionCodes;
+
 @property (nonatomic, strong, readonly) NSDictionary *DIGIT_MAPPINGS;
 @property (nonatomic, strong, readonly) NSBundle *libPhoneBundle;
 
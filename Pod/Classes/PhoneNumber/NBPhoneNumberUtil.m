@@ -13,6 +13,7 @@
 #import "NBPhoneMetaData.h"
 #import "NBMetadataHelper.h"
 #import <math.h>
+#import <objc/runtime.h>
 
 #if TARGET_OS_IPHONE
     #import <CoreTelephony/CTTelephonyNetworkInfo.h>
@@ -20,14 +21,1668 @@
 #endif
 
 
+#pragma mark - NBDigitAutomaton -
+
+/**
+ * Digit automaton used by getNumberTypeHelper:metadata:.
+ *
+ * National number patterns only use a small regex subset over ASCII digits:
+ * digits, \d, [...] classes, (...), (?:...), |, and the ?, *, + and {n,m}
+ * quantifiers. Each pattern of a region is compiled into one Thompson NFA
+ * whose accepting states carry a bit per pattern; the whole DFA is then built
+ * from it up front, so classifying a number walks its digits once, yields
+ * every pattern it matches in full, and only ever reads the automaton, which
+ * makes it safe from any thread without a lock. Anything outside the subset,
+ * or a DFA too large to build, makes compilation fail and the caller falls
+ * back to the regexes.
+ */
+#define NB_AUTOMATON_MAX_NFA_STATES 32768
+#define NB_AUTOMATON_MAX_DFA_STATES 8192
+#define NB_AUTOMATON_MAX_REPEAT     32
+#define NB_AUTOMATON_ALL_DIGITS     0x3FF
+
+typedef struct {
+    uint16_t digits;    // on any of these digits go to out; 0 for an epsilon state
+    int32_t out;
+    int32_t out1;
+    uint32_t accept;    // bits of the patterns this state completes
+} NBNFAState;
+
+typedef struct {
+    int32_t next[10];
+    int32_t setOffset;
+    int32_t setLength;
+    uint32_t accept;
+} NBDFAState;
+
+typedef struct {
+    int32_t start;
+    int32_t end;        // always an epsilon state with no way out yet
+} NBFragment;
+
+typedef struct {
+    NBNFAState *states;
+    int32_t stateCount, stateCapacity;
+    int32_t *starts;
+    int32_t startCount, startCapacity;
+
+    NBDFAState *dfa;
+    int32_t dfaCount, dfaCapacity;
+    int32_t *setPool;
+    int32_t poolCount, poolCapacity;
+    int32_t *table;
+    int32_t tableCapacity;
+
+    uint32_t *marks;
+    uint32_t generation;
+    int32_t *stack;
+    int32_t *collected;
+    int32_t *seeds;
+
+    const unichar *pattern;
+    NSUInteger length;
+    BOOL failed;
+} NBDigitAutomaton;
+
+
+static BOOL NBAutomatonGrow(void **items, int32_t *capacity, int32_t needed, size_t size)
+{
+    if (needed <= *capacity) {
+        return YES;
+    }
+
+    int32_t newCapacity = *capacity ? *capacity : 64;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    void *grown = realloc(*items, newCapacity * size);
+    if (grown == NULL) {
+        return NO;
+    }
+    *items = grown;
+    *capacity = newCapacity;
+    return YES;
+}
+
+
+static int32_t NBAutomatonAddState(NBDigitAutomaton *a, uint16_t digits, int32_t out, int32_t out1)
+{
+    if (a->failed || a->stateCount >= NB_AUTOMATON_MAX_NFA_STATES ||
+        !NBAutomatonGrow((void **)&a->states, &a->stateCapacity, a->stateCount + 1, sizeof(NBNFAState)))
+    {
+        a->failed = YES;
+        return 0;
+    }
+
+    a->states[a->stateCount] = (NBNFAState){ digits, out, out1, 0 };
+    return a->stateCount++;
+}
+
+
+static NBFragment NBFragmentEmpty(NBDigitAutomaton *a)
+{
+    int32_t s = NBAutomatonAddState(a, 0, -1, -1);
+    return (NBFragment){ s, s };
+}
+
+
+static NBFragment NBFragmentDigits(NBDigitAutomaton *a, uint16_t digits)
+{
+    int32_t e = NBAutomatonAddState(a, 0, -1, -1);
+    int32_t s = NBAutomatonAddState(a, digits, e, -1);
+    return (NBFragment){ s, e };
+}
+
+
+static NBFragment NBFragmentConcat(NBDigitAutomaton *a, NBFragment f, NBFragment g)
+{
+    if (a->failed) return f;
+    a->states[f.end].out = g.start;
+    return (NBFragment){ f.start, g.end };
+}
+
+
+static NBFragment NBFragmentAlternate(NBDigitAutomaton *a, NBFragment f, NBFragment g)
+{
+    int32_t e = NBAutomatonAddState(a, 0, -1, -1);
+    int32_t s = NBAutomatonAddState(a, 0, f.start, g.start);
+    if (a->failed) return f;
+    a->states[f.end].out = e;
+    a->states[g.end].out = e;
+    return (NBFragment){ s, e };
+}
+
+
+static NBFragment NBFragmentOptional(NBDigitAutomaton *a, NBFragment f)
+{
+    int32_t e = NBAutomatonAddState(a, 0, -1, -1);
+    int32_t s = NBAutomatonAddState(a, 0, f.start, e);
+    if (a->failed) return f;
+    a->states[f.end].out = e;
+    return (NBFragment){ s, e };
+}
+
+
+static NBFragment NBFragmentStar(NBDigitAutomaton *a, NBFragment f)
+{
+    int32_t e = NBAutomatonAddState(a, 0, -1, -1);
+    int32_t s = NBAutomatonAddState(a, 0, f.start, e);
+    if (a->failed) return f;
+    a->states[f.end].out = f.start;
+    a->states[f.end].out1 = e;
+    return (NBFragment){ s, e };
+}
+
+
+static NBFragment NBFragmentPlus(NBDigitAutomaton *a, NBFragment f)
+{
+    int32_t e = NBAutomatonAddState(a, 0, -1, -1);
+    if (a->failed) return f;
+    a->states[f.end].out = f.start;
+    a->states[f.end].out1 = e;
+    return (NBFragment){ f.start, e };
+}
+
+
+static unichar NBAutomatonPeek(NBDigitAutomaton *a, NSUInteger pos)
+{
+    return pos < a->length ? a->pattern[pos] : 0;
+}
+
+
+static NBFragment NBParseAlternation(NBDigitAutomaton *a, NSUInteger *pos);
+
+
+static uint16_t NBParseClass(NBDigitAutomaton *a, NSUInteger *pos)
+{
+    uint16_t digits = 0;
+    BOOL negated = NO;
+
+    (*pos)++;
+    if (NBAutomatonPeek(a, *pos) == '^') {
+        negated = YES;
+        (*pos)++;
+    }
+
+    while (!a->failed) {
+        unichar c = NBAutomatonPeek(a, *pos);
+        if (c == ']') {
+            (*pos)++;
+            break;
+        }
+
+        if (c == '\\' && NBAutomatonPeek(a, *pos + 1) == 'd') {
+            digits |= NB_AUTOMATON_ALL_DIGITS;
+            *pos += 2;
+        } else if (c >= '0' && c <= '9') {
+            unichar last = c;
+            if (NBAutomatonPeek(a, *pos + 1) == '-' && NBAutomatonPeek(a, *pos + 2) != ']') {
+                last = NBAutomatonPeek(a, *pos + 2);
+                if (last < c || last > '9') {
+                    a->failed = YES;
+                    break;
+                }
+                *pos += 2;
+            }
+            for (unichar d = c; d <= last; d++) {
+                digits |= 1 << (d - '0');
+            }
+            (*pos)++;
+        } else {
+            a->failed = YES;
+        }
+    }
+
+    return negated ? (~digits & NB_AUTOMATON_ALL_DIGITS) : digits;
+}
+
+
+static NBFragment NBParseAtom(NBDigitAutomaton *a, NSUInteger *pos)
+{
+    unichar c = NBAutomatonPeek(a, *pos);
+
+    if (c >= '0' && c <= '9') {
+        (*pos)++;
+        return NBFragmentDigits(a, 1 << (c - '0'));
+    }
+
+    if (c == '\\' && NBAutomatonPeek(a, *pos + 1) == 'd') {
+        *pos += 2;
+        return NBFragmentDigits(a, NB_AUTOMATON_ALL_DIGITS);
+    }
+
+    if (c == '[') {
+        uint16_t digits = NBParseClass(a, pos);
+        // an empty class can never match; keep it as a dead transition
+        return NBFragmentDigits(a, digits);
+    }
+
+    if (c == '(') {
+        (*pos)++;
+        if (NBAutomatonPeek(a, *pos) == '?') {
+            if (NBAutomatonPeek(a, *pos + 1) != ':') {
+                a->failed = YES;
+                return NBFragmentEmpty(a);
+            }
+            *pos += 2;
+        }
+
+        NBFragment f = NBParseAlternation(a, pos);
+        if (NBAutomatonPeek(a, *pos) != ')') {
+            a->failed = YES;
+            return f;
+        }
+        (*pos)++;
+        return f;
+    }
+
+    a->failed = YES;
+    return NBFragmentEmpty(a);
+}
+
+
+static BOOL NBParseCount(NBDigitAutomaton *a, NSUInteger *pos, int *count)
+{
+    int value = 0;
+    NSUInteger start = *pos;
+    unichar c;
+
+    while ((c = NBAutomatonPeek(a, *pos)) >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        if (value > NB_AUTOMATON_MAX_REPEAT) {
+            return NO;
+        }
+        (*pos)++;
+    }
+
+    *count = value;
+    return *pos > start;
+}
+
+
+static NBFragment NBParseRepetition(NBDigitAutomaton *a, NSUInteger *pos)
+{
+    NSUInteger atomStart = *pos;
+    NBFragment f = NBParseAtom(a, pos);
+    unichar c = NBAutomatonPeek(a, *pos);
+    int min = 1, max = 1;
+
+    if (a->failed) {
+        return f;
+    }
+
+    switch (c) {
+        case '?': min = 0; max = 1; (*pos)++; break;
+        case '*': min = 0; max = -1; (*pos)++; break;
+        case '+': min = 1; max = -1; (*pos)++; break;
+        case '{':
+            (*pos)++;
+            if (!NBParseCount(a, pos, &min)) {
+                a->failed = YES;
+                return f;
+            }
+            max = min;
+            if (NBAutomatonPeek(a, *pos) == ',') {
+                (*pos)++;
+                max = -1;
+                if (NBAutomatonPeek(a, *pos) != '}' && (!NBParseCount(a, pos, &max) || max < min)) {
+                    a->failed = YES;
+                    return f;
+                }
+            }
+            if (NBAutomatonPeek(a, *pos) != '}') {
+                a->failed = YES;
+                return f;
+            }
+            (*pos)++;
+            break;
+        default:
+            return f;
+    }
+
+    // a lazy quantifier accepts the same strings; possessive ones don't
+    if (NBAutomatonPeek(a, *pos) == '?') {
+        (*pos)++;
+    }
+    c = NBAutomatonPeek(a, *pos);
+    if (c == '?' || c == '*' || c == '+' || c == '{') {
+        a->failed = YES;
+        return f;
+    }
+
+    if (min == 1 && max == 1) {
+        return f;
+    }
+    if (min == 0 && max == 1) {
+        return NBFragmentOptional(a, f);
+    }
+    if (min == 0 && max == -1) {
+        return NBFragmentStar(a, f);
+    }
+    if (min == 1 && max == -1) {
+        return NBFragmentPlus(a, f);
+    }
+
+    // counted repetition: re-parse the atom for every copy it needs
+    NBFragment result = NBFragmentEmpty(a);
+    int copies = max < 0 ? min + 1 : max;
+    for (int i = 0; i < copies && !a->failed; i++) {
+        NBFragment copy = f;
+        if (i > 0) {
+            NSUInteger copyPos = atomStart;
+            copy = NBParseAtom(a, &copyPos);
+        }
+
+        if (i < min) {
+            result = NBFragmentConcat(a, result, copy);
+        } else if (max < 0) {
+            result = NBFragmentConcat(a, result, NBFragmentStar(a, copy));
+        } else {
+            result = NBFragmentConcat(a, result, NBFragmentOptional(a, copy));
+        }
+    }
+    return result;
+}
+
+
+static NBFragment NBParseConcatenation(NBDigitAutomaton *a, NSUInteger *pos)
+{
+    NBFragment result = NBFragmentEmpty(a);
+    unichar c;
+
+    while (!a->failed && *pos < a->length && (c = a->pattern[*pos]) != '|' && c != ')') {
+        result = NBFragmentConcat(a, result, NBParseRepetition(a, pos));
+    }
+    return result;
+}
+
+
+static NBFragment NBParseAlternation(NBDigitAutomaton *a, NSUInteger *pos)
+{
+    NBFragment result = NBParseConcatenation(a, pos);
+
+    while (!a->failed && NBAutomatonPeek(a, *pos) == '|') {
+        (*pos)++;
+        result = NBFragmentAlternate(a, result, NBParseConcatenation(a, pos));
+    }
+    return result;
+}
+
+
+/**
+ * Adds a pattern to the automaton, accepting with the given bit. Must be
+ * called before NBAutomatonPrepare.
+ */
+static BOOL NBAutomatonAddPattern(NBDigitAutomaton *a, const unichar *pattern, NSUInteger length, uint32_t bit)
+{
+    NSUInteger pos = 0;
+
+    a->pattern = pattern;
+    a->length = length;
+    NBFragment f = NBParseAlternation(a, &pos);
+    a->pattern = NULL;
+
+    if (a->failed || pos != length ||
+        !NBAutomatonGrow((void **)&a->starts, &a->startCapacity, a->startCount + 1, sizeof(int32_t)))
+    {
+        a->failed = YES;
+        return NO;
+    }
+
+    a->states[f.end].accept |= bit;
+    a->starts[a->startCount++] = f.start;
+    return YES;
+}
+
+
+static uint32_t NBAutomatonHashSet(const int32_t *set, int32_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (int32_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint32_t)set[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
+static int NBAutomatonCompareStates(const void *x, const void *y)
+{
+    int32_t l = *(const int32_t *)x, r = *(const int32_t *)y;
+    return (l > r) - (l < r);
+}
+
+
+static BOOL NBAutomatonRehash(NBDigitAutomaton *a, int32_t capacity)
+{
+    int32_t *table = malloc(capacity * sizeof(int32_t));
+    if (table == NULL) {
+        return NO;
+    }
+    memset(table, 0xFF, capacity * sizeof(int32_t));
+
+    for (int32_t i = 0; i < a->dfaCount; i++) {
+        uint32_t slot = NBAutomatonHashSet(a->setPool + a->dfa[i].setOffset, a->dfa[i].setLength) & (capacity - 1);
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        table[slot] = i;
+    }
+
+    free(a->table);
+    a->table = table;
+    a->tableCapacity = capacity;
+    return YES;
+}
+
+
+/**
+ * Follows epsilon edges from the seeds and returns the DFA state for the
+ * resulting set of NFA states, adding it if it's new. Returns -1 when the
+ * DFA has grown past its limit.
+ */
+static int32_t NBAutomatonClosure(NBDigitAutomaton *a, const int32_t *seeds, int32_t seedCount)
+{
+    int32_t depth = 0, collectedCount = 0;
+    uint32_t accept = 0;
+
+    if (++a->generation == 0) {
+        memset(a->marks, 0, a->stateCount * sizeof(uint32_t));
+        a->generation = 1;
+    }
+
+    for (int32_t i = 0; i < seedCount; i++) {
+        a->stack[depth++] = seeds[i];
+    }
+    while (depth > 0) {
+        int32_t s = a->stack[--depth];
+        if (s < 0 || a->marks[s] == a->generation) {
+            continue;
+        }
+        a->marks[s] = a->generation;
+
+        const NBNFAState *state = &a->states[s];
+        accept |= state->accept;
+        if (state->digits) {
+            a->collected[collectedCount++] = s;
+        } else {
+            a->stack[depth++] = state->out;
+            a->stack[depth++] = state->out1;
+        }
+    }
+    qsort(a->collected, collectedCount, sizeof(int32_t), NBAutomatonCompareStates);
+
+    uint32_t hash = NBAutomatonHashSet(a->collected, collectedCount);
+    uint32_t slot = hash & (a->tableCapacity - 1);
+    for (int32_t i; (i = a->table[slot]) >= 0; slot = (slot + 1) & (a->tableCapacity - 1)) {
+        if (a->dfa[i].accept == accept && a->dfa[i].setLength == collectedCount &&
+            memcmp(a->setPool + a->dfa[i].setOffset, a->collected, collectedCount * sizeof(int32_t)) == 0)
+        {
+            return i;
+        }
+    }
+
+    if (a->dfaCount >= NB_AUTOMATON_MAX_DFA_STATES ||
+        !NBAutomatonGrow((void **)&a->dfa, &a->dfaCapacity, a->dfaCount + 1, sizeof(NBDFAState)) ||
+        !NBAutomatonGrow((void **)&a->setPool, &a->poolCapacity, a->poolCount + collectedCount, sizeof(int32_t)))
+    {
+        return -1;
+    }
+
+    int32_t index = a->dfaCount++;
+    NBDFAState *dfaState = &a->dfa[index];
+    memset(dfaState->next, 0xFF, sizeof(dfaState->next));
+    dfaState->setOffset = a->poolCount;
+    dfaState->setLength = collectedCount;
+    dfaState->accept = accept;
+    memcpy(a->setPool + a->poolCount, a->collected, collectedCount * sizeof(int32_t));
+    a->poolCount += collectedCount;
+
+    if (a->dfaCount * 2 > a->tableCapacity) {
+        if (!NBAutomatonRehash(a, a->tableCapacity * 2)) {
+            a->dfaCount--;
+            return -1;
+        }
+    } else {
+        a->table[slot] = index;
+    }
+    return index;
+}
+
+
+static void NBAutomatonFreeScratch(NBDigitAutomaton *a)
+{
+    free(a->setPool);
+    free(a->table);
+    free(a->marks);
+    free(a->stack);
+    free(a->collected);
+    free(a->seeds);
+    a->setPool = NULL;
+    a->table = NULL;
+    a->marks = NULL;
+    a->stack = NULL;
+    a->collected = NULL;
+    a->seeds = NULL;
+}
+
+
+/**
+ * Finishes compilation once every pattern is added, building every DFA
+ * state and transition. Only the DFA is kept afterwards.
+ */
+static BOOL NBAutomatonPrepare(NBDigitAutomaton *a)
+{
+    if (a->failed) {
+        return NO;
+    }
+
+    a->marks = calloc(a->stateCount, sizeof(uint32_t));
+    a->stack = malloc((a->stateCount * 3 + a->startCount) * sizeof(int32_t));
+    a->collected = malloc(a->stateCount * sizeof(int32_t));
+    a->seeds = malloc(a->stateCount * sizeof(int32_t));
+    if (a->marks == NULL || a->stack == NULL || a->collected == NULL || a->seeds == NULL || !NBAutomatonRehash(a, 64)) {
+        a->failed = YES;
+        return NO;
+    }
+
+    // DFA state 0 is the start state; states are numbered as they're found,
+    // so this visits each one once, including those added along the way
+    if (NBAutomatonClosure(a, a->starts, a->startCount) != 0) {
+        a->failed = YES;
+        return NO;
+    }
+    for (int32_t current = 0; current < a->dfaCount; current++) {
+        for (int digit = 0; digit < 10; digit++) {
+            // the seeds are read out of the set pool before it can grow
+            int32_t setOffset = a->dfa[current].setOffset, setLength = a->dfa[current].setLength;
+            int32_t seedCount = 0;
+            for (int32_t j = 0; j < setLength; j++) {
+                const NBNFAState *state = &a->states[a->setPool[setOffset + j]];
+                if (state->digits & (1 << digit)) {
+                    a->seeds[seedCount++] = state->out;
+                }
+            }
+
+            int32_t next = NBAutomatonClosure(a, a->seeds, seedCount);
+            if (next < 0) {
+                a->failed = YES;
+                return NO;
+            }
+            a->dfa[current].next[digit] = next;
+        }
+    }
+
+    NBAutomatonFreeScratch(a);
+    return YES;
+}
+
+
+/**
+ * Runs the digits through the DFA and sets accept to the bits of every
+ * pattern matching them entirely. Returns NO if the string holds anything
+ * but ASCII digits. Never writes to the automaton.
+ */
+static BOOL NBAutomatonMatch(const NBDigitAutomaton *a, const unichar *chars, NSUInteger length, uint32_t *accept)
+{
+    int32_t current = 0;
+
+    for (NSUInteger i = 0; i < length; i++) {
+        if (chars[i] < '0' || chars[i] > '9') {
+            return NO;
+        }
+
+        // nothing can match any more
+        if (a->dfa[current].setLength == 0) {
+            *accept = 0;
+            return YES;
+        }
+
+        current = a->dfa[current].next[chars[i] - '0'];
+    }
+
+    *accept = a->dfa[current].accept;
+    return YES;
+}
+
+
+static void NBAutomatonFree(NBDigitAutomaton *a)
+{
+    NBAutomatonFreeScratch(a);
+    free(a->states);
+    free(a->starts);
+    free(a->dfa);
+    memset(a, 0, sizeof(*a));
+}
+
+
+#pragma mark - NBNumberTypeMatcher -
+
+typedef NS_ENUM(NSUInteger, NBNumberTypeDesc) {
+    NBNumberTypeDescGeneral = 0,
+    NBNumberTypeDescPremiumRate,
+    NBNumberTypeDescTollFree,
+    NBNumberTypeDescSharedCost,
+    NBNumberTypeDescVoip,
+    NBNumberTypeDescPersonalNumber,
+    NBNumberTypeDescPager,
+    NBNumberTypeDescUan,
+    NBNumberTypeDescVoicemail,
+    NBNumberTypeDescFixedLine,
+    NBNumberTypeDescMobile,
+    NBNumberTypeDescCount
+};
+
+#define NB_MATCHER_MAX_NUMBER_LENGTH 32
+
+static char kNBNumberTypeMatcherKey;
+static char kNBFormatRewriterKey;
+
+/**
+ * The number descs of one region compiled into a single NBDigitAutomaton, so
+ * getNumberTypeHelper:metadata: can learn which descs a number matches from
+ * one walk over its digits instead of one regex per desc.
+ */
+@interface NBNumberTypeMatcher : NSObject
+{
+    NBDigitAutomaton automaton;
+    uint32_t requiredPatterns[NBNumberTypeDescCount];
+}
+
+- (instancetype)initWithMetadata:(NBPhoneMetaData *)metadata;
+- (BOOL)matchNumber:(NSString *)nationalNumber descs:(uint32_t *)descs;
+
+@end
+
+
+@implementation NBNumberTypeMatcher
+
+- (BOOL)addPattern:(NSString *)pattern bit:(uint32_t)bit
+{
+    NSUInteger length = pattern.length;
+    unichar *characters = malloc(MAX(length, 1) * sizeof(unichar));
+    [pattern getCharacters:characters range:NSMakeRange(0, length)];
+    BOOL added = NBAutomatonAddPattern(&automaton, characters, length, bit);
+    free(characters);
+    return added;
+}
+
+
+/**
+ * Mirrors isNumberMatchingDesc:numberDesc:, recording which of the desc's
+ * patterns must match. A desc that can never match requires no patterns.
+ */
+- (BOOL)addDesc:(NBPhoneNumberDesc *)desc index:(NBNumberTypeDesc)index
+{
+    uint32_t possibleBit = 1u << (index * 2), nationalBit = 1u << (index * 2 + 1);
+    NSString *possible = desc.possibleNumberPattern, *national = desc.nationalNumberPattern;
+    BOOL usePossible = YES, useNational = YES;
+
+    requiredPatterns[index] = 0;
+    if (desc == nil) {
+        return YES;
+    }
+
+    if ([NBMetadataHelper hasValue:possible] == NO || [possible isEqual:@"NA"]) {
+        usePossible = NO;
+    } else if ([NBMetadataHelper hasValue:national] == NO || [national isEqual:@"NA"]) {
+        useNational = NO;
+    }
+
+    // matchesEntirely:string: never matches these
+    if (useNational && (national == nil || [national isEqualToString:@"NA"])) {
+        return YES;
+    }
+
+    if ((usePossible && ![self addPattern:possible bit:possibleBit]) ||
+        (useNational && ![self addPattern:national bit:nationalBit]))
+    {
+        return NO;
+    }
+
+    requiredPatterns[index] = (usePossible ? possibleBit : 0) | (useNational ? nationalBit : 0);
+    return YES;
+}
+
+
+- (instancetype)initWithMetadata:(NBPhoneMetaData *)metadata
+{
+    self = [super init];
+    if (self)
+    {
+        NBPhoneNumberDesc *descs[NBNumberTypeDescCount] = {
+            metadata.generalDesc, metadata.premiumRate, metadata.tollFree, metadata.sharedCost, metadata.voip,
+            metadata.personalNumber, metadata.pager, metadata.uan, metadata.voicemail, metadata.fixedLine, metadata.mobile
+        };
+
+        for (NSUInteger i = 0; i < NBNumberTypeDescCount; i++) {
+            if ([self addDesc:descs[i] index:i] == NO) {
+                return nil;
+            }
+        }
+
+        // getNumberTypeHelper:metadata: also needs the general desc to have a pattern at all
+        if ([NBMetadataHelper hasValue:metadata.generalDesc.nationalNumberPattern] == NO) {
+            requiredPatterns[NBNumberTypeDescGeneral] = 0;
+        }
+
+        if (NBAutomatonPrepare(&automaton) == NO) {
+            return nil;
+        }
+    }
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    NBAutomatonFree(&automaton);
+}
+
+
+/**
+ * Sets descs to a bit per NBNumberTypeDesc the number matches. Returns NO if
+ * the automaton can't answer, in which case the regexes have to.
+ */
+- (BOOL)matchNumber:(NSString *)nationalNumber descs:(uint32_t *)descs
+{
+    unichar characters[NB_MATCHER_MAX_NUMBER_LENGTH];
+    NSUInteger length = nationalNumber.length;
+    uint32_t accept = 0;
+
+    if (length > NB_MATCHER_MAX_NUMBER_LENGTH) {
+        return NO;
+    }
+    [nationalNumber getCharacters:characters range:NSMakeRange(0, length)];
+
+    if (NBAutomatonMatch(&automaton, characters, length, &accept) == NO) {
+        return NO;
+    }
+
+    *descs = 0;
+    for (NSUInteger i = 0; i < NBNumberTypeDescCount; i++) {
+        if (requiredPatterns[i] != 0 && (accept & requiredPatterns[i]) == requiredPatterns[i]) {
+            *descs |= 1u << i;
+        }
+    }
+    return YES;
+}
+
+@end
+
+#pragma mark - NBRegularExpressionCache -
+
+/**
+ * Pattern -> NSRegularExpression cache that takes no lock on a hit.
+ *
+ * Readers look in an immutable snapshot published through an atomic pointer.
+ * A miss compiles under the lock and publishes a copy of the snapshot with the
+ * new entry, so an expression is lock-free to find as soon as it's cached.
+ * Between beginBatch and endBatch (while prewarming, say) misses collect in a
+ * pending table instead and are published together, rather than copying the
+ * snapshot once per pattern.
+ *
+ * Readers announce themselves in a counter before loading the snapshot. A
+ * replaced snapshot is retired, and every retired snapshot is released the
+ * next time the lock holder sees no readers after a swap: any reader that
+ * could still be looking at one is counted until it's done.
+ */
+@interface NBRegularExpressionCache : NSObject
+{
+    void * volatile snapshot;
+    volatile NSInteger readers;
+    NSMutableDictionary *pending;
+    NSUInteger batchDepth;
+    NSMutableArray *retiredSnapshots;
+    NSLock *lock;
+}
+
+- (NSRegularExpression *)regularExpressionForKey:(NSString *)key
+                                         pattern:(NSString *)pattern
+                                         options:(NSRegularExpressionOptions)options
+                                           error:(NSError **)error;
+- (void)beginBatch;
+- (void)endBatch;
+
+@end
+
+
+@implementation NBRegularExpressionCache
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        snapshot = (void *)CFBridgingRetain([NSDictionary dictionary]);
+        pending = [[NSMutableDictionary alloc] init];
+        retiredSnapshots = [[NSMutableArray alloc] init];
+        lock = [[NSLock alloc] init];
+    }
+    
+    return self;
+}
+
+
+- (void)dealloc
+{
+    CFBridgingRelease(snapshot);
+}
+
+
+/**
+ * Must be called with the lock held.
+ */
+- (void)publishLocked
+{
+    if (pending.count == 0) {
+        return;
+    }
+    
+    NSMutableDictionary *next = [(__bridge NSDictionary *)snapshot mutableCopy];
+    [next addEntriesFromDictionary:pending];
+    [pending removeAllObjects];
+    
+    void *retired = __atomic_exchange_n(&snapshot, (void *)CFBridgingRetain([next copy]), __ATOMIC_SEQ_CST);
+    [retiredSnapshots addObject:CFBridgingRelease(retired)];
+    if (__atomic_load_n(&readers, __ATOMIC_SEQ_CST) == 0) {
+        [retiredSnapshots removeAllObjects];
+    }
+}
+
+
+- (void)beginBatch
+{
+    [lock lock];
+    batchDepth++;
+    [lock unlock];
+}
+
+
+- (void)endBatch
+{
+    [lock lock];
+    if (batchDepth > 0 && --batchDepth == 0) {
+        [self publishLocked];
+    }
+    [lock unlock];
+}
+
+
+- (NSRegularExpression *)regularExpressionForKey:(NSString *)key
+                                         pattern:(NSString *)pattern
+                                         options:(NSRegularExpressionOptions)options
+                                           error:(NSError **)error
+{
+    __atomic_fetch_add(&readers, 1, __ATOMIC_SEQ_CST);
+    // counted, so the snapshot can't be released under us; no need to retain it
+    __unsafe_unretained NSDictionary *current = (__bridge NSDictionary *)__atomic_load_n(&snapshot, __ATOMIC_SEQ_CST);
+    NSRegularExpression *regex = [current objectForKey:key];
+    __atomic_fetch_sub(&readers, 1, __ATOMIC_SEQ_CST);
+    if (regex) {
+        return regex;
+    }
+    
+    [lock lock];
+    regex = [pending objectForKey:key] ?: [(__bridge NSDictionary *)snapshot objectForKey:key];
+    if (regex == nil)
+    {
+        regex = [NSRegularExpression regularExpressionWithPattern:pattern options:options error:error];
+        if (regex)
+        {
+            [pending setObject:regex forKey:key];
+            if (batchDepth == 0) {
+                [self publishLocked];
+            }
+        }
+    }
+    [lock unlock];
+    
+    return regex;
+}
+
+@end
+
+
+#pragma mark - NBCharacterFolding -
+
+/**
+ * Table-driven character folding for the normalize methods.
+ *
+ * Every UTF-16 code unit the normalizations map gets an entry. The low byte
+ * is the ASCII character the unit folds to. The high byte is its class. A
+ * folding is a set of classes, and a character outside them is unmatched.
+ * Entries live in 256-unit pages indexed by the high byte of the code unit,
+ * so a lookup is two loads, whatever the script.
+ */
+typedef uint8_t NBCharacterFolding;
+
+enum {
+    NBFoldASCIIDigit    = 1 << 0,   // 0-9
+    NBFoldOtherDigit    = 1 << 1,   // fullwidth, Arabic-Indic and Eastern-Arabic digits
+    NBFoldUpperAlpha    = 1 << 2,   // A-Z
+    NBFoldLowerAlpha    = 1 << 3,   // a-z, and the non-ASCII letters that uppercase to A-Z
+    NBFoldDiallable     = 1 << 4,   // + and *
+    NBFoldGrouping      = 1 << 5,   // dash, slash, space and dot variants
+    NBFoldNoBreakSpace  = 1 << 6,   // U+00A0, as normalizeNonBreakingSpace: does
+    NBFoldKeypadLetters = 1 << 7,   // not a class: letters fold to their keypad digit
+};
+
+static const NBCharacterFolding NBFoldingDigitsOnly         = NBFoldASCIIDigit | NBFoldOtherDigit;
+static const NBCharacterFolding NBFoldingAlphaPhone         = NBFoldASCIIDigit | NBFoldOtherDigit | NBFoldUpperAlpha | NBFoldLowerAlpha | NBFoldKeypadLetters;
+static const NBCharacterFolding NBFoldingAlphaInNumber      = NBFoldASCIIDigit | NBFoldOtherDigit | NBFoldUpperAlpha | NBFoldKeypadLetters | NBFoldNoBreakSpace;
+static const NBCharacterFolding NBFoldingDiallable          = NBFoldASCIIDigit | NBFoldDiallable;
+static const NBCharacterFolding NBFoldingPlusNumberGrouping = NBFoldASCIIDigit | NBFoldUpperAlpha | NBFoldLowerAlpha | NBFoldGrouping;
+
+typedef struct {
+    unichar first;
+    unichar last;
+    char folded;        // what first folds to; the rest of the range counts up from it
+    uint8_t charClass;
+} NBFoldRange;
+
+static const NBFoldRange kNBFoldRanges[] = {
+    { '0',    '9',    '0', NBFoldASCIIDigit },
+    { 0xFF10, 0xFF19, '0', NBFoldOtherDigit },
+    { 0x0660, 0x0669, '0', NBFoldOtherDigit },
+    { 0x06F0, 0x06F9, '0', NBFoldOtherDigit },
+    { 'A',    'Z',    'A', NBFoldUpperAlpha },
+    { 'a',    'z',    'A', NBFoldLowerAlpha },
+    { 0x0131, 0x0131, 'I', NBFoldLowerAlpha },  // dotless i
+    { 0x017F, 0x017F, 'S', NBFoldLowerAlpha },  // long s
+    { '+',    '+',    '+', NBFoldDiallable },
+    { '*',    '*',    '*', NBFoldDiallable },
+    { '-',    '-',    '-', NBFoldGrouping },
+    { 0xFF0D, 0xFF0D, '-', NBFoldGrouping },
+    { 0x2010, 0x2010, '-', NBFoldGrouping },
+    { 0x2011, 0x2011, '-', NBFoldGrouping },
+    { 0x2012, 0x2012, '-', NBFoldGrouping },
+    { 0x2013, 0x2013, '-', NBFoldGrouping },
+    { 0x2014, 0x2014, '-', NBFoldGrouping },
+    { 0x2015, 0x2015, '-', NBFoldGrouping },
+    { 0x2212, 0x2212, '-', NBFoldGrouping },
+    { '/',    '/',    '/', NBFoldGrouping },
+    { 0xFF0F, 0xFF0F, '/', NBFoldGrouping },
+    { ' ',    ' ',    ' ', NBFoldGrouping },
+    { 0x3000, 0x3000, ' ', NBFoldGrouping },
+    { 0x2060, 0x2060, ' ', NBFoldGrouping },
+    { '.',    '.',    '.', NBFoldGrouping },
+    { 0xFF0E, 0xFF0E, '.', NBFoldGrouping },
+    { 0x00A0, 0x00A0, ' ', NBFoldNoBreakSpace },
+};
+
+static const char kNBKeypadDigits[26] = {
+    '2', '2', '2', '3', '3', '3', '4', '4', '4', '5', '5', '5', '6',
+    '6', '6', '7', '7', '7', '7', '8', '8', '8', '9', '9', '9', '9'
+};
+
+#define NB_FOLD_PAGE_COUNT 8
+
+static uint8_t nbFoldPageIndex[256];    // high byte -> page; page 0 is all unmatched
+static uint16_t nbFoldPages[NB_FOLD_PAGE_COUNT][256];
+
+static void NBBuildFoldTable(void)
+{
+    uint8_t pageCount = 1;
+    
+    for (size_t i = 0; i < sizeof(kNBFoldRanges) / sizeof(kNBFoldRanges[0]); i++)
+    {
+        NBFoldRange range = kNBFoldRanges[i];
+        for (uint32_t c = range.first; c <= range.last; c++)
+        {
+            uint8_t high = c >> 8;
+            if (nbFoldPageIndex[high] == 0)
+            {
+                NSCAssert(pageCount < NB_FOLD_PAGE_COUNT, @"NB_FOLD_PAGE_COUNT too small");
+                nbFoldPageIndex[high] = pageCount++;
+            }
+            nbFoldPages[nbFoldPageIndex[high]][c & 0xFF] = (uint16_t)(range.charClass << 8) | (uint8_t)(range.folded + (c - range.first));
+        }
+    }
+}
+
+/**
+ * Folds the characters of source that the folding matches, and keeps or drops
+ * the rest. A folded character is never longer than its source, so the work
+ * happens in place in one buffer and only the result string is allocated.
+ */
+static NSString *NBFoldString(NSString *source, NBCharacterFolding folding, BOOL removeNonMatches)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{ NBBuildFoldTable(); });
+    
+    NSUInteger length = source.length;
+    if (length == 0) {
+        return @"";
+    }
+    
+    unichar inlineBuffer[64];
+    unichar *buffer = length <= 64 ? inlineBuffer : malloc(length * sizeof(unichar));
+    [source getCharacters:buffer range:NSMakeRange(0, length)];
+    
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < length; i++)
+    {
+        unichar c = buffer[i];
+        uint16_t entry = nbFoldPages[nbFoldPageIndex[c >> 8]][c & 0xFF];
+        if ((entry >> 8) & folding)
+        {
+            char folded = entry & 0xFF;
+            if ((folding & NBFoldKeypadLetters) && folded >= 'A' && folded <= 'Z') {
+                folded = kNBKeypadDigits[folded - 'A'];
+            }
+            buffer[count++] = folded;
+        }
+        else if (removeNonMatches == NO)
+        {
+            buffer[count++] = c;
+        }
+    }
+    
+    NSString *result = [NSString stringWithCharacters:buffer length:count];
+    if (buffer != inlineBuffer) {
+        free(buffer);
+    }
+    return result;
+}
+
+
+#pragma mark - NBFormatRewriter -
+
+/**
+ * Number formats compiled into rewrite programs for formatNsnUsingPattern:.
+ *
+ * A format's pattern only has to be run to find its group boundaries. The
+ * caller has already matched the pattern entirely against the number. If
+ * each group is a fixed length, or just one group's length varies with one
+ * greedy single-character quantifier, the length of the number alone fixes
+ * those boundaries. It also fixes the one match stringByReplacingMatches...
+ * would find. The format template, with the national prefix or carrier code
+ * rule spliced in the way the regex replacements do it, becomes a list of
+ * literal runs and group references. Formatting is then a copy into a stack
+ * buffer. Patterns or templates outside this subset keep using the regexes.
+ */
+#define NB_REWRITE_MAX_GROUPS   9
+#define NB_REWRITE_MAX_OPS      24
+#define NB_REWRITE_MAX_LITERALS 48
+#define NB_REWRITE_MAX_LENGTH   128
+
+typedef struct {
+    int8_t group;       // -1 for literals[start, start + length)
+    uint8_t start;
+    uint8_t length;
+} NBRewriteOp;
+
+typedef struct {
+    uint8_t opCount;
+    uint8_t literalLength;
+    NBRewriteOp ops[NB_REWRITE_MAX_OPS];
+    unichar literals[NB_REWRITE_MAX_LITERALS];
+} NBRewriteProgram;
+
+typedef struct {
+    const unichar *characters;
+    NSUInteger length;
+} NBRewriteGroup;
+
+typedef struct {
+    const unichar *characters;
+    NSUInteger length;
+    NSUInteger position;
+} NBPatternCursor;
+
+static inline BOOL NBIsASCIIDigit(unichar c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// what \d matches
+static inline BOOL NBIsDecimalDigit(unichar c)
+{
+    return NBIsASCIIDigit(c) || (c >= 128 && CFCharacterSetIsCharacterMember(CFCharacterSetGetPredefined(kCFCharacterSetDecimalDigit), c));
+}
+
+static BOOL NBParseLayoutSequence(NBPatternCursor *cursor, NSUInteger *minLength, NSUInteger *maxLength, NSUInteger *variableCount);
+
+/**
+ * Reads a {n}, {n,m} or ? quantifier, if any. Lazy and possessive forms and
+ * unbounded repeats are left unsupported; they'd break the greedy argument.
+ */
+static BOOL NBParseLayoutQuantifier(NBPatternCursor *cursor, NSUInteger *lo, NSUInteger *hi)
+{
+    const unichar *p = cursor->characters;
+    *lo = *hi = 1;
+    
+    if (cursor->position < cursor->length && p[cursor->position] == '?')
+    {
+        *lo = 0;
+        cursor->position++;
+    }
+    else if (cursor->position < cursor->length && p[cursor->position] == '{')
+    {
+        NSUInteger i = cursor->position + 1, values[2] = { 0, 0 }, count = 0;
+        while (count < 2)
+        {
+            NSUInteger start = i;
+            while (i < cursor->length && NBIsASCIIDigit(p[i]) && values[count] < 1000) {
+                values[count] = values[count] * 10 + (p[i++] - '0');
+            }
+            if (i == start || i >= cursor->length) {
+                return NO;
+            }
+            count++;
+            if (p[i] == '}') {
+                break;
+            }
+            if (p[i] != ',' || count == 2) {
+                return NO;
+            }
+            i++;
+        }
+        if (p[i] != '}') {
+            return NO;
+        }
+        *lo = values[0];
+        *hi = count == 2 ? values[1] : values[0];
+        cursor->position = i + 1;
+        if (*hi < *lo) {
+            return NO;
+        }
+    }
+    
+    if (cursor->position < cursor->length)
+    {
+        unichar next = p[cursor->position];
+        if (next == '?' || next == '+' || next == '*' || next == '{') {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+/**
+ * One atom: a digit, \d, a class of digits or a non-capturing group.
+ */
+static BOOL NBParseLayoutAtom(NBPatternCursor *cursor, NSUInteger *minLength, NSUInteger *maxLength, NSUInteger *variableCount, BOOL *isGroup)
+{
+    const unichar *p = cursor->characters;
+    unichar c = p[cursor->position];
+    *minLength = *maxLength = 1;
+    *variableCount = 0;
+    *isGroup = NO;
+    
+    if (NBIsASCIIDigit(c))
+    {
+        cursor->position++;
+    }
+    else if (c == '\\')
+    {
+        if (cursor->position + 1 >= cursor->length || p[cursor->position + 1] != 'd') {
+            return NO;
+        }
+        cursor->position += 2;
+    }
+    else if (c == '[')
+    {
+        NSUInteger i = cursor->position + 1;
+        while (i < cursor->length && (NBIsASCIIDigit(p[i]) || p[i] == '-')) {
+            i++;
+        }
+        if (i >= cursor->length || p[i] != ']' || i == cursor->position + 1) {
+            return NO;
+        }
+        cursor->position = i + 1;
+    }
+    else if (c == '(')
+    {
+        if (cursor->position + 2 >= cursor->length || p[cursor->position + 1] != '?' || p[cursor->position + 2] != ':') {
+            return NO;
+        }
+        cursor->position += 3;
+        if (NBParseLayoutSequence(cursor, minLength, maxLength, variableCount) == NO ||
+            cursor->position >= cursor->length || p[cursor->position] != ')')
+        {
+            return NO;
+        }
+        cursor->position++;
+        *isGroup = YES;
+    }
+    else
+    {
+        return NO;
+    }
+    
+    return YES;
+}
+
+/**
+ * Sums up the atoms of one branch, up to the next '|', unmatched ')' or the end.
+ */
+static BOOL NBParseLayoutBranch(NBPatternCursor *cursor, NSUInteger *minLength, NSUInteger *maxLength, NSUInteger *variableCount)
+{
+    *minLength = *maxLength = *variableCount = 0;
+    
+    while (cursor->position < cursor->length && cursor->characters[cursor->position] != ')' &&
+           cursor->characters[cursor->position] != '|')
+    {
+        NSUInteger atomMin, atomMax, atomVariables, lo, hi;
+        BOOL isGroup;
+        if (NBParseLayoutAtom(cursor, &atomMin, &atomMax, &atomVariables, &isGroup) == NO ||
+            NBParseLayoutQuantifier(cursor, &lo, &hi) == NO)
+        {
+            return NO;
+        }
+        
+        if (lo != hi)
+        {
+            // only a single character may repeat a varying number of times
+            if (isGroup) {
+                return NO;
+            }
+            atomVariables = 1;
+        }
+        else if (atomVariables > 0 && hi != 1)
+        {
+            return NO;
+        }
+        
+        *minLength += atomMin * lo;
+        *maxLength += atomMax * hi;
+        *variableCount += atomVariables;
+        if (*maxLength > UINT8_MAX) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+/**
+ * A branch, or an alternation of branches that all have the same fixed length.
+ */
+static BOOL NBParseLayoutSequence(NBPatternCursor *cursor, NSUInteger *minLength, NSUInteger *maxLength, NSUInteger *variableCount)
+{
+    if (NBParseLayoutBranch(cursor, minLength, maxLength, variableCount) == NO) {
+        return NO;
+    }
+    
+    while (cursor->position < cursor->length && cursor->characters[cursor->position] == '|')
+    {
+        NSUInteger branchMin, branchMax, branchVariables;
+        cursor->position++;
+        if (NBParseLayoutBranch(cursor, &branchMin, &branchMax, &branchVariables) == NO ||
+            *minLength != *maxLength || branchMin != *minLength || branchMax != *maxLength)
+        {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+/**
+ * Compiles a template as NSRegularExpression expands it: $n refers to group n,
+ * taking as many digits as still name a group, and a backslash quotes the next
+ * character. A $ that names no group makes it unsupported.
+ */
+static BOOL NBCompileRewriteTemplate(const unichar *characters, NSUInteger length, NSUInteger groupCount, NBRewriteProgram *program)
+{
+    program->opCount = 0;
+    program->literalLength = 0;
+    
+    for (NSUInteger i = 0; i < length; )
+    {
+        unichar c = characters[i];
+        if (c == '$')
+        {
+            if (i + 1 >= length || NBIsASCIIDigit(characters[i + 1]) == NO || (NSUInteger)(characters[i + 1] - '0') > groupCount) {
+                return NO;
+            }
+            NSUInteger group = characters[i + 1] - '0';
+            i += 2;
+            while (i < length && NBIsASCIIDigit(characters[i]) && group * 10 + (characters[i] - '0') <= groupCount) {
+                group = group * 10 + (characters[i++] - '0');
+            }
+            if (program->opCount == NB_REWRITE_MAX_OPS) {
+                return NO;
+            }
+            program->ops[program->opCount++] = (NBRewriteOp){ (int8_t)group, 0, 0 };
+            continue;
+        }
+        
+        if (c == '\\')
+        {
+            if (i + 1 >= length) {
+                return NO;
+            }
+            c = characters[++i];
+        }
+        i++;
+        
+        if (program->literalLength == NB_REWRITE_MAX_LITERALS) {
+            return NO;
+        }
+        NBRewriteOp *last = program->opCount > 0 ? &program->ops[program->opCount - 1] : NULL;
+        if (last && last->group < 0) {
+            last->length++;
+        } else if (program->opCount == NB_REWRITE_MAX_OPS) {
+            return NO;
+        } else {
+            program->ops[program->opCount++] = (NBRewriteOp){ -1, program->literalLength, 1 };
+        }
+        program->literals[program->literalLength++] = c;
+    }
+    return YES;
+}
+
+/**
+ * Writes the program's output for the given groups into buffer. Returns the
+ * length, or NSNotFound if it doesn't fit.
+ */
+static NSUInteger NBRunRewriteProgram(const NBRewriteProgram *program, const NBRewriteGroup *groups,
+                                      unichar *buffer, NSUInteger capacity)
+{
+    NSUInteger length = 0;
+    
+    for (NSUInteger i = 0; i < program->opCount; i++)
+    {
+        NBRewriteOp op = program->ops[i];
+        const unichar *source = op.group < 0 ? program->literals + op.start : groups[op.group].characters;
+        NSUInteger count = op.group < 0 ? op.length : groups[op.group].length;
+        if (length + count > capacity) {
+            return NSNotFound;
+        }
+        memcpy(buffer + length, source, count * sizeof(unichar));
+        length += count;
+    }
+    return length;
+}
+
+/**
+ * Splices rule into characters in place of the first "$<digit>", as
+ * replaceFirstStringByRegex:regex:FIRST_GROUP_PATTERN withTemplate: does.
+ * A rule compiled against two groups gets carrierGroup for the second.
+ */
+static NSUInteger NBSpliceFirstGroupRule(const unichar *characters, NSUInteger length, const NBRewriteProgram *rule,
+                                         const NBRewriteGroup *carrierGroup, unichar *buffer, NSUInteger capacity)
+{
+    NSUInteger i = 0;
+    while (i + 1 < length && (characters[i] != '$' || NBIsDecimalDigit(characters[i + 1]) == NO)) {
+        i++;
+    }
+    if (i + 1 >= length) {
+        if (length > capacity) {
+            return NSNotFound;
+        }
+        memcpy(buffer, characters, length * sizeof(unichar));
+        return length;
+    }
+    
+    NBRewriteGroup match = { characters + i, 2 };
+    NBRewriteGroup groups[3] = { match, match, carrierGroup ? *carrierGroup : match };
+    if (i > capacity) {
+        return NSNotFound;
+    }
+    memcpy(buffer, characters, i * sizeof(unichar));
+    NSUInteger ruleLength = NBRunRewriteProgram(rule, groups, buffer + i, capacity - i);
+    if (ruleLength == NSNotFound || i + ruleLength + (length - i - 2) > capacity) {
+        return NSNotFound;
+    }
+    memcpy(buffer + i + ruleLength, characters + i + 2, (length - i - 2) * sizeof(unichar));
+    return i + ruleLength + (length - i - 2);
+}
+
+
+static BOOL NBStringsMatch(NSString *a, NSString *b)
+{
+    return a == b || [a isEqualToString:b] || (a.length == 0 && b.length == 0);
+}
+
+
+/**
+ * Compiles a template against groupCount groups, or fails if it's too long.
+ */
+static BOOL NBCompileRewriteTemplateString(NSString *templateString, NSUInteger groupCount, NBRewriteProgram *program)
+{
+    unichar characters[NB_REWRITE_MAX_LENGTH];
+    NSUInteger length = templateString.length;
+    if (length > NB_REWRITE_MAX_LENGTH) {
+        return NO;
+    }
+    [templateString getCharacters:characters range:NSMakeRange(0, length)];
+    return NBCompileRewriteTemplate(characters, length, groupCount, program);
+}
+
+
+@interface NBFormatRewriter : NSObject
+{
+    uint8_t groupCount;
+    int8_t variableGroup;
+    uint8_t groupLengths[NB_REWRITE_MAX_GROUPS];    // the variable group's is its minimum
+    NSUInteger minLength;
+    NSUInteger maxLength;
+    
+    NBRewriteProgram formatProgram;
+    BOOL hasFormatProgram;
+    NBRewriteProgram nationalPrefixProgram;
+    BOOL hasNationalPrefixProgram;
+    NBRewriteProgram carrierCodeProgram;    // the carrier code is group groupCount + 1
+    BOOL hasCarrierCodeProgram;
+}
+
+@property (nonatomic, copy, readonly) NSString *pattern;
+@property (nonatomic, copy, readonly) NSString *format;
+@property (nonatomic, copy, readonly) NSString *nationalPrefixFormattingRule;
+@property (nonatomic, copy, readonly) NSString *domesticCarrierCodeFormattingRule;
+
+- (instancetype)initWithNumberFormat:(NBNumberFormat *)numberFormat;
+- (BOOL)isCompiledFromNumberFormat:(NBNumberFormat *)numberFormat;
+- (NSString *)formatNumber:(NSString *)nationalNumber nationalPrefix:(BOOL)nationalPrefix;
+- (NSString *)formatNumber:(NSString *)nationalNumber carrierCode:(NSString *)carrierCode;
+
+@end
+
+
+@implementation NBFormatRewriter
+
+- (BOOL)compileLayout:(NSString *)pattern
+{
+    unichar characters[NB_REWRITE_MAX_LENGTH];
+    NSUInteger length = pattern.length;
+    if (length == 0 || length > NB_REWRITE_MAX_LENGTH) {
+        return NO;
+    }
+    [pattern getCharacters:characters range:NSMakeRange(0, length)];
+    
+    NBPatternCursor cursor = { characters, length, 0 };
+    groupCount = 0;
+    variableGroup = -1;
+    minLength = maxLength = 0;
+    
+    while (cursor.position < length)
+    {
+        if (characters[cursor.position] != '(' || cursor.position + 1 >= length ||
+            characters[cursor.position + 1] == '?' || groupCount == NB_REWRITE_MAX_GROUPS)
+        {
+            return NO;
+        }
+        cursor.position++;
+        
+        NSUInteger groupMin, groupMax, variables;
+        if (NBParseLayoutSequence(&cursor, &groupMin, &groupMax, &variables) == NO ||
+            cursor.position >= length || characters[cursor.position] != ')')
+        {
+            return NO;
+        }
+        cursor.position++;
+        
+        if (groupMin != groupMax)
+        {
+            if (variables != 1 || variableGroup >= 0) {
+                return NO;
+            }
+            variableGroup = groupCount + 1;
+        }
+        groupLengths[groupCount++] = groupMin;
+        minLength += groupMin;
+        maxLength += groupMax;
+    }
+    
+    return groupCount > 0;
+}
+
+
+- (instancetype)initWithNumberFormat:(NBNumberFormat *)numberFormat
+{
+    self = [super init];
+    if (self)
+    {
+        _pattern = [numberFormat.pattern copy];
+        _format = [numberFormat.format copy];
+        _nationalPrefixFormattingRule = [numberFormat.nationalPrefixFormattingRule copy];
+        _domesticCarrierCodeFormattingRule = [numberFormat.domesticCarrierCodeFormattingRule copy];
+        
+        if ([self compileLayout:_pattern] == NO) {
+            return nil;
+        }
+        
+        hasFormatProgram = NBCompileRewriteTemplateString(_format, groupCount, &formatProgram);
+        
+        NBRewriteProgram rule;
+        unichar format[NB_REWRITE_MAX_LENGTH], spliced[NB_REWRITE_MAX_LENGTH];
+        NSUInteger formatLength = _format.length;
+        if (hasFormatProgram && formatLength <= NB_REWRITE_MAX_LENGTH &&
+            NBCompileRewriteTemplateString(_nationalPrefixFormattingRule, 1, &rule))
+        {
+            [_format getCharacters:format range:NSMakeRange(0, formatLength)];
+            NSUInteger length = NBSpliceFirstGroupRule(format, formatLength, &rule, NULL, spliced, NB_REWRITE_MAX_LENGTH);
+            hasNationalPrefixProgram = length != NSNotFound &&
+                                       NBCompileRewriteTemplate(spliced, length, groupCount, &nationalPrefixProgram);
+        }
+        
+        hasCarrierCodeProgram = hasFormatProgram && [self compileCarrierCodeProgram];
+    }
+    
+    return self;
+}
+
+
+/**
+ * The carrier code changes from call to call, so it's left as a group of its
+ * own: $CC in the carrier code rule becomes a reference to it, and the rule
+ * is spliced in for the format's first group. Formatting then copies the
+ * code in as it is, like any other group.
+ */
+- (BOOL)compileCarrierCodeProgram
+{
+    NSUInteger ruleLength = _domesticCarrierCodeFormattingRule.length, formatLength = _format.length;
+    if (ruleLength == 0 || ruleLength > NB_REWRITE_MAX_LENGTH || formatLength > NB_REWRITE_MAX_LENGTH ||
+        groupCount + 1 > NB_REWRITE_MAX_GROUPS)
+    {
+        return NO;
+    }
+    
+    unichar rule[NB_REWRITE_MAX_LENGTH], format[NB_REWRITE_MAX_LENGTH], spliced[NB_REWRITE_MAX_LENGTH];
+    unichar withoutCode[NB_REWRITE_MAX_LENGTH], withCode[NB_REWRITE_MAX_LENGTH];
+    [_domesticCarrierCodeFormattingRule getCharacters:rule range:NSMakeRange(0, ruleLength)];
+    [_format getCharacters:format range:NSMakeRange(0, formatLength)];
+    
+    // $CC becomes $2; the rule must make sense without it, so a $2 of its own
+    // isn't taken for the code. Rules with escapes are left to the regexes.
+    NSUInteger withoutCodeLength = 0, withCodeLength = 0;
+    for (NSUInteger i = 0; i < ruleLength; )
+    {
+        if (rule[i] == '\\') {
+            return NO;
+        }
+        if (i + 2 < ruleLength && rule[i] == '$' && rule[i + 1] == 'C' && rule[i + 2] == 'C')
+        {
+            withCode[withCodeLength++] = '$';
+            withCode[withCodeLength++] = '2';
+            i += 3;
+        }
+        else
+        {
+            withoutCode[withoutCodeLength++] = rule[i];
+            withCode[withCodeLength++] = rule[i++];
+        }
+    }
+    
+    NBRewriteProgram carrierRule;
+    unichar reference[2] = { '$', (unichar)('0' + groupCount + 1) };
+    NBRewriteGroup carrierGroup = { reference, 2 };
+    NSUInteger splicedLength;
+    return NBCompileRewriteTemplate(withoutCode, withoutCodeLength, 1, &carrierRule) &&
+           NBCompileRewriteTemplate(withCode, withCodeLength, 2, &carrierRule) &&
+           (splicedLength = NBSpliceFirstGroupRule(format, formatLength, &carrierRule, &carrierGroup, spliced, NB_REWRITE_MAX_LENGTH)) != NSNotFound &&
+           NBCompileRewriteTemplate(spliced, splicedLength, groupCount + 1, &carrierCodeProgram);
+}
+
+
+- (BOOL)isCompiledFromNumberFormat:(NBNumberFormat *)numberFormat
+{
+    return NBStringsMatch(_pattern, numberFormat.pattern) && NBStringsMatch(_format, numberFormat.format) &&
+           NBStringsMatch(_nationalPrefixFormattingRule, numberFormat.nationalPrefixFormattingRule) &&
+           NBStringsMatch(_domesticCarrierCodeFormattingRule, numberFormat.domesticCarrierCodeFormattingRule);
+}
+
+
+/**
+ * nationalNumber must match the pattern entirely. Returns nil if the number
+ * or the output is too long for the fast path. carrierCode, if any, is the
+ * group after the pattern's.
+ */
+- (NSString *)formatNumber:(NSString *)nationalNumber carrierCode:(NSString *)carrierCode program:(const NBRewriteProgram *)program
+{
+    NSUInteger length = nationalNumber.length, codeLength = carrierCode.length;
+    if (length < minLength || length > maxLength || length > NB_REWRITE_MAX_LENGTH || codeLength > NB_REWRITE_MAX_LENGTH) {
+        return nil;
+    }
+    
+    unichar number[NB_REWRITE_MAX_LENGTH], code[NB_REWRITE_MAX_LENGTH], output[NB_REWRITE_MAX_LENGTH * 2];
+    [nationalNumber getCharacters:number range:NSMakeRange(0, length)];
+    [carrierCode getCharacters:code range:NSMakeRange(0, codeLength)];
+    
+    NBRewriteGroup groups[NB_REWRITE_MAX_GROUPS + 1];
+    groups[0] = (NBRewriteGroup){ number, length };
+    NSUInteger position = 0;
+    for (NSUInteger i = 1; i <= groupCount; i++)
+    {
+        NSUInteger groupLength = groupLengths[i - 1] + ((int8_t)i == variableGroup ? length - minLength : 0);
+        groups[i] = (NBRewriteGroup){ number + position, groupLength };
+        position += groupLength;
+    }
+    if (groupCount < NB_REWRITE_MAX_GROUPS) {
+        groups[groupCount + 1] = (NBRewriteGroup){ code, codeLength };
+    }
+    
+    NSUInteger outputLength = NBRunRewriteProgram(program, groups, output, sizeof(output) / sizeof(output[0]));
+    return outputLength == NSNotFound ? nil : [NSString stringWithCharacters:output length:outputLength];
+}
+
+
+- (NSString *)formatNumber:(NSString *)nationalNumber nationalPrefix:(BOOL)nationalPrefix
+{
+    if (nationalPrefix) {
+        return hasNationalPrefixProgram ? [self formatNumber:nationalNumber carrierCode:nil program:&nationalPrefixProgram] : nil;
+    }
+    return hasFormatProgram ? [self formatNumber:nationalNumber carrierCode:nil program:&formatProgram] : nil;
+}
+
+
+- (NSString *)formatNumber:(NSString *)nationalNumber carrierCode:(NSString *)carrierCode
+{
+    return hasCarrierCodeProgram ? [self formatNumber:nationalNumber carrierCode:carrierCode program:&carrierCodeProgram] : nil;
+}
+
+@end
+
+
 #pragma mark - NBPhoneNumberUtil interface -
 
 @interface NBPhoneNumberUtil ()
 {
-    NSMutableDictionary *entireStringRegexCache;
-    NSLock *entireStringCacheLock;
-    NSMutableDictionary *regexPatternCache;
-    NSLock *lockPatternCache;
+    NBRegularExpressionCache *entireStringRegexCache;
+    NBRegularExpressionCache *regexPatternCache;
 }
 
 @property (nonatomic, strong, readwrite) NSMutableDictionary *i18nNumberFormat;
@@ -89,11 +1744,6 @@ static NSString *VALID_START_CHAR_PATTERN;
 static NSString *UNWANTED_END_CHAR_PATTERN;
 static NSString *SECOND_NUMBER_START_PATTERN;
 
-static NSDictionary *ALPHA_MAPPINGS;
-static NSDictionary *ALL_NORMALIZATION_MAPPINGS;
-static NSDictionary *DIALLABLE_CHAR_MAPPINGS;
-static NSDictionary *ALL_PLUS_NUMBER_GROUPING_SYMBOLS;
-
 static NSRegularExpression *PLUS_CHARS_PATTERN;
 static NSRegularExpression *CAPTURING_DIGIT_PATTERN;
 static NSRegularExpression *VALID_ALPHA_PHONE_PATTERN;
@@ -162,52 +1812,18 @@ static NSDictionary *DIGIT_MAPPINGS;
                                                     options:(NSRegularExpressionOptions)options
                                                       error:(NSError **)error
 {
-    [entireStringCacheLock lock];
-    
-    @try {
-        if (! entireStringRegexCache) {
-            entireStringRegexCache = [[NSMutableDictionary alloc] init];
-        }
-        
-        NSRegularExpression *regex = [entireStringRegexCache objectForKey:regexPattern];
-        if (! regex)
-        {
-            NSString *finalRegexString = regexPattern;
-            if ([regexPattern rangeOfString:@"^"].location == NSNotFound) {
-                finalRegexString = [NSString stringWithFormat:@"^(?:%@)$", regexPattern];
-            }
-            
-            regex = [self regularExpressionWithPattern:finalRegexString options:0 error:error];
-            [entireStringRegexCache setObject:regex forKey:regexPattern];
-        }
-        
-        return regex;
-    }
-    @finally {
-        [entireStringCacheLock unlock];
+    NSString *finalRegexString = regexPattern;
+    if ([regexPattern rangeOfString:@"^"].location == NSNotFound) {
+        finalRegexString = [NSString stringWithFormat:@"^(?:%@)$", regexPattern];
     }
+    
+    return [entireStringRegexCache regularExpressionForKey:regexPattern pattern:finalRegexString options:0 error:error];
 }
 
 
 - (NSRegularExpression *)regularExpressionWithPattern:(NSString *)pattern options:(NSRegularExpressionOptions)options error:(NSError **)error
 {
-    [lockPatternCache lock];
-    
-    @try {
-        if (!regexPatternCache) {
-            regexPatternCache = [[NSMutableDictionary alloc] init];
-        }
-        
-        NSRegularExpression *regex = [regexPatternCache objectForKey:pattern];
-        if (!regex) {
-            regex = [NSRegularExpression regularExpressionWithPattern:pattern options:options error:error];
-            [regexPatternCache setObject:regex forKey:pattern];
-        }
-        return regex;
-    }
-    @finally {
-        [lockPatternCache unlock];
-    }
+    return [regexPatternCache regularExpressionForKey:pattern pattern:pattern options:options error:error];
 }
 
 
@@ -349,28 +1965,6 @@ static NSDictionary *DIGIT_MAPPINGS;
 }
 
 
-- (NSString*)stringByReplacingOccurrencesString:(NSString *)sourceString withMap:(NSDictionary *)dicMap removeNonMatches:(BOOL)bRemove
-{
-    NSMutableString *targetString = [[NSMutableString alloc] initWithString:@""];
-    
-    for(unsigned int i=0; i<sourceString.length; i++)
-    {
-        unichar oneChar = [sourceString characterAtIndex:i];
-        NSString *keyString = [NSString stringWithCharacters:&oneChar length:1];
-        NSString *mappedValue = [dicMap objectForKey:keyString];
-        if (mappedValue != nil) {
-            [targetString appendString:mappedValue];
-        } else {
-            if (bRemove == NO) {
-                [targetString appendString:keyString];
-            }
-        }
-    }
-    
-    return targetString;
-}
-
-
 - (BOOL)isAllDigits:(NSString*)sourceString
 {
     NSCharacterSet *nonNumbers = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
@@ -413,16 +2007,73 @@ static NSDictionary *DIGIT_MAPPINGS;
     self = [super init];
     if (self)
     {
-        lockPatternCache = [[NSLock alloc] init];
-        entireStringCacheLock = [[NSLock alloc] init];
+        regexPatternCache = [[NBRegularExpressionCache alloc] init];
+        entireStringRegexCache = [[NBRegularExpressionCache alloc] init];
         [self initRegularExpressionSet];
-        [self initNormalizationMappings];
     }
     
     return self;
 }
 
 
+/**
+ * Compiles up front the regular expressions, and number type matchers, that
+ * validating and formatting numbers from the given regions will need, so
+ * worker threads start out on lock-free cache hits.
+ *
+ * The regions' metadata goes through the metadata cache, which is where
+ * their matchers live, so list only the regions the app actually handles:
+ * more than setMetadataCacheLimit: allows evicts the earlier ones again, and
+ * whatever the app had cached before. Does nothing for nil.
+ */
+- (void)prewarmRegularExpressionsForRegions:(NSArray *)regionCodes
+{
+    NSError *error = nil;
+    
+    [regexPatternCache beginBatch];
+    [entireStringRegexCache beginBatch];
+    for (NSString *regionCode in regionCodes)
+    {
+        NBPhoneMetaData *metadata = [NBMetadataHelper getMetadataForRegion:regionCode];
+        if (metadata == nil) {
+            continue;
+        }
+        
+        NBPhoneNumberDesc *descs[] = {
+            metadata.generalDesc, metadata.fixedLine, metadata.mobile, metadata.tollFree, metadata.premiumRate, metadata.sharedCost,
+            metadata.personalNumber, metadata.voip, metadata.pager, metadata.uan, metadata.voicemail, metadata.noInternationalDialling
+        };
+        for (NSUInteger i = 0; i < sizeof(descs) / sizeof(descs[0]); i++)
+        {
+            for (NSString *pattern in @[ descs[i].nationalNumberPattern ?: @"NA", descs[i].possibleNumberPattern ?: @"NA" ])
+            {
+                if ([NBMetadataHelper hasValue:pattern] && [pattern isEqualToString:@"NA"] == NO) {
+                    [self entireRegularExpressionWithPattern:pattern options:0 error:&error];
+                }
+            }
+        }
+        
+        NSArray *numberFormats = [(metadata.numberFormats ?: @[]) arrayByAddingObjectsFromArray:(metadata.intlNumberFormats ?: @[])];
+        for (NBNumberFormat *numberFormat in numberFormats)
+        {
+            if ([NBMetadataHelper hasValue:numberFormat.pattern]) {
+                [self entireRegularExpressionWithPattern:numberFormat.pattern options:0 error:&error];
+                [self regularExpressionWithPattern:numberFormat.pattern options:0 error:&error];
+            }
+            
+            for (NSString *leadingDigits in numberFormat.leadingDigitsPatterns) {
+                [self regularExpressionWithPattern:leadingDigits options:0 error:&error];
+            }
+        }
+        
+        [self numberTypeMatcherForMetadata:metadata];
+    }
+    
+    [regexPatternCache endBatch];
+    [entireStringRegexCache endBatch];
+}
+
+
 - (void)initRegularExpressionSet
 {
     NSString *EXTN_PATTERNS_FOR_PARSING = @"(?:;ext=([0-9０-９٠-٩۰-۹]{1,7})|[  \\t,]*(?:e?xt(?:ensi(?:ó?|ó))?n?|ｅ?ｘｔｎ?|[,xｘX#＃~～]|int|anexo|ｉｎｔ)[:\\.．]?[  \\t,-]*([0-9０-９٠-٩۰-۹]{1,7})#?|[- ]+([0-9０-９٠-٩۰-۹]{1,5})#)$";
@@ -486,52 +2137,6 @@ static NSDictionary *DIGIT_MAPPINGS;
 }
 
 
-- (void)initNormalizationMappings
-{
-    if (!DIALLABLE_CHAR_MAPPINGS) {
-        DIALLABLE_CHAR_MAPPINGS = [NSDictionary dictionaryWithObjectsAndKeys:
-                                   @"0", @"0", @"1", @"1", @"2", @"2", @"3", @"3", @"4", @"4", @"5", @"5", @"6", @"6", @"7", @"7", @"8", @"8", @"9", @"9",
-                                   @"+", @"+", @"*", @"*", nil];
-    }
-    
-    if (!ALPHA_MAPPINGS) {
-        ALPHA_MAPPINGS = [NSDictionary dictionaryWithObjectsAndKeys:
-                          @"2", @"A", @"2", @"B", @"2", @"C", @"3", @"D", @"3", @"E", @"3", @"F", @"4", @"G", @"4", @"H", @"4", @"I", @"5", @"J",
-                          @"5", @"K", @"5", @"L", @"6", @"M", @"6", @"N", @"6", @"O", @"7", @"P", @"7", @"Q", @"7", @"R", @"7", @"S", @"8", @"T",
-                          @"8", @"U", @"8", @"V", @"9", @"W", @"9", @"X", @"9", @"Y", @"9", @"Z", nil];
-    }
-    
-    if (!ALL_NORMALIZATION_MAPPINGS) {
-        ALL_NORMALIZATION_MAPPINGS = [NSDictionary dictionaryWithObjectsAndKeys:
-                                      @"0", @"0", @"1", @"1", @"2", @"2", @"3", @"3", @"4", @"4", @"5", @"5", @"6", @"6", @"7", @"7", @"8", @"8", @"9", @"9",
-                                      // Fullwidth digit 0 to 9
-                                      @"0", @"\uFF10", @"1", @"\uFF11", @"2", @"\uFF12", @"3", @"\uFF13", @"4", @"\uFF14", @"5", @"\uFF15", @"6", @"\uFF16", @"7", @"\uFF17", @"8", @"\uFF18", @"9", @"\uFF19",
-                                      // Arabic-indic digit 0 to 9
-                                      @"0", @"\u0660", @"1", @"\u0661", @"2", @"\u0662", @"3", @"\u0663", @"4", @"\u0664", @"5", @"\u0665", @"6", @"\u0666", @"7", @"\u0667", @"8", @"\u0668", @"9", @"\u0669",
-                                      // Eastern-Arabic digit 0 to 9
-                                      @"0", @"\u06F0", @"1", @"\u06F1",  @"2", @"\u06F2", @"3", @"\u06F3", @"4", @"\u06F4", @"5", @"\u06F5", @"6", @"\u06F6", @"7", @"\u06F7", @"8", @"\u06F8", @"9", @"\u06F9",
-                                      @"2", @"A", @"2", @"B", @"2", @"C", @"3", @"D", @"3", @"E", @"3", @"F", @"4", @"G", @"4", @"H", @"4", @"I", @"5", @"J",
-                                      @"5", @"K", @"5", @"L", @"6", @"M", @"6", @"N", @"6", @"O", @"7", @"P", @"7", @"Q", @"7", @"R", @"7", @"S", @"8", @"T",
-                                      @"8", @"U", @"8", @"V", @"9", @"W", @"9", @"X", @"9", @"Y", @"9", @"Z", nil];
-    }
-    
-    if (!ALL_PLUS_NUMBER_GROUPING_SYMBOLS) {
-        ALL_PLUS_NUMBER_GROUPING_SYMBOLS = [NSDictionary dictionaryWithObjectsAndKeys:
-                                            @"0", @"0", @"1", @"1", @"2", @"2", @"3", @"3", @"4", @"4", @"5", @"5", @"6", @"6", @"7", @"7", @"8", @"8", @"9", @"9",
-                                            @"A", @"A", @"B", @"B", @"C", @"C", @"D", @"D", @"E", @"E", @"F", @"F", @"G", @"G", @"H", @"H", @"I", @"I", @"J", @"J",
-                                            @"K", @"K", @"L", @"L", @"M", @"M", @"N", @"N", @"O", @"O", @"P", @"P", @"Q", @"Q", @"R", @"R", @"S", @"S", @"T", @"T",
-                                            @"U", @"U", @"V", @"V", @"W", @"W", @"X", @"X", @"Y", @"Y", @"Z", @"Z", @"A", @"a", @"B", @"b", @"C", @"c", @"D", @"d",
-                                            @"E", @"e", @"F", @"f", @"G", @"g", @"H", @"h", @"I", @"i", @"J", @"j", @"K", @"k", @"L", @"l", @"M", @"m", @"N", @"n",
-                                            @"O", @"o", @"P", @"p", @"Q", @"q", @"R", @"r", @"S", @"s", @"T", @"t", @"U", @"u", @"V", @"v", @"W", @"w", @"X", @"x",
-                                            @"Y", @"y", @"Z", @"z", @"-", @"-", @"-", @"\uFF0D", @"-", @"\u2010", @"-", @"\u2011", @"-", @"\u2012", @"-", @"\u2013", @"-", @"\u2014", @"-", @"\u2015",
-                                            @"-", @"\u2212", @"/", @"/", @"/", @"\uFF0F", @" ", @" ", @" ", @"\u3000", @" ", @"\u2060", @".", @".", @".", @"\uFF0E", nil];
-    }
-}
-
-
-
-
-
 #pragma mark - Metadata manager (phonenumberutil.js) functions -
 /**
  * Attempts to extract a possible number from the string passed in. This
@@ -627,7 +2232,7 @@ static NSDictionary *DIGIT_MAPPINGS;
     
     if ([self matchesEntirely:VALID_ALPHA_PHONE_PATTERN_STRING string:number])
     {
-        return [self normalizeHelper:number normalizationReplacements:ALL_NORMALIZATION_MAPPINGS removeNonMatches:true];
+        return [self normalizeHelper:number folding:NBFoldingAlphaPhone removeNonMatches:true];
     }
     else
     {
@@ -669,10 +2274,7 @@ static NSDictionary *DIGIT_MAPPINGS;
  */
 - (NSString*)normalizeDigitsOnly:(NSString*)number
 {
-    number = [NBMetadataHelper normalizeNonBreakingSpace:number];
-    
-    return [self stringByReplacingOccurrencesString:number
-                                            withMap:self.DIGIT_MAPPINGS removeNonMatches:YES];
+    return [self normalizeHelper:number folding:NBFoldingDigitsOnly removeNonMatches:YES];
 }
 
 
@@ -686,9 +2288,7 @@ static NSDictionary *DIGIT_MAPPINGS;
  */
 - (NSString*)convertAlphaCharactersInNumber:(NSString*)number
 {
-    number = [NBMetadataHelper normalizeNonBreakingSpace:number];
-    return [self stringByReplacingOccurrencesString:number
-                                            withMap:ALL_NORMALIZATION_MAPPINGS removeNonMatches:NO];
+    return [self normalizeHelper:number folding:NBFoldingAlphaInNumber removeNonMatches:NO];
 }
 
 
@@ -891,46 +2491,24 @@ static NSDictionary *DIGIT_MAPPINGS;
 
 
 /**
- * Normalizes a string of characters representing a phone number by replacing
- * all characters found in the accompanying map with the values therein, and
- * stripping all other characters if removeNonMatches is NO.
+ * Normalizes a string of characters representing a phone number by folding
+ * the characters the folding matches, and stripping all other characters if
+ * removeNonMatches is YES. Letters are matched case-insensitively only when
+ * the folding includes NBFoldLowerAlpha.
  *
  * @param {string} number a string of characters representing a phone number.
- * @param {!Object.<string, string>} normalizationReplacements a mapping of
- *     characters to what they should be replaced by in the normalized version
- *     of the phone number.
+ * @param {NBCharacterFolding} folding the character classes to fold; see
+ *     NBFoldString.
  * @param {boolean} removeNonMatches indicates whether characters that are not
  *     able to be replaced should be stripped from the number. If this is NO,
  *     they will be left unchanged in the number.
  * @return {string} the normalized string version of the phone number.
  * @private
  */
-- (NSString*)normalizeHelper:(NSString*)sourceString normalizationReplacements:(NSDictionary*)normalizationReplacements
+- (NSString*)normalizeHelper:(NSString*)sourceString folding:(NBCharacterFolding)folding
             removeNonMatches:(BOOL)removeNonMatches
 {
-    NSMutableString *normalizedNumber = [[NSMutableString alloc] init];
-    unichar character = 0;
-    NSString *newDigit = @"";
-    unsigned int numberLength = (unsigned int)sourceString.length;
-    
-    for (unsigned int i = 0; i<numberLength; ++i)
-    {
-        character = [sourceString characterAtIndex:i];
-        newDigit = [normalizationReplacements objectForKey:[[NSString stringWithFormat: @"%C", character] uppercaseString]];
-        if (newDigit != nil)
-        {
-            [normalizedNumber appendString:newDigit];
-        }
-        else if (removeNonMatches == NO)
-        {
-            [normalizedNumber appendString:[NSString stringWithFormat: @"%C", character]];
-        }
-        // If neither of the above are NO, we remove this character.
-        
-        //NSLog(@"[%@]", normalizedNumber);
-    }
-    
-    return normalizedNumber;
+    return NBFoldString(sourceString, folding, removeNonMatches);
 }
 
 
@@ -1399,7 +2977,7 @@ static NSDictionary *DIGIT_MAPPINGS;
     }
     
     return withFormatting ?
-    formattedNumber : [self normalizeHelper:formattedNumber normalizationReplacements:DIALLABLE_CHAR_MAPPINGS removeNonMatches:YES];
+    formattedNumber : [self normalizeHelper:formattedNumber folding:NBFoldingDiallable removeNonMatches:YES];
 }
 
 
@@ -1677,9 +3255,9 @@ static NSDictionary *DIGIT_MAPPINGS;
     // user entered.
     if (formattedNumber != nil && rawInput.length > 0)
     {
-        NSString *normalizedFormattedNumber = [self normalizeHelper:formattedNumber normalizationReplacements:DIALLABLE_CHAR_MAPPINGS removeNonMatches:YES];
+        NSString *normalizedFormattedNumber = [self normalizeHelper:formattedNumber folding:NBFoldingDiallable removeNonMatches:YES];
         /** @type {string} */
-        NSString *normalizedRawInput = [self normalizeHelper:rawInput normalizationReplacements:DIALLABLE_CHAR_MAPPINGS removeNonMatches:YES];
+        NSString *normalizedRawInput = [self normalizeHelper:rawInput folding:NBFoldingDiallable removeNonMatches:YES];
         
         if ([normalizedFormattedNumber isEqualToString:normalizedRawInput] == NO)
         {
@@ -1818,7 +3396,7 @@ static NSDictionary *DIGIT_MAPPINGS;
     // this by comparing the number in raw_input with the parsed number. To do
     // this, first we normalize punctuation. We retain number grouping symbols
     // such as ' ' only.
-    rawInput = [self normalizeHelper:rawInput normalizationReplacements:ALL_PLUS_NUMBER_GROUPING_SYMBOLS removeNonMatches:NO];
+    rawInput = [self normalizeHelper:rawInput folding:NBFoldingPlusNumberGrouping removeNonMatches:NO];
     //NSLog(@"---- formatOutOfCountryKeepingAlphaChars normalizeHelper rawInput [%@]", rawInput);
     // Now we trim everything before the first three digits in the parsed number.
     // We choose three because all valid alpha numbers have 3 digits at the start
@@ -1958,6 +3536,23 @@ static NSDictionary *DIGIT_MAPPINGS;
 }
 
 
+/**
+ * The compiled form of a number format, built on first use. Nil when the
+ * format has to be applied with regexes.
+ */
+- (NBFormatRewriter *)formatRewriterForNumberFormat:(NBNumberFormat*)numberFormat
+{
+    id rewriter = objc_getAssociatedObject(numberFormat, &kNBFormatRewriterKey);
+    if (rewriter == nil || (rewriter != [NSNull null] && [rewriter isCompiledFromNumberFormat:numberFormat] == NO))
+    {
+        rewriter = [[NBFormatRewriter alloc] initWithNumberFormat:numberFormat] ?: [NSNull null];
+        objc_setAssociatedObject(numberFormat, &kNBFormatRewriterKey, rewriter, OBJC_ASSOCIATION_RETAIN);
+    }
+    
+    return rewriter == [NSNull null] ? nil : rewriter;
+}
+
+
 /**
  * Note that carrierCode is optional - if nil or an empty string, no carrier
  * code replacement will take place.
@@ -1971,22 +3566,37 @@ static NSDictionary *DIGIT_MAPPINGS;
  * @param {string=} opt_carrierCode
  * @return {string} the formatted phone number.
  * @private
+ *
+ * nationalNumber must match formattingPattern.pattern entirely, as
+ * chooseFormattingPatternForNumber:nationalNumber: checks; NBFormatRewriter
+ * relies on it. Only patterns it can't compile, such as "(\\d+)(.*)", may be
+ * used on other input.
  */
 - (NSString*)formatNsnUsingPattern:(NSString*)nationalNumber formattingPattern:(NBNumberFormat*)formattingPattern numberFormat:(NBEPhoneNumberFormat)numberFormat carrierCode:(NSString*)opt_carrierCode
 {
     NSString *numberFormatRule = formattingPattern.format;
     NSString *domesticCarrierCodeFormattingRule = formattingPattern.domesticCarrierCodeFormattingRule;
     NSString *formattedNationalNumber = @"";
+    NBFormatRewriter *rewriter = [self formatRewriterForNumberFormat:formattingPattern];
     
     if (numberFormat == NBEPhoneNumberFormatNATIONAL && [NBMetadataHelper hasValue:opt_carrierCode] && domesticCarrierCodeFormattingRule.length > 0)
     {
-        // Replace the $CC in the formatting rule with the desired carrier code.
-        NSString *carrierCodeFormattingRule = [self replaceStringByRegex:domesticCarrierCodeFormattingRule regex:CC_PATTERN withTemplate:opt_carrierCode];
-        // Now replace the $FG in the formatting rule with the first group and
-        // the carrier code combined in the appropriate way.
-        numberFormatRule = [self replaceFirstStringByRegex:numberFormatRule regex:FIRST_GROUP_PATTERN
-                                              withTemplate:carrierCodeFormattingRule];
-        formattedNationalNumber = [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:numberFormatRule];
+        formattedNationalNumber = [rewriter formatNumber:nationalNumber carrierCode:opt_carrierCode];
+        if (formattedNationalNumber == nil)
+        {
+            // Replace the $CC in the formatting rule with the desired carrier code,
+            // escaped for each of the three template expansions it goes through.
+            NSString *carrierCode = opt_carrierCode;
+            for (NSUInteger i = 0; i < 3; i++) {
+                carrierCode = [NSRegularExpression escapedTemplateForString:carrierCode];
+            }
+            NSString *carrierCodeFormattingRule = [self replaceStringByRegex:domesticCarrierCodeFormattingRule regex:CC_PATTERN withTemplate:carrierCode];
+            // Now replace the $FG in the formatting rule with the first group and
+            // the carrier code combined in the appropriate way.
+            numberFormatRule = [self replaceFirstStringByRegex:numberFormatRule regex:FIRST_GROUP_PATTERN
+                                                  withTemplate:carrierCodeFormattingRule];
+            formattedNationalNumber = [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:numberFormatRule];
+        }
     }
     else
     {
@@ -1994,12 +3604,17 @@ static NSDictionary *DIGIT_MAPPINGS;
         NSString *nationalPrefixFormattingRule = formattingPattern.nationalPrefixFormattingRule;
         if (numberFormat == NBEPhoneNumberFormatNATIONAL && [NBMetadataHelper hasValue:nationalPrefixFormattingRule])
         {
-            NSString *replacePattern = [self replaceFirstStringByRegex:numberFormatRule regex:FIRST_GROUP_PATTERN withTemplate:nationalPrefixFormattingRule];
-            formattedNationalNumber = [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:replacePattern];
+            formattedNationalNumber = [rewriter formatNumber:nationalNumber nationalPrefix:YES];
+            if (formattedNationalNumber == nil)
+            {
+                NSString *replacePattern = [self replaceFirstStringByRegex:numberFormatRule regex:FIRST_GROUP_PATTERN withTemplate:nationalPrefixFormattingRule];
+                formattedNationalNumber = [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:replacePattern];
+            }
         }
         else
         {
-            formattedNationalNumber = [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:numberFormatRule];
+            formattedNationalNumber = [rewriter formatNumber:nationalNumber nationalPrefix:NO] ?:
+                                      [self replaceStringByRegex:nationalNumber regex:formattingPattern.pattern withTemplate:numberFormatRule];
         }
     }
     
@@ -2198,6 +3813,12 @@ static NSDictionary *DIGIT_MAPPINGS;
  */
 - (NBEPhoneNumberType)getNumberTypeHelper:(NSString*)nationalNumber metadata:(NBPhoneMetaData*)metadata
 {
+    uint32_t matchedDescs = 0;
+    if ([[self numberTypeMatcherForMetadata:metadata] matchNumber:nationalNumber descs:&matchedDescs])
+    {
+        return [self getNumberTypeForMatchedDescs:matchedDescs metadata:metadata];
+    }
+    
     NBPhoneNumberDesc *generalNumberDesc = metadata.generalDesc;
     
     //NSLog(@"getNumberTypeHelper - UNKNOWN 1");
@@ -2291,6 +3912,71 @@ static NSDictionary *DIGIT_MAPPINGS;
 }
 
 
+/**
+ * Returns the region's compiled matcher, building it on first use. Regions
+ * whose patterns the automaton can't express get none, and are classified
+ * with the regexes as before.
+ */
+- (NBNumberTypeMatcher *)numberTypeMatcherForMetadata:(NBPhoneMetaData*)metadata
+{
+    if (metadata == nil) {
+        return nil;
+    }
+    
+    id matcher = objc_getAssociatedObject(metadata, &kNBNumberTypeMatcherKey);
+    if (matcher == nil)
+    {
+        matcher = [[NBNumberTypeMatcher alloc] initWithMetadata:metadata] ?: [NSNull null];
+        objc_setAssociatedObject(metadata, &kNBNumberTypeMatcherKey, matcher, OBJC_ASSOCIATION_RETAIN);
+    }
+    
+    return matcher == [NSNull null] ? nil : matcher;
+}
+
+
+/**
+ * The same decision as the regex path of getNumberTypeHelper:metadata:, made
+ * from the descs the number was found to match.
+ */
+- (NBEPhoneNumberType)getNumberTypeForMatchedDescs:(uint32_t)matchedDescs metadata:(NBPhoneMetaData*)metadata
+{
+    static const NBEPhoneNumberType specialTypes[] = {
+        NBEPhoneNumberTypePREMIUM_RATE, NBEPhoneNumberTypeTOLL_FREE, NBEPhoneNumberTypeSHARED_COST, NBEPhoneNumberTypeVOIP,
+        NBEPhoneNumberTypePERSONAL_NUMBER, NBEPhoneNumberTypePAGER, NBEPhoneNumberTypeUAN, NBEPhoneNumberTypeVOICEMAIL
+    };
+    
+    if ((matchedDescs & (1u << NBNumberTypeDescGeneral)) == 0)
+    {
+        return NBEPhoneNumberTypeUNKNOWN;
+    }
+    
+    for (NSUInteger i = 0; i < sizeof(specialTypes) / sizeof(specialTypes[0]); i++)
+    {
+        if (matchedDescs & (1u << (NBNumberTypeDescPremiumRate + i)))
+        {
+            return specialTypes[i];
+        }
+    }
+    
+    BOOL isMobile = (matchedDescs & (1u << NBNumberTypeDescMobile)) != 0;
+    if (matchedDescs & (1u << NBNumberTypeDescFixedLine))
+    {
+        if (metadata.sameMobileAndFixedLinePattern || isMobile)
+        {
+            return NBEPhoneNumberTypeFIXED_LINE_OR_MOBILE;
+        }
+        return NBEPhoneNumberTypeFIXED_LINE;
+    }
+    
+    if (metadata.sameMobileAndFixedLinePattern == NO && isMobile)
+    {
+        return NBEPhoneNumberTypeMOBILE;
+    }
+    
+    return NBEPhoneNumberTypeUNKNOWN;
+}
+
+
 /**
  * @param {string} nationalNumber
  * @param {i18n.phonenumbers.PhoneNumberDesc} numberDesc
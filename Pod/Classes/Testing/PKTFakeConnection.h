@@ -0,0 +1,32 @@
+#import <Foundation/Foundation.h>
+#import "PKTBackend.h"
+
+@class PKTFakeDevice;
+
+// A connection made or received by a PKTFakeDevice. Local actions behave as
+// TCConnection's are documented to: reject reports no disconnect, ignore
+// does, and accept does nothing while the device is busy with another call.
+// The simulate... methods play the remote side. Delegate callbacks arrive on
+// the device's callbackQueue.
+@interface PKTFakeConnection : NSObject <PKTConnection>
+
+@property (nonatomic, assign, readonly) TCConnectionState state;
+@property (nonatomic, assign, readonly, getter=isIncoming) BOOL incoming;
+@property (nonatomic, strong, readonly) NSDictionary      *parameters;
+@property (nonatomic, weak            ) id<TCConnectionDelegate> delegate;
+@property (nonatomic, assign, getter=isMuted) BOOL muted;
+
+@property (nonatomic, weak,   readonly) PKTFakeDevice     *device;
+@property (nonatomic, strong, readonly) NSString          *sentDigits;  // everything passed to sendDigits:
+@property (nonatomic, assign, readonly) BOOL              ignored;
+
+- (instancetype)initWithDevice:(PKTFakeDevice *)device parameters:(NSDictionary *)parameters incoming:(BOOL)incoming;
+
+// the far end picks up (outgoing) or the media connects (accepted incoming)
+- (void)simulateConnect;
+// the far end hangs up
+- (void)simulateRemoteHangup;
+// the call fails, e.g. a dropped network
+- (void)simulateFailureWithError:(NSError *)error;
+
+@end
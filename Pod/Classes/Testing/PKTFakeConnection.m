@@ -0,0 +1,166 @@
+#import "PKTFakeConnection.h"
+#import "PKTFakeDevice.h"
+
+@interface PKTFakeDevice (PKTFakeConnection)
+
+- (void)deliverAfter:(NSTimeInterval)delay block:(dispatch_block_t)block;
+- (NSString *)nextCallSid;
+- (void)connectionDidChangeState:(PKTFakeConnection *)connection;
+
+@end
+
+@interface PKTFakeConnection ()
+
+@property (nonatomic, assign, readwrite) TCConnectionState state;
+@property (nonatomic, strong, readwrite) NSDictionary      *parameters;
+@property (nonatomic, strong, readwrite) NSString          *sentDigits;
+@property (nonatomic, assign, readwrite) BOOL              ignored;
+
+@end
+
+@implementation PKTFakeConnection
+
+- (instancetype)initWithDevice:(PKTFakeDevice *)device parameters:(NSDictionary *)parameters incoming:(BOOL)incoming
+{
+    if (self = [super init]) {
+        _device     = device;
+        _incoming   = incoming;
+        _state      = incoming ? TCConnectionStatePending : TCConnectionStateConnecting;
+        _sentDigits = @"";
+
+        // incoming calls know their CallSid up front; outgoing ones once connected
+        NSMutableDictionary *params = [NSMutableDictionary dictionaryWithDictionary:parameters];
+        if (incoming && !params[TCConnectionParameterCallSIDKey])
+            params[TCConnectionParameterCallSIDKey] = [device nextCallSid];
+        _parameters = params;
+    }
+    return self;
+}
+
+- (BOOL)isLive
+{
+    return self.state == TCConnectionStateConnecting || self.state == TCConnectionStateConnected;
+}
+
+- (void)setMuted:(BOOL)muted
+{
+    // as with TCConnection, only takes effect once connected
+    if (self.state == TCConnectionStateConnected)
+        _muted = muted;
+}
+
+#pragma mark - Local actions
+
+- (void)accept
+{
+    if (self.state != TCConnectionStatePending || self.ignored || self.device.state == TCDeviceStateBusy)
+        return;
+
+    [self startConnecting];
+}
+
+- (void)ignore
+{
+    if (self.state != TCConnectionStatePending || self.ignored)
+        return;
+
+    self.ignored = YES;
+    [self finishWithError:nil];
+}
+
+- (void)reject
+{
+    if (self.state != TCConnectionStatePending)
+        return;
+
+    // ends without a word to the delegate, as TCConnection's reject does
+    self.state = TCConnectionStateDisconnected;
+    [self.device connectionDidChangeState:self];
+}
+
+- (void)disconnect
+{
+    if (self.state != TCConnectionStateDisconnected)
+        [self finishWithError:nil];
+}
+
+- (void)sendDigits:(NSString *)digits
+{
+    if (self.state == TCConnectionStateConnected && digits.length)
+        self.sentDigits = [self.sentDigits stringByAppendingString:digits];
+}
+
+#pragma mark - Remote side
+
+- (void)simulateConnect
+{
+    if (![self isLive] || self.state == TCConnectionStateConnected)
+        return;
+
+    if (!self.parameters[TCConnectionParameterCallSIDKey]) {
+        NSMutableDictionary *params = [self.parameters mutableCopy];
+        params[TCConnectionParameterCallSIDKey] = [self.device nextCallSid];
+        self.parameters = params;
+    }
+    self.state = TCConnectionStateConnected;
+    [self.device connectionDidChangeState:self];
+
+    [self.device deliverAfter:0 block:^{
+        if ([self.delegate respondsToSelector:@selector(connectionDidConnect:)])
+            [self.delegate connectionDidConnect:(id)self];
+    }];
+}
+
+- (void)simulateRemoteHangup
+{
+    if (self.state != TCConnectionStateDisconnected)
+        [self finishWithError:nil];
+}
+
+- (void)simulateFailureWithError:(NSError *)error
+{
+    if (self.state == TCConnectionStateDisconnected)
+        return;
+
+    [self finishWithError:error ?: [NSError errorWithDomain:PKTFakeDeviceErrorDomain
+                                                       code:PKTFakeDeviceErrorFailed
+                                                   userInfo:nil]];
+}
+
+#pragma mark - Helpers
+
+// called by the device for outgoing connections, and by accept
+- (void)startConnecting
+{
+    self.state = TCConnectionStateConnecting;
+    [self.device connectionDidChangeState:self];
+
+    [self.device deliverAfter:0 block:^{
+        if ([self.delegate respondsToSelector:@selector(connectionDidStartConnecting:)])
+            [self.delegate connectionDidStartConnecting:(id)self];
+    }];
+
+    NSTimeInterval delay = self.device.connectDelay;
+    if (delay >= 0) {
+        [self.device deliverAfter:delay block:^{
+            [self simulateConnect];
+        }];
+    }
+}
+
+- (void)finishWithError:(NSError *)error
+{
+    self.state = TCConnectionStateDisconnected;
+    [self.device connectionDidChangeState:self];
+
+    [self.device deliverAfter:0 block:^{
+        if (error) {
+            if ([self.delegate respondsToSelector:@selector(connection:didFailWithError:)])
+                [self.delegate connection:(id)self didFailWithError:error];
+        } else if ([self.delegate respondsToSelector:@selector(connectionDidDisconnect:)]) {
+            [self.delegate connectionDidDisconnect:(id)self];
+        }
+    }];
+}
+
+@end
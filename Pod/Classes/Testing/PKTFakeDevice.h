@@ -0,0 +1,66 @@
+#import <Foundation/Foundation.h>
+#import "PKTBackend.h"
+#import "PKTFakeConnection.h"
+
+extern NSString *const PKTFakeDeviceErrorDomain;
+
+typedef NS_ENUM(NSInteger, PKTFakeDeviceError) {
+    PKTFakeDeviceErrorDropped = 1,
+    PKTFakeDeviceErrorFailed,
+};
+
+// An in-process stand-in for TCDevice, for exercising PKTPhone without
+// TwilioSDK, a capability token or a network:
+//
+//     PKTFakeDevice *device = [PKTFakeDevice new];
+//     device.timeScale = 0.01;                        // 100x faster
+//     phone.phoneDevice = device;
+//     phone.capabilityToken = @"fake";
+//     [device after:1 perform:^(PKTFakeDevice *d) { [d simulateIncomingCallFrom:@"+14155550100"]; }];
+//     [device simulateIncomingBurst:20 spacing:0.5];
+//
+// Every delay is scaled by timeScale, and every delegate callback is
+// delivered asynchronously on callbackQueue, as TwilioSDK does. The device
+// may be driven from any thread.
+@interface PKTFakeDevice : NSObject <PKTDevice>
+
+@property (nonatomic, assign, readonly) TCDeviceState state;
+@property (nonatomic, strong          ) NSDictionary  *capabilities;
+@property (nonatomic, weak            ) id<TCDeviceDelegate> delegate;
+
+@property (nonatomic, assign) NSTimeInterval   timeScale;        // default 1
+@property (nonatomic, strong) dispatch_queue_t callbackQueue;    // default main queue
+
+// How long connect:delegate: and accept take to reach the connected state.
+// Negative means never on their own; call simulateConnect. Default 0.
+@property (nonatomic, assign) NSTimeInterval connectDelay;
+
+// called for each connection made with connect:delegate:, once it's started
+// connecting, to script that call's outcome (e.g. with a negative
+// connectDelay, then simulateConnect or simulateFailureWithError: later)
+@property (nonatomic, copy) void (^outgoingConnectionHandler)(PKTFakeConnection *connection);
+
+// every connection made or received, oldest first, until removed
+@property (nonatomic, strong, readonly) NSArray  *connections;
+@property (nonatomic, strong, readonly) NSString *capabilityToken;
+
+- (instancetype)initWithDelegate:(id<TCDeviceDelegate>)delegate;
+
+// runs step on callbackQueue after delay (scaled); the building block for
+// scripted timelines
+- (void)after:(NSTimeInterval)delay perform:(void (^)(PKTFakeDevice *device))step;
+
+- (PKTFakeConnection *)simulateIncomingCallWithParameters:(NSDictionary *)parameters;
+- (PKTFakeConnection *)simulateIncomingCallFrom:(NSString *)from;
+// count incoming calls from made-up numbers, spacing seconds apart (scaled)
+- (void)simulateIncomingBurst:(NSUInteger)count spacing:(NSTimeInterval)spacing;
+// fails every live connection with PKTFakeDeviceErrorDropped
+- (void)simulateNetworkDrop;
+- (void)simulatePresenceUpdateForName:(NSString *)name available:(BOOL)available;
+- (void)simulateStopListeningWithError:(NSError *)error;
+
+// forgets disconnected connections, so a soak of thousands of calls doesn't
+// measure the fake's own bookkeeping
+- (void)removeFinishedConnections;
+
+@end
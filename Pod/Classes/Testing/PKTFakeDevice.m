@@ -0,0 +1,233 @@
+#import "PKTFakeDevice.h"
+
+NSString *const PKTFakeDeviceErrorDomain = @"PKTFakeDeviceErrorDomain";
+
+@interface PKTFakeConnection (PKTFakeDevice)
+
+- (void)startConnecting;
+- (BOOL)isLive;
+
+@end
+
+// TCPresenceEvent has no public initializer, so the fake overrides its getters
+@interface PKTFakePresenceEvent : TCPresenceEvent
+
+@property (nonatomic, strong) NSString *fakeName;
+@property (nonatomic, assign) BOOL     fakeAvailable;
+
+@end
+
+@implementation PKTFakePresenceEvent
+
+- (NSString *)name
+{
+    return self.fakeName;
+}
+
+- (BOOL)isAvailable
+{
+    return self.fakeAvailable;
+}
+
+@end
+
+@interface PKTFakeDevice ()
+
+@property (nonatomic, assign, readwrite) TCDeviceState  state;
+@property (nonatomic, strong, readwrite) NSString       *capabilityToken;
+@property (nonatomic, strong) NSMutableArray   *allConnections;  // only touched on connectionsQueue
+@property (nonatomic, strong) dispatch_queue_t connectionsQueue;
+@property (nonatomic, assign) NSUInteger       callCount;
+
+@end
+
+@implementation PKTFakeDevice
+
+- (instancetype)init
+{
+    return [self initWithDelegate:nil];
+}
+
+- (instancetype)initWithDelegate:(id<TCDeviceDelegate>)delegate
+{
+    if (self = [super init]) {
+        _delegate       = delegate;
+        _state          = TCDeviceStateOffline;
+        _timeScale      = 1;
+        _callbackQueue  = dispatch_get_main_queue();
+        _capabilities   = @{TCDeviceCapabilityIncomingKey: @YES,
+                            TCDeviceCapabilityOutgoingKey: @YES,
+                            TCDeviceCapabilityClientNameKey: @"fake"};
+        _allConnections   = [NSMutableArray array];
+        _connectionsQueue = dispatch_queue_create("com.phonekit.fake-device.connections", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (NSArray *)connections
+{
+    __block NSArray *connections = nil;
+    dispatch_sync(self.connectionsQueue, ^{
+        connections = [self.allConnections copy];
+    });
+    return connections;
+}
+
+- (void)addConnection:(PKTFakeConnection *)connection
+{
+    dispatch_sync(self.connectionsQueue, ^{
+        [self.allConnections addObject:connection];
+    });
+}
+
+- (void)removeFinishedConnections
+{
+    dispatch_sync(self.connectionsQueue, ^{
+        NSIndexSet *finished = [self.allConnections indexesOfObjectsPassingTest:^BOOL(PKTFakeConnection *c, NSUInteger idx, BOOL *stop) {
+            return c.state == TCConnectionStateDisconnected;
+        }];
+        [self.allConnections removeObjectsAtIndexes:finished];
+    });
+}
+
+#pragma mark - PKTDevice
+
+- (void)updateCapabilityToken:(NSString *)capabilityToken
+{
+    self.capabilityToken = capabilityToken;
+    [self updateState];
+}
+
+- (id<PKTConnection>)connect:(NSDictionary *)parameters delegate:(id<TCConnectionDelegate>)delegate
+{
+    if (!self.capabilityToken || self.state == TCDeviceStateBusy)
+        return nil;
+
+    PKTFakeConnection *connection = [[PKTFakeConnection alloc] initWithDevice:self parameters:parameters incoming:NO];
+    connection.delegate = delegate;
+    [self addConnection:connection];
+    [connection startConnecting];
+    if (self.outgoingConnectionHandler)
+        self.outgoingConnectionHandler(connection);
+    return connection;
+}
+
+- (void)disconnectAll
+{
+    for (PKTFakeConnection *connection in self.connections) {
+        [connection disconnect];
+    }
+}
+
+#pragma mark - Scripting
+
+- (void)after:(NSTimeInterval)delay perform:(void (^)(PKTFakeDevice *device))step
+{
+    __weak PKTFakeDevice *weakSelf = self;
+    [self deliverAfter:delay block:^{
+        PKTFakeDevice *device = weakSelf;
+        if (device)
+            step(device);
+    }];
+}
+
+- (PKTFakeConnection *)simulateIncomingCallWithParameters:(NSDictionary *)parameters
+{
+    PKTFakeConnection *connection = [[PKTFakeConnection alloc] initWithDevice:self parameters:parameters incoming:YES];
+    [self addConnection:connection];
+
+    [self deliverAfter:0 block:^{
+        if ([self.delegate respondsToSelector:@selector(device:didReceiveIncomingConnection:)])
+            [self.delegate device:(id)self didReceiveIncomingConnection:(id)connection];
+    }];
+    return connection;
+}
+
+- (PKTFakeConnection *)simulateIncomingCallFrom:(NSString *)from
+{
+    return [self simulateIncomingCallWithParameters:@{TCConnectionIncomingParameterFromKey: from ?: @"",
+                                                      TCConnectionIncomingParameterToKey: @"client:fake",
+                                                      @"FromCity": @"SAN FRANCISCO",
+                                                      @"FromState": @"CA",
+                                                      @"FromCountry": @"US"}];
+}
+
+- (void)simulateIncomingBurst:(NSUInteger)count spacing:(NSTimeInterval)spacing
+{
+    for (NSUInteger i = 0; i < count; i++) {
+        NSString *from = [NSString stringWithFormat:@"+1415555%04lu", (unsigned long)(i % 10000)];
+        [self after:spacing * i perform:^(PKTFakeDevice *device) {
+            [device simulateIncomingCallFrom:from];
+        }];
+    }
+}
+
+- (void)simulateNetworkDrop
+{
+    NSError *error = [NSError errorWithDomain:PKTFakeDeviceErrorDomain code:PKTFakeDeviceErrorDropped userInfo:nil];
+    for (PKTFakeConnection *connection in self.connections) {
+        [connection simulateFailureWithError:error];
+    }
+}
+
+- (void)simulatePresenceUpdateForName:(NSString *)name available:(BOOL)available
+{
+    PKTFakePresenceEvent *event = [PKTFakePresenceEvent new];
+    event.fakeName      = name;
+    event.fakeAvailable = available;
+
+    [self deliverAfter:0 block:^{
+        if ([self.delegate respondsToSelector:@selector(device:didReceivePresenceUpdate:)])
+            [self.delegate device:(id)self didReceivePresenceUpdate:event];
+    }];
+}
+
+- (void)simulateStopListeningWithError:(NSError *)error
+{
+    self.state = TCDeviceStateOffline;
+    [self deliverAfter:0 block:^{
+        if ([self.delegate respondsToSelector:@selector(device:didStopListeningForIncomingConnections:)])
+            [self.delegate device:(id)self didStopListeningForIncomingConnections:error];
+    }];
+}
+
+#pragma mark - PKTFakeConnection support
+
+- (void)deliverAfter:(NSTimeInterval)delay block:(dispatch_block_t)block
+{
+    int64_t nanoseconds = (int64_t)(MAX(delay, 0) * self.timeScale * NSEC_PER_SEC);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, nanoseconds), self.callbackQueue, block);
+}
+
+- (NSString *)nextCallSid
+{
+    @synchronized(self) {
+        return [NSString stringWithFormat:@"CAfake%026lu", (unsigned long)++self.callCount];
+    }
+}
+
+- (void)connectionDidChangeState:(PKTFakeConnection *)connection
+{
+    [self updateState];
+}
+
+- (void)updateState
+{
+    __block BOOL live = NO;
+    dispatch_sync(self.connectionsQueue, ^{
+        NSUInteger index = [self.allConnections indexOfObjectPassingTest:^BOOL(PKTFakeConnection *c, NSUInteger idx, BOOL *stop) {
+            return [c isLive];
+        }];
+        live = index != NSNotFound;
+    });
+
+    TCDeviceState state = TCDeviceStateOffline;
+    if (self.capabilityToken)
+        state = live ? TCDeviceStateBusy : TCDeviceStateReady;
+    @synchronized(self) {
+        if (state != self.state)
+            self.state = state;
+    }
+}
+
+@end
@@ -0,0 +1,22 @@
+#import <Foundation/Foundation.h>
+#import "PKTTokenManager.h"
+
+// A PKTTokenProvider that makes up tokens locally, for exercising
+// PKTTokenManager without a token server:
+//
+//     PKTStubTokenProvider *provider = [PKTStubTokenProvider new];
+//     provider.tokenLifetime = 120;
+//     provider.failuresRemaining = 2;                 // two errors, then tokens
+//     phone.tokenManager = [[PKTTokenManager alloc] initWithProvider:provider];
+//
+// Tokens are "stub-token-1", "stub-token-2", ...; fetches complete on the
+// main queue after latency seconds.
+@interface PKTStubTokenProvider : NSObject <PKTTokenProvider>
+
+@property (nonatomic, assign) NSTimeInterval latency;          // default 0
+@property (nonatomic, assign) NSTimeInterval tokenLifetime;    // default 3600; 0 reports no expiry
+@property (nonatomic, assign) NSUInteger     failuresRemaining;
+
+@property (nonatomic, assign, readonly) NSUInteger fetchCount;
+
+@end
@@ -0,0 +1,38 @@
+#import "PKTStubTokenProvider.h"
+#import "PKTFakeDevice.h"
+
+@interface PKTStubTokenProvider ()
+
+@property (nonatomic, assign, readwrite) NSUInteger fetchCount;
+
+@end
+
+@implementation PKTStubTokenProvider
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _tokenLifetime = 3600;
+    }
+    return self;
+}
+
+- (void)fetchCapabilityTokenWithCompletion:(PKTTokenFetchCompletion)completion
+{
+    NSUInteger fetch = ++self.fetchCount;
+    BOOL fail        = self.failuresRemaining > 0;
+    if (fail)
+        self.failuresRemaining--;
+
+    NSTimeInterval lifetime = self.tokenLifetime;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(self.latency, 0) * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        if (fail) {
+            completion(nil, nil, [NSError errorWithDomain:PKTFakeDeviceErrorDomain code:PKTFakeDeviceErrorFailed userInfo:nil]);
+            return;
+        }
+        NSString *token = [NSString stringWithFormat:@"stub-token-%lu", (unsigned long)fetch];
+        completion(token, lifetime > 0 ? [NSDate dateWithTimeIntervalSinceNow:lifetime] : nil, nil);
+    });
+}
+
+@end
@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSUInteger, PKTCallPad) {
+    PKTCallPadNone,
+    PKTCallPadMain,      // mute, keypad, speaker, hangup
+    PKTCallPadKeypad,    // digits for the live call
+    PKTCallPadIncoming   // accept, ignore, reject
+};
+
+// Which of the call screen's pads is showing, and which have been built.
+// A pad is made through padBuilder the first time it's asked for, so a call
+// screen that never shows the keypad never pays for one. Pads are whatever
+// padBuilder returns; nothing here touches UIKit.
+@interface PKTCallPadSwitcher : NSObject
+
+@property (nonatomic, copy            ) id         (^padBuilder)(PKTCallPad pad);
+@property (nonatomic, assign, readonly) PKTCallPad visiblePad;   // PKTCallPadNone until the first showPad:
+@property (nonatomic, strong, readonly) NSArray    *builtPads;   // in the order they were built
+@property (nonatomic, assign, readonly) NSUInteger buildCount;
+
+// nil for PKTCallPadNone, or if padBuilder returns nil
+- (id)padIfBuilt:(PKTCallPad)pad;
+- (id)padForKind:(PKTCallPad)pad;    // builds it if needed
+- (PKTCallPad)kindOfPad:(id)pad;     // PKTCallPadNone if it isn't one of ours
+
+// makes pad the visible one, building it if needed, and returns it
+- (id)showPad:(PKTCallPad)pad;
+
+@end
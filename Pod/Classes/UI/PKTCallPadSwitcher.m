@@ -0,0 +1,64 @@
+#import "PKTCallPadSwitcher.h"
+
+@interface PKTCallPadSwitcher ()
+
+@property (nonatomic, strong) NSMutableDictionary *padsByKind;
+@property (nonatomic, strong) NSMutableArray      *buildOrder;
+@property (nonatomic, assign) PKTCallPad          visiblePad;
+@property (nonatomic, assign) NSUInteger          buildCount;
+
+@end
+
+@implementation PKTCallPadSwitcher
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _padsByKind = [NSMutableDictionary dictionary];
+        _buildOrder = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (NSArray *)builtPads
+{
+    return [self.buildOrder copy];
+}
+
+- (id)padIfBuilt:(PKTCallPad)pad
+{
+    return self.padsByKind[@(pad)];
+}
+
+- (id)padForKind:(PKTCallPad)pad
+{
+    if (pad == PKTCallPadNone)
+        return nil;
+
+    id built = self.padsByKind[@(pad)];
+    if (!built && self.padBuilder) {
+        built = self.padBuilder(pad);
+        self.buildCount++;
+        if (built) {
+            self.padsByKind[@(pad)] = built;
+            [self.buildOrder addObject:built];
+        }
+    }
+    return built;
+}
+
+- (PKTCallPad)kindOfPad:(id)pad
+{
+    NSArray *kinds = pad ? [self.padsByKind allKeysForObject:pad] : nil;
+    return kinds.count ? [kinds[0] unsignedIntegerValue] : PKTCallPadNone;
+}
+
+- (id)showPad:(PKTCallPad)pad
+{
+    id shown = [self padForKind:pad];
+    if (shown)
+        self.visiblePad = pad;
+    return shown;
+}
+
+@end
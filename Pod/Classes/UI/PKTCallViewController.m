@@ -1,9 +1,12 @@
 #import "PKTCallViewController.h"
 
 #import "PKTPhone.h"
+#import "PKTCallPadSwitcher.h"
+#import "PKTGlyphCache.h"
 #import "JCPadButton.h"
 #import "FontasticIcons.h"
 #import "UIView+FrameAccessor.h"
+#import "RACEXTScope.h"
 
 #define kCallingViewMuteInput @"M"
 #define kCallingViewKeypadInput @"K"
@@ -16,10 +19,11 @@
 
 @interface PKTCallViewController ()
 
-@property (strong, nonatomic) JCDialPad *mainPad;
-@property (strong, nonatomic) JCDialPad *keyPad;
-@property (strong, nonatomic) JCDialPad *incomingPad;
-@property (strong, nonatomic) UIImage   *backgroundImage;
+@property (strong, nonatomic) PKTCallPadSwitcher *padSwitcher;
+@property (strong, nonatomic) UIImage     *backgroundImage;
+@property (strong, nonatomic) UIImageView *backgroundView;  // behind every pad
+@property (strong, nonatomic) UIImageView *muteIconView;
+@property (strong, nonatomic) UIImageView *speakerIconView;
 
 @end
 
@@ -45,21 +49,20 @@
 
 - (void)initializeProperties
 {
-    self.mainPad     = [JCDialPad new];
-    self.keyPad      = [JCDialPad new];
-    self.incomingPad = [JCDialPad new];
     self.mainText    = @"";
+    self.padSwitcher = [PKTCallPadSwitcher new];
     
-    RAC(self.mainPad, rawText)     = RACObserve(self, mainText);
-    RAC(self.incomingPad, rawText) = RACObserve(self, mainText);
+    //pads are built the first time they're shown
+    __weak PKTCallViewController *weakSelf = self;
+    self.padSwitcher.padBuilder = ^id(PKTCallPad pad) {
+        return [weakSelf buildDialPad:pad];
+    };
 }
 
 - (void)viewDidLoad
 {
     [super viewDidLoad];
 	
-    self.incomingPad.buttons = [self incomingPadButtons];
-    self.keyPad.buttons      = [self keyPadButtons];
     [self setupDialPads];
     [self setupCallStatusLabel];
 }
@@ -94,7 +97,7 @@
         self.mainText = params[@"From"] ?: @"unknown";
     }
  	self.callStatusLabel.text = incoming ? @"incoming call" : @"connecting...";
-    [self switchToPad:incoming ? self.incomingPad : self.mainPad
+    [self switchToPad:incoming ? PKTCallPadIncoming : PKTCallPadMain
              animated:NO];
     
     if ([self.phoneDelegate respondsToSelector:_cmd])
@@ -103,7 +106,7 @@
 
 - (void)callConnected
 {
-    [self switchToPad:self.mainPad
+    [self switchToPad:PKTCallPadMain
              animated:NO];
     
     if ([self.phoneDelegate respondsToSelector:_cmd])
@@ -112,79 +115,151 @@
 
 -(void)callEndedWithRecord:(PKTCallRecord *)record error:(NSError *)error
 {
-    self.callStatusLabel.text = @"call ended";
-    self.keyPad.rawText       = @"";
-    [[[RACSignal empty] delay:0.5] subscribeCompleted:^{
-        [self dismissViewControllerAnimated:YES completion:nil];
-    }];
+    //stay up while a waiting call is still around
+    if (![PKTPhone sharedPhone].callCount) {
+        JCDialPad *keyPad         = [self.padSwitcher padIfBuilt:PKTCallPadKeypad];
+        self.callStatusLabel.text = @"call ended";
+        keyPad.rawText            = @"";
+        [[[RACSignal empty] delay:0.5] subscribeCompleted:^{
+            [self dismissViewControllerAnimated:YES completion:nil];
+        }];
+    }
     
     if ([self.phoneDelegate respondsToSelector:_cmd])
         [self.phoneDelegate callEndedWithRecord:record error:error];
 }
 
-#pragma mark - Dial Pads
-
-- (NSArray *)dialPads
+- (void)sentDigits:(NSString *)digits atTime:(NSTimeInterval)time
 {
-    return @[self.mainPad, self.keyPad, self.incomingPad];
+    if ([self.phoneDelegate respondsToSelector:_cmd])
+        [self.phoneDelegate sentDigits:digits atTime:time];
 }
 
+#pragma mark - Dial Pads
+
 - (void)setupDialPads
 {
-    for (JCDialPad *dialPad in [self dialPads]) {
-        dialPad.showDeleteButton = NO;
-        dialPad.frame            = self.view.bounds;
-        dialPad.delegate         = self;
-        
-        [[RACObserve(self, backgroundImage)
-         ignore:nil]
-         subscribeNext:^(UIImage *bg) {
-            UIImageView* backgroundView = [[UIImageView alloc] initWithImage:bg];
-            backgroundView.contentMode  = UIViewContentModeScaleAspectFill;
-            [dialPad setBackgroundView:backgroundView];
-        }];
-        
-        [self.view addSubview:dialPad];
-    }
+    //one blurred snapshot behind all the pads, which leave their own
+    //backgroundView unset and so stay transparent
+    self.backgroundView                  = [[UIImageView alloc] initWithFrame:self.view.bounds];
+    self.backgroundView.contentMode      = UIViewContentModeScaleAspectFill;
+    self.backgroundView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    
+    //same blur JCDialPad puts over its own backgroundView
+    UINavigationBar *blurringView = [[UINavigationBar alloc] initWithFrame:self.backgroundView.bounds];
+    blurringView.barStyle         = UIBarStyleBlack;
+    blurringView.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    [self.backgroundView addSubview:blurringView];
+    [self.view addSubview:self.backgroundView];
     
-    self.incomingPad.hidden             = YES;
-    self.keyPad.hidden                  = YES;
-    self.keyPad.formatTextToPhoneNumber = NO;
+    RAC(self.backgroundView, image)  = RACObserve(self, backgroundImage);
+    RAC(self.backgroundView, hidden) = [RACObserve(self, backgroundImage) map:^NSNumber *(UIImage *bg) {
+        return @(bg == nil);
+    }];
     
-    //reload mainPad buttons whenever muted or speakerEnabled changes,
-    //or if viewWillAppear fires
-    [[[RACSignal
+    //swap the mute and speaker icons in place whenever muted or speakerEnabled
+    //changes, or if viewWillAppear fires. the phone outlives us, so hold self
+    //weakly and stop when we go
+    @weakify(self);
+    [[[[RACSignal
     combineLatest:@[RACObserve([PKTPhone sharedPhone], muted),
                     RACObserve([PKTPhone sharedPhone], speakerEnabled)]]
             merge:[self rac_signalForSelector:@selector(viewWillAppear:)]]
+        takeUntil:self.rac_willDeallocSignal]
     subscribeNext:^(RACTuple *next) {
-        //reload buttons
-        self.mainPad.buttons = [self mainPadButtons];
-        [self.mainPad layoutSubviews];
+        @strongify(self);
+        [self updateMainPadIcons];
     }];
 }
 
+- (JCDialPad *)buildDialPad:(PKTCallPad)pad
+{
+    JCDialPad *dialPad       = [JCDialPad new];
+    dialPad.showDeleteButton = NO;
+    dialPad.frame            = self.view.bounds;
+    dialPad.delegate         = self;
+    
+    switch (pad) {
+        case PKTCallPadMain:
+            dialPad.buttons = [self mainPadButtons];
+            RAC(dialPad, rawText) = RACObserve(self, mainText);
+            break;
+        case PKTCallPadIncoming:
+            dialPad.buttons = [self incomingPadButtons];
+            RAC(dialPad, rawText) = RACObserve(self, mainText);
+            break;
+        case PKTCallPadKeypad:
+            dialPad.buttons                 = [self keyPadButtons];
+            dialPad.formatTextToPhoneNumber = NO;
+            break;
+        default:
+            return nil;
+    }
+    dialPad.hidden = YES;
+    [self.view insertSubview:dialPad aboveSubview:self.backgroundView];
+    
+    //the status label sits under the digits, which every pad lays out alike
+    [dialPad layoutIfNeeded];
+    self.callStatusLabel.y = dialPad.digitsTextField.bottom;
+    return dialPad;
+}
+
+- (void)updateMainPadIcons
+{
+    self.muteIconView.image    = [self imageForIcon:[self muteIcon]];
+    self.speakerIconView.image = [self imageForIcon:[self speakerIcon]];
+}
+
+- (FIIcon *)muteIcon
+{
+    return [PKTPhone sharedPhone].muted ? [FIFontAwesomeIcon microphoneIcon] : [FIFontAwesomeIcon microphoneOffIcon];
+}
+
+- (FIIcon *)speakerIcon
+{
+    return [PKTPhone sharedPhone].speakerEnabled ? [FIFontAwesomeIcon volumeDownIcon] : [FIFontAwesomeIcon volumeUpIcon];
+}
+
+//icons are drawn once per look and shared through PKTGlyphCache
+- (UIImage *)imageForIcon:(FIIcon *)icon
+{
+    return [[PKTGlyphCache sharedCache] imageWithIcon:icon
+                                               bounds:CGRectMake(15, 15, JCPadButtonWidth, JCPadButtonHeight)
+                                                color:[UIColor whiteColor]
+                                                scale:0];
+}
+
+- (UIImageView *)iconViewWithIcon:(FIIcon *)icon
+{
+    UIImageView *iconView    = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, JCPadButtonWidth, JCPadButtonHeight)];
+    iconView.backgroundColor = [UIColor clearColor];
+    iconView.contentMode     = UIViewContentModeScaleAspectFit;
+    iconView.image           = [self imageForIcon:icon];
+    return iconView;
+}
+
 - (NSArray *)mainPadButtons
 {
     NSArray *inputs = @[kCallingViewMuteInput,
                         kCallingViewKeypadInput,
                         kCallingViewSpeakerInput,
                         kCallingViewHangupInput];
-    NSArray *icons = @[[PKTPhone sharedPhone].muted ? [FIFontAwesomeIcon microphoneIcon] : [FIFontAwesomeIcon microphoneOffIcon],
+    NSArray *icons = @[[self muteIcon],
                        [FIFontAwesomeIcon thIcon],
-                       [PKTPhone sharedPhone].speakerEnabled ? [FIFontAwesomeIcon volumeDownIcon] : [FIFontAwesomeIcon volumeUpIcon],
+                       [self speakerIcon],
                        [FIFontAwesomeIcon phoneIcon]];
     
     NSMutableArray *buttons = [NSMutableArray array];
     
     [inputs enumerateObjectsUsingBlock:^(NSString *input, NSUInteger i, BOOL *stop) {
-        FIIconView *iconView     = [[FIIconView alloc] initWithFrame:CGRectMake(0, 0, 65, 65)];
-        iconView.backgroundColor = [UIColor clearColor];
-        iconView.icon            = icons[i];
-        iconView.padding         = 15;
-        iconView.iconColor       = [UIColor whiteColor];
-        JCPadButton *button      = [[JCPadButton alloc] initWithInput:input iconView:iconView subLabel:@""];
+        UIImageView *iconView = [self iconViewWithIcon:icons[i]];
+        JCPadButton *button   = [[JCPadButton alloc] initWithInput:input iconView:iconView subLabel:@""];
         
+        if ([input isEqual:kCallingViewMuteInput]) {
+            self.muteIconView = iconView;
+        } else if ([input isEqual:kCallingViewSpeakerInput]) {
+            self.speakerIconView = iconView;
+        }
         if ([input isEqual:kCallingViewHangupInput] ||
             [input isEqual:kCallingViewKeypadInput]) {
             iconView.transform     = CGAffineTransformMakeRotation(DEG_TO_RAD(90));
@@ -200,13 +275,8 @@
 
 - (NSArray *)keyPadButtons
 {
-    FIIconView *iconView     = [[FIIconView alloc] initWithFrame:CGRectMake(0, 0, 65, 65)];
-    iconView.backgroundColor = [UIColor clearColor];
-    iconView.icon            = [FIFontAwesomeIcon replyIcon];
-    iconView.padding         = 15;
-    iconView.iconColor       = [UIColor whiteColor];
-
-    JCPadButton *backButton  = [[JCPadButton alloc] initWithInput:kKeyboardViewBackInput iconView:iconView subLabel:@""];
+    UIImageView *iconView   = [self iconViewWithIcon:[FIFontAwesomeIcon replyIcon]];
+    JCPadButton *backButton = [[JCPadButton alloc] initWithInput:kKeyboardViewBackInput iconView:iconView subLabel:@""];
     
     return [[JCDialPad defaultButtons] arrayByAddingObject:backButton];
 }
@@ -223,12 +293,8 @@
     NSMutableArray *buttons = [NSMutableArray array];
     
     [inputs enumerateObjectsUsingBlock:^(NSString *input, NSUInteger i, BOOL *stop) {
-        FIIconView *iconView     = [[FIIconView alloc] initWithFrame:CGRectMake(0, 0, 65, 65)];
-        iconView.backgroundColor = [UIColor clearColor];
-        iconView.icon            = icons[i];
-        iconView.padding         = 15;
-        iconView.iconColor       = [UIColor whiteColor];
-        JCPadButton *button      = [[JCPadButton alloc] initWithInput:input iconView:iconView subLabel:@""];
+        UIImageView *iconView = [self iconViewWithIcon:icons[i]];
+        JCPadButton *button   = [[JCPadButton alloc] initWithInput:input iconView:iconView subLabel:@""];
 
         UIColor *buttonColor     = [UIColor colorWithRed:0.488 green:0.478 blue:0.504 alpha:1.000];
         
@@ -247,7 +313,8 @@
 
 - (BOOL)dialPad:(JCDialPad *)dialPad shouldInsertText:(NSString *)text forButtonPress:(JCPadButton *)button
 {
-    if (dialPad == self.mainPad) {
+    PKTCallPad pad = [self.padSwitcher kindOfPad:dialPad];
+    if (pad == PKTCallPadMain) {
         if ([text isEqual:kCallingViewMuteInput]) {
             [PKTPhone sharedPhone].muted = ![PKTPhone sharedPhone].muted;
         }
@@ -255,16 +322,16 @@
             [PKTPhone sharedPhone].speakerEnabled = ![PKTPhone sharedPhone].speakerEnabled;
         }
         else if ([text isEqualToString:kCallingViewKeypadInput]) {
-            [self switchToPad:self.keyPad animated:YES];
+            [self switchToPad:PKTCallPadKeypad animated:YES];
         }
         else {
             [[PKTPhone sharedPhone] hangup];
         }
         return NO;
     }
-    else if (dialPad == self.keyPad) {
+    else if (pad == PKTCallPadKeypad) {
         if ([text isEqual:kKeyboardViewBackInput]) {
-            [self switchToPad:self.mainPad animated:YES];
+            [self switchToPad:PKTCallPadMain animated:YES];
             return NO;
         }
         [[PKTPhone sharedPhone] sendDigits:text];
@@ -278,8 +345,9 @@
     }
 }
 
--(void)switchToPad:(JCDialPad *)pad animated:(BOOL)animated
+-(void)switchToPad:(PKTCallPad)kind animated:(BOOL)animated
 {
+    JCDialPad *pad = [self.padSwitcher showPad:kind];
     if (pad.hidden) {
         pad.alpha = 0;
     }
@@ -287,12 +355,20 @@
     [self.view bringSubviewToFront:pad];
     [self.view bringSubviewToFront:self.callStatusLabel];
     
+    //the pads share one background, so the old one fades out as the new one
+    //fades in rather than being covered
     [UIView animateWithDuration:0.3*animated animations:^{
-        self.callStatusLabel.alpha = !(pad == self.keyPad);
+        self.callStatusLabel.alpha = !(kind == PKTCallPadKeypad);
         pad.alpha = 1.0;
-    } completion:^(BOOL finished) {
-        for (JCDialPad *otherPad in [self dialPads]) {
+        for (JCDialPad *otherPad in self.padSwitcher.builtPads) {
             if (otherPad != pad)
+                otherPad.alpha = 0;
+        }
+    } completion:^(BOOL finished) {
+        //unless another switch has brought it back meanwhile
+        JCDialPad *visiblePad = [self.padSwitcher padIfBuilt:self.padSwitcher.visiblePad];
+        for (JCDialPad *otherPad in self.padSwitcher.builtPads) {
+            if (otherPad != visiblePad)
                 otherPad.hidden = YES;
         }
     }];
@@ -302,7 +378,8 @@
 
 - (void)setupCallStatusLabel
 {
-    CGRect frame                                = CGRectMake(0, self.mainPad.digitsTextField.bottom, self.view.width, 24);
+    //moved under the digits once a pad is built
+    CGRect frame                                = CGRectMake(0, 0, self.view.width, 24);
     self.callStatusLabel                        = [[UILabel alloc] initWithFrame:frame];
     self.callStatusLabel.textColor              = [UIColor colorWithWhite:1.000 alpha:0.800];
     self.callStatusLabel.font                   = [UIFont fontWithName:@"HelveticaNeue-Light" size:16];
@@ -311,7 +388,7 @@
     [self.view addSubview:self.callStatusLabel];
     
     RACSignal *statusText =
-    [RACObserve([PKTPhone sharedPhone], callDuration)
+    [[PKTPhone sharedPhone].callDurationSignal
     map:^NSString *(NSNumber *duration){
         long dur      = [duration longValue];
         BOOL hasHours = dur / 3600 > 0;
@@ -0,0 +1,39 @@
+#import <UIKit/UIKit.h>
+#import "FontasticIcons.h"
+
+// Draws one icon image; PKTGlyphCache calls it on a miss. Bounds are as for
+// -[FIIcon imageWithBounds:color:]: the origin is the inset, the size the image's.
+@protocol PKTGlyphRasterizer <NSObject>
+
+- (UIImage *)imageWithIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale;
+
+@end
+
+// The default rasterizer: lays the glyph out with CoreText through an FIIconLayer.
+@interface PKTIconLayerRasterizer : NSObject <PKTGlyphRasterizer>
+@end
+
+// Rasterized icon images keyed by (icon, bounds, color, scale), so showing an
+// icon again is an image swap rather than a CoreText layout pass. Least
+// recently used images are evicted past countLimit, and all of them on a
+// memory warning.
+@interface PKTGlyphCache : NSObject
+
+@property (nonatomic, strong, readonly) id<PKTGlyphRasterizer> rasterizer;
+@property (nonatomic, assign          ) NSUInteger             countLimit;  // default 32
+@property (nonatomic, assign, readonly) NSUInteger             count;
+@property (nonatomic, assign, readonly) NSUInteger             hitCount;
+@property (nonatomic, assign, readonly) NSUInteger             missCount;
+
++ (PKTGlyphCache *)sharedCache;
+// equal only for the same font, glyph, bounds and scale, and a colour with the
+// same components in the same colour space
++ (id<NSCopying>)keyForIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale;
+
+- (instancetype)initWithRasterizer:(id<PKTGlyphRasterizer>)rasterizer;
+
+// scale 0 means the main screen's
+- (UIImage *)imageWithIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale;
+- (void)removeAllImages;
+
+@end
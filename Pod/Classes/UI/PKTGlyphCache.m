@@ -0,0 +1,203 @@
+#import "PKTGlyphCache.h"
+
+@implementation PKTIconLayerRasterizer
+
+- (UIImage *)imageWithIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale
+{
+    FIIconLayer *layer = [FIIconLayer layer];
+    [layer setIcon:icon withContentsScale:scale];
+    layer.bounds    = CGRectMake(0, 0, bounds.size.width, bounds.size.height);
+    layer.iconInset = bounds.origin;
+    layer.iconColor = color;
+
+    UIGraphicsBeginImageContextWithOptions(layer.bounds.size, NO, scale);
+    [layer renderInContext:UIGraphicsGetCurrentContext()];
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return image;
+}
+
+@end
+
+// what an image is drawn from; compared exactly, colour space included, so
+// colours that print alike or share components in another space don't collide
+@interface PKTGlyphKey : NSObject <NSCopying>
+
+@property (nonatomic, strong, readonly) NSString   *fontName;
+@property (nonatomic, strong, readonly) NSString   *glyph;
+@property (nonatomic, assign, readonly) CGRect     bounds;
+@property (nonatomic, assign, readonly) CGFloat    scale;
+@property (nonatomic, assign, readonly) CGColorRef color;
+
+@end
+
+static NSUInteger PKTHashFloat(CGFloat value)
+{
+    value += 0.0; // -0 and 0 compare equal, so hash them alike
+    uint64_t bits = 0;
+    memcpy(&bits, &value, MIN(sizeof(value), sizeof(bits)));
+    return (NSUInteger)(bits ^ (bits >> 32));
+}
+
+@implementation PKTGlyphKey
+{
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithFontName:(NSString *)fontName glyph:(NSString *)glyph bounds:(CGRect)bounds color:(CGColorRef)color scale:(CGFloat)scale
+{
+    if (self = [super init]) {
+        _fontName = fontName;
+        _glyph    = glyph;
+        _bounds   = bounds;
+        _scale    = scale;
+        _color    = CGColorRetain(color);
+
+        _hash = fontName.hash * 31 + glyph.hash;
+        CGFloat values[] = {bounds.origin.x, bounds.origin.y, bounds.size.width, bounds.size.height, scale};
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            _hash = _hash * 31 + PKTHashFloat(values[i]);
+        const CGFloat *components = color ? CGColorGetComponents(color) : NULL;
+        for (size_t i = 0; components && i < CGColorGetNumberOfComponents(color); i++)
+            _hash = _hash * 31 + PKTHashFloat(components[i]);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    CGColorRelease(_color);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return self;
+}
+
+- (NSUInteger)hash
+{
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object
+{
+    if (object == self)
+        return YES;
+    if (![object isKindOfClass:[PKTGlyphKey class]] || ((PKTGlyphKey *)object)->_hash != _hash)
+        return NO;
+    PKTGlyphKey *other = object;
+    return (_fontName == other->_fontName || [_fontName isEqualToString:other->_fontName]) &&
+           (_glyph == other->_glyph || [_glyph isEqualToString:other->_glyph]) &&
+           CGRectEqualToRect(_bounds, other->_bounds) && _scale == other->_scale &&
+           (_color == other->_color || (_color && other->_color && CGColorEqualToColor(_color, other->_color)));
+}
+
+@end
+
+@interface PKTGlyphCache ()
+
+@property (nonatomic, strong) NSMutableDictionary *images;
+@property (nonatomic, strong) NSMutableOrderedSet *recentKeys;  // least recently used first
+
+@end
+
+@implementation PKTGlyphCache
+
++ (PKTGlyphCache *)sharedCache
+{
+    static PKTGlyphCache *sharedCache;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        sharedCache = [[self alloc] initWithRasterizer:[PKTIconLayerRasterizer new]];
+    });
+    return sharedCache;
+}
+
++ (id<NSCopying>)keyForIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale
+{
+    return [[PKTGlyphKey alloc] initWithFontName:[icon.class font].name glyph:icon.glyph bounds:bounds color:color.CGColor scale:scale];
+}
+
+- (instancetype)initWithRasterizer:(id<PKTGlyphRasterizer>)rasterizer
+{
+    if (self = [super init]) {
+        _rasterizer = rasterizer;
+        _countLimit = 32;
+        _images     = [NSMutableDictionary dictionary];
+        _recentKeys = [NSMutableOrderedSet orderedSet];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(removeAllImages)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+- (NSUInteger)count
+{
+    @synchronized (self) {
+        return self.images.count;
+    }
+}
+
+- (UIImage *)imageWithIcon:(FIIcon *)icon bounds:(CGRect)bounds color:(UIColor *)color scale:(CGFloat)scale
+{
+    if (!icon)
+        return nil;
+    scale = scale ?: [UIScreen mainScreen].scale;
+    id<NSCopying> key = [[self class] keyForIcon:icon bounds:bounds color:color scale:scale];
+
+    @synchronized (self) {
+        UIImage *image = self.images[key];
+        if (image) {
+            _hitCount++;
+            [self.recentKeys removeObject:key];
+            [self.recentKeys addObject:key];
+            return image;
+        }
+        _missCount++;
+    }
+
+    // drawn outside the lock; two threads missing on one key both draw, and the last one stays
+    UIImage *image = [self.rasterizer imageWithIcon:icon bounds:bounds color:color scale:scale];
+    if (!image)
+        return nil;
+    @synchronized (self) {
+        self.images[key] = image;
+        [self.recentKeys removeObject:key];
+        [self.recentKeys addObject:key];
+        [self evictToCountLimit];
+    }
+    return image;
+}
+
+- (void)setCountLimit:(NSUInteger)countLimit
+{
+    @synchronized (self) {
+        _countLimit = countLimit;
+        [self evictToCountLimit];
+    }
+}
+
+- (void)removeAllImages
+{
+    @synchronized (self) {
+        [self.images removeAllObjects];
+        [self.recentKeys removeAllObjects];
+    }
+}
+
+- (void)evictToCountLimit
+{
+    while (self.recentKeys.count > _countLimit) {
+        [self.images removeObjectForKey:self.recentKeys.firstObject];
+        [self.recentKeys removeObjectAtIndex:0];
+    }
+}
+
+@end
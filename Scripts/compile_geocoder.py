@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+# Compiles a prefix,city,state CSV into the file PKTAreaCodeGeocoder maps,
+# byte for byte what +compileEntries:toPath:error: writes, so the database
+# that ships with the pod can be rebuilt without a device:
+#
+#   Scripts/compile_geocoder.py Pod/Assets/PKTNANPAreaCodes.csv Pod/Assets/PKTNANPAreaCodes.geo
+#
+# Keep in step with the layout in PKTAreaCodeGeocoder.m.
+
+import csv
+import struct
+import sys
+
+MAGIC   = 0x504b5447  # "PKTG"
+VERSION = 1
+
+
+def compile_entries(entries):
+    build   = [[[-1] * 10, 0]]  # children, location
+    strings = bytearray()
+    string_ids, locations, location_ids = {}, [], {}
+
+    def intern(string):
+        if not string:
+            return 0
+        if string not in string_ids:
+            utf8 = string.encode('utf-8')
+            string_ids[string] = len(strings) + 1
+            strings.extend(struct.pack('<I', len(utf8)) + utf8)
+        return string_ids[string]
+
+    prefix_count = 0
+    for prefix, (city, state) in entries.items():
+        if not prefix or not prefix.isdigit():
+            continue
+        location = (intern(city), intern(state))
+        if location not in location_ids:
+            locations.append(location)
+            location_ids[location] = len(locations)
+
+        node = 0
+        for digit in map(int, prefix):
+            if build[node][0][digit] < 0:
+                build.append([[-1] * 10, 0])
+                build[node][0][digit] = len(build) - 1
+            node = build[node][0][digit]
+        if not build[node][1]:
+            prefix_count += 1
+        build[node][1] = location_ids[location]
+
+    # breadth-first, so each node's children are adjacent
+    order, nodes = [0], bytearray()
+    for index in order:
+        children, location = build[index]
+        mask, first_child = 0, len(order)
+        for digit in range(10):
+            if children[digit] >= 0:
+                mask |= 1 << digit
+                order.append(children[digit])
+        nodes.extend(struct.pack('<HHII', mask, 0, location, first_child))
+
+    header = struct.pack('<IHHIIII', MAGIC, VERSION, 0, len(build), len(locations), len(strings), prefix_count)
+    return header + nodes + b''.join(struct.pack('<II', *l) for l in locations) + strings
+
+
+def main(source, destination):
+    with open(source, newline='', encoding='utf-8') as f:
+        entries = {row['prefix']: (row['city'], row['state']) for row in csv.DictReader(f)}
+    with open(destination, 'wb') as f:
+        f.write(compile_entries(entries))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: compile_geocoder.py entries.csv output.geo')
+    main(sys.argv[1], sys.argv[2])